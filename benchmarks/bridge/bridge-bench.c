@@ -0,0 +1,410 @@
+/*
+ * bridge-bench.c
+ *
+ * Copyright © 2017 Antergos Developers <dev@antergos.com>
+ *
+ * This file is part of lightdm-webkit2-greeter.
+ *
+ * lightdm-webkit2-greeter is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * lightdm-webkit2-greeter is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * The following additional terms are in effect as per Section 7 of the license:
+ *
+ * The preservation of all legal notices and author attributions in
+ * the material or in the Appropriate Legal Notices displayed
+ * by works containing it is required.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with lightdm-webkit2-greeter; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Measures the JavaScriptCore bridge callbacks of the web extension. The extension is
+ * compiled into this program against bridge/lightdm.h, its classes are published on a
+ * bare global context (see publish_bridge_objects()) and each case calls into them from
+ * JavaScript the way themes do. For each case it reports calls per second, malloc() calls
+ * and bytes per call, and the bytes still allocated once the results were collected.
+ *
+ * JavaScriptCore keeps its own heap outside of malloc(), so the allocation columns cover
+ * GLib and the extension, which is the part we can change.
+ *
+ * Usage: bridge-bench [ITERATIONS]
+ */
+
+#include <malloc.h>
+#include <glib/gstdio.h>
+
+#include "webkit2-extension.c"
+
+
+#define DIRLIST_ENTRIES 200
+#define SESSION_ENTRIES 20
+
+static const gchar bench_config[] =
+	"[greeter]\n"
+	"debug_mode = false\n"
+	"screensaver_timeout = 300\n"
+	"webkit_theme = antergos\n"
+	"\n"
+	"[branding]\n"
+	"background_images = /usr/share/backgrounds\n";
+
+
+typedef struct {
+	const gchar *name;
+	const gchar *script;           /* Body of the function that is called */
+	void       (*setup)(guint n);
+	guint        n;                /* Passed to setup() */
+	guint        cost;             /* The iteration count is divided by this */
+} BridgeCase;
+
+
+static const BridgeCase cases[] = {
+	{"users-10",         "return __LightDMGreeter.users.length;",   mock_lightdm_set_users,   10,    1},
+	{"users-1000",       "return __LightDMGreeter.users.length;",   mock_lightdm_set_users,   1000,  100},
+	{"users-10000",      "return __LightDMGreeter.users.length;",   mock_lightdm_set_users,   10000, 1000},
+	{"users-50000",      "return __LightDMGreeter.users.length;",   mock_lightdm_set_users,   50000, 5000},
+	{"users-1000-props", "let n = 0;"
+	                     "for (const user of __LightDMGreeter.users) {"
+	                     "  n += user.username.length + user.display_name.length + user.image.length;"
+	                     "}"
+	                     "return n;",                               mock_lightdm_set_users,   1000,  200},
+	{"layouts-1000",     "return __LightDMGreeter.layouts.length;", mock_lightdm_set_layouts, 1000,  100},
+	{"languages",        "return __LightDMGreeter.languages.length;",                          NULL, 0, 1},
+	/* Cold parses the session directory again on every call, as after a change */
+	{"sessions-cold",    "__bench_invalidate_sessions();"
+	                     "return __LightDMGreeter.sessions.length;",                           NULL, 0, 50},
+	{"sessions-warm",    "return __LightDMGreeter.sessions.length;",                           NULL, 0, 1},
+	{"txt2html-plain",   "return __ThemeUtils.txt2html('Bench User 42');",                    NULL, 0, 1},
+	{"txt2html-markup",  "return __ThemeUtils.txt2html('<b>Notice</b> & \"terms\":\\n"
+	                     "Your password will expire in 3 days.');",                           NULL, 0, 1},
+	{"dirlist-200",      "return __ThemeUtils.dirlist(__bench_dir).length;",                  NULL, 0, 50},
+	{"get_conf_str",     "return __GreeterConfig.get_str('greeter', 'webkit_theme');",        NULL, 0, 1},
+	{"get_conf_num",     "return __GreeterConfig.get_num('greeter', 'screensaver_timeout');", NULL, 0, 1},
+	{"get_conf_bool",    "return __GreeterConfig.get_bool('greeter', 'debug_mode');",         NULL, 0, 1},
+	{NULL,               NULL,                                      NULL,                     0,     0}
+};
+
+
+/* ---->>> malloc() accounting <<<---- */
+
+static gint64
+	allocations,
+	allocated_bytes,
+	live_bytes;
+
+#ifdef __GLIBC__
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t n_members, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void __libc_free(void *ptr);
+
+
+static void
+count_allocation(void *ptr, gint64 previous_size) {
+	gint64 size = (NULL != ptr) ? (gint64) malloc_usable_size(ptr) : 0;
+
+	__atomic_add_fetch(&allocations, 1, __ATOMIC_RELAXED);
+	__atomic_add_fetch(&allocated_bytes, size, __ATOMIC_RELAXED);
+	__atomic_add_fetch(&live_bytes, size - previous_size, __ATOMIC_RELAXED);
+}
+
+
+void *
+malloc(size_t size) {
+	void *ptr = __libc_malloc(size);
+
+	count_allocation(ptr, 0);
+
+	return ptr;
+}
+
+
+void *
+calloc(size_t n_members, size_t size) {
+	void *ptr = __libc_calloc(n_members, size);
+
+	count_allocation(ptr, 0);
+
+	return ptr;
+}
+
+
+void *
+realloc(void *ptr, size_t size) {
+	gint64 previous_size = (NULL != ptr) ? (gint64) malloc_usable_size(ptr) : 0;
+	void *result = __libc_realloc(ptr, size);
+
+	if (NULL == result && 0 != size) {
+		/* Failed, `ptr` is untouched */
+		return NULL;
+	}
+
+	count_allocation(result, previous_size);
+
+	return result;
+}
+
+
+void
+free(void *ptr) {
+	if (NULL != ptr) {
+		__atomic_sub_fetch(&live_bytes, (gint64) malloc_usable_size(ptr), __ATOMIC_RELAXED);
+	}
+
+	__libc_free(ptr);
+}
+#endif
+
+
+static gint64
+read_counter(gint64 *counter) {
+	return __atomic_load_n(counter, __ATOMIC_RELAXED);
+}
+
+
+/* ---->>> Fixtures <<<---- */
+
+static gchar *
+create_dirlist_fixture(void) {
+	gchar *dir = g_dir_make_tmp("bridge-bench-XXXXXX", NULL);
+	guint i;
+
+	for (i = 0; NULL != dir && i < DIRLIST_ENTRIES; i++) {
+		gchar *path = g_strdup_printf("%s/background-%03u.jpg", dir, i);
+
+		g_file_set_contents(path, "", 0, NULL);
+		g_free(path);
+	}
+
+	return dir;
+}
+
+
+static void
+remove_dirlist_fixture(gchar *dir) {
+	guint i;
+
+	for (i = 0; i < DIRLIST_ENTRIES; i++) {
+		gchar *path = g_strdup_printf("%s/background-%03u.jpg", dir, i);
+
+		g_unlink(path);
+		g_free(path);
+	}
+
+	g_rmdir(dir);
+	g_free(dir);
+}
+
+
+static gchar *
+create_sessions_fixture(void) {
+	gchar *dir = g_dir_make_tmp("bridge-bench-sessions-XXXXXX", NULL);
+	guint i;
+
+	for (i = 0; NULL != dir && i < SESSION_ENTRIES; i++) {
+		gchar *path = g_strdup_printf("%s/session-%02u.desktop", dir, i);
+		gchar *contents = g_strdup_printf(
+			"[Desktop Entry]\n"
+			"Name=Bench Session %u\n"
+			"Name[de]=Bench-Sitzung %u\n"
+			"Comment=A session for bridge-bench\n"
+			"Exec=/usr/bin/true\n"
+			"Type=Application\n",
+			i, i
+		);
+
+		g_file_set_contents(path, contents, -1, NULL);
+		g_free(contents);
+		g_free(path);
+	}
+
+	return dir;
+}
+
+
+static void
+remove_sessions_fixture(gchar *dir) {
+	guint i;
+
+	for (i = 0; i < SESSION_ENTRIES; i++) {
+		gchar *path = g_strdup_printf("%s/session-%02u.desktop", dir, i);
+
+		g_unlink(path);
+		g_free(path);
+	}
+
+	g_rmdir(dir);
+	g_free(dir);
+}
+
+
+static JSValueRef
+invalidate_sessions_cb(JSContextRef context,
+					   JSObjectRef function,
+					   JSObjectRef thisObject,
+					   size_t argumentCount,
+					   const JSValueRef arguments[],
+					   JSValueRef *exception) {
+	session_catalog_invalidate();
+
+	return JSValueMakeUndefined(context);
+}
+
+
+static void
+evaluate(JSGlobalContextRef context, const gchar *script) {
+	JSStringRef source = JSStringCreateWithUTF8CString(script);
+
+	JSEvaluateScript(context, source, NULL, NULL, 0, NULL);
+	JSStringRelease(source);
+}
+
+
+static gchar *
+exception_to_string(JSContextRef context, JSValueRef exception) {
+	JSStringRef string = JSValueToStringCopy(context, exception, NULL);
+	gchar *result = g_malloc(JSStringGetMaximumUTF8CStringSize(string));
+
+	JSStringGetUTF8CString(string, result, JSStringGetMaximumUTF8CStringSize(string));
+	JSStringRelease(string);
+
+	return result;
+}
+
+
+/* ---->>> Cases <<<---- */
+
+static void
+call_repeatedly(JSGlobalContextRef context, JSObjectRef function, guint iterations, JSValueRef *exception) {
+	guint i;
+
+	for (i = 0; i < iterations && NULL == *exception; i++) {
+		JSObjectCallAsFunction(context, function, NULL, 0, NULL, exception);
+	}
+}
+
+
+static void
+run_case(JSGlobalContextRef context, const BridgeCase *bench, guint iterations) {
+	JSValueRef exception = NULL;
+	JSObjectRef function;
+	JSStringRef source;
+	gchar *script, *message;
+	gint64 start, elapsed, allocations_before, bytes_before, live_before;
+
+	if (NULL != bench->setup) {
+		bench->setup(bench->n);
+	}
+
+	script = g_strdup_printf("(function() { %s })", bench->script);
+	source = JSStringCreateWithUTF8CString(script);
+	function = JSValueToObject(context, JSEvaluateScript(context, source, NULL, NULL, 0, &exception), NULL);
+	JSStringRelease(source);
+	g_free(script);
+
+	if (NULL == function || NULL != exception) {
+		g_printerr("  %-18s failed to compile\n", bench->name);
+		return;
+	}
+
+	JSValueProtect(context, function);
+	iterations = MAX(1, iterations / bench->cost);
+
+	/* Warm up the JIT, allocator and caches */
+	call_repeatedly(context, function, iterations / 10 + 1, &exception);
+	JSGarbageCollect(context);
+
+	allocations_before = read_counter(&allocations);
+	bytes_before = read_counter(&allocated_bytes);
+	live_before = read_counter(&live_bytes);
+
+	start = g_get_monotonic_time();
+	call_repeatedly(context, function, iterations, &exception);
+	elapsed = MAX(1, g_get_monotonic_time() - start);
+
+	if (NULL != exception) {
+		message = exception_to_string(context, exception);
+		g_printerr("  %-18s threw: %s\n", bench->name, message);
+		g_free(message);
+
+	} else {
+		gdouble calls_per_sec = (gdouble) iterations * G_USEC_PER_SEC / elapsed,
+				mallocs = (gdouble) (read_counter(&allocations) - allocations_before) / iterations,
+				bytes = (gdouble) (read_counter(&allocated_bytes) - bytes_before) / iterations;
+
+		/* Whatever the results still hold on to after a collection was retained */
+		JSGarbageCollect(context);
+
+		g_print("  %-18s %8u %14.0f %12.1f %12.1f %14" G_GINT64_FORMAT "\n",
+				bench->name, iterations, calls_per_sec, mallocs, bytes,
+				read_counter(&live_bytes) - live_before);
+	}
+
+	JSValueUnprotect(context, function);
+}
+
+
+int
+main(int argc, char **argv) {
+	JSGlobalContextRef context;
+	const BridgeCase *bench;
+	guint iterations = 20000;
+	gchar *dirlist_dir, *sessions_dir, *script;
+	const gchar *session_dirs[2] = {NULL, NULL};
+	JSStringRef name;
+
+	if (argc > 1) {
+		iterations = (guint) MAX(1, atoi(argv[1]));
+	}
+
+	keyfile = g_key_file_new();
+	g_key_file_load_from_data(keyfile, bench_config, -1, G_KEY_FILE_NONE, NULL);
+
+	mock_lightdm_set_languages(100);
+	mock_lightdm_set_sessions(10);
+
+	sessions_dir = create_sessions_fixture();
+	session_dirs[0] = sessions_dir;
+	session_catalog_init(session_dirs);
+
+	context = JSGlobalContextCreate(NULL);
+	publish_bridge_objects(context, lightdm_greeter_new());
+
+	name = JSStringCreateWithUTF8CString("__bench_invalidate_sessions");
+	JSObjectSetProperty(context, JSContextGetGlobalObject(context), name,
+						JSObjectMakeFunctionWithCallback(context, name, invalidate_sessions_cb),
+						kJSPropertyAttributeNone, NULL);
+	JSStringRelease(name);
+
+	dirlist_dir = create_dirlist_fixture();
+	script = g_strdup_printf("var __bench_dir = '%s';", dirlist_dir);
+	evaluate(context, script);
+	g_free(script);
+
+	g_print("bridge-bench: %u iterations per case (divided by the case's cost)", iterations);
+#ifdef __GLIBC__
+	g_print("\n");
+#else
+	g_print(", malloc() accounting needs glibc\n");
+#endif
+
+	g_print("  %-18s %8s %14s %12s %12s %14s\n",
+			"case", "calls", "calls/sec", "mallocs/call", "bytes/call", "retained bytes");
+
+	for (bench = cases; NULL != bench->name; bench++) {
+		run_case(context, bench, iterations);
+	}
+
+	JSGlobalContextRelease(context);
+	remove_dirlist_fixture(dirlist_dir);
+	remove_sessions_fixture(sessions_dir);
+
+	return 0;
+}
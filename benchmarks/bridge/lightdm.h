@@ -0,0 +1,155 @@
+/*
+ * lightdm.h
+ *
+ * Copyright © 2017 Antergos Developers <dev@antergos.com>
+ *
+ * This file is part of lightdm-webkit2-greeter.
+ *
+ * lightdm-webkit2-greeter is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * lightdm-webkit2-greeter is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * The following additional terms are in effect as per Section 7 of the license:
+ *
+ * The preservation of all legal notices and author attributions in
+ * the material or in the Appropriate Legal Notices displayed
+ * by works containing it is required.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with lightdm-webkit2-greeter; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Stands in for liblightdm-gobject's <lightdm.h> when bridge-bench compiles the web
+ * extension. Every LightDM type is the same plain GObject and the lists are generated
+ * on demand (see mock_lightdm_set_*()), so the bridge can be measured without a daemon,
+ * AccountsService or xkb. Only the API the extension uses is declared.
+ */
+
+#ifndef MOCK_LIGHTDM_H
+#define MOCK_LIGHTDM_H
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+typedef struct _MockLightDMObject LightDMGreeter;
+typedef struct _MockLightDMObject LightDMUser;
+typedef struct _MockLightDMObject LightDMUserList;
+typedef struct _MockLightDMObject LightDMLanguage;
+typedef struct _MockLightDMObject LightDMLayout;
+typedef struct _MockLightDMObject LightDMSession;
+
+typedef enum {
+	LIGHTDM_PROMPT_TYPE_QUESTION,
+	LIGHTDM_PROMPT_TYPE_SECRET
+} LightDMPromptType;
+
+typedef enum {
+	LIGHTDM_MESSAGE_TYPE_INFO,
+	LIGHTDM_MESSAGE_TYPE_ERROR
+} LightDMMessageType;
+
+
+/* ---->>> Benchmark controls <<<---- */
+
+void mock_lightdm_set_users(guint n_users);
+void mock_lightdm_set_languages(guint n_languages);
+void mock_lightdm_set_layouts(guint n_layouts);
+void mock_lightdm_set_sessions(guint n_sessions);
+
+
+/* ---->>> Common <<<---- */
+
+const gchar *lightdm_get_hostname(void);
+GList *lightdm_get_languages(void);
+LightDMLanguage *lightdm_get_language(void);
+GList *lightdm_get_layouts(void);
+LightDMLayout *lightdm_get_layout(void);
+void lightdm_set_layout(LightDMLayout *layout);
+GList *lightdm_get_sessions(void);
+
+gboolean lightdm_get_can_suspend(void);
+gboolean lightdm_get_can_hibernate(void);
+gboolean lightdm_get_can_restart(void);
+gboolean lightdm_get_can_shutdown(void);
+gboolean lightdm_suspend(GError **error);
+gboolean lightdm_hibernate(GError **error);
+gboolean lightdm_restart(GError **error);
+gboolean lightdm_shutdown(GError **error);
+
+
+/* ---->>> Objects <<<---- */
+
+LightDMUserList *lightdm_user_list_get_instance(void);
+GList *lightdm_user_list_get_users(LightDMUserList *user_list);
+
+const gchar *lightdm_user_get_name(LightDMUser *user);
+const gchar *lightdm_user_get_real_name(LightDMUser *user);
+const gchar *lightdm_user_get_display_name(LightDMUser *user);
+const gchar *lightdm_user_get_home_directory(LightDMUser *user);
+const gchar *lightdm_user_get_image(LightDMUser *user);
+const gchar *lightdm_user_get_language(LightDMUser *user);
+const gchar *lightdm_user_get_layout(LightDMUser *user);
+const gchar *lightdm_user_get_session(LightDMUser *user);
+gboolean lightdm_user_get_logged_in(LightDMUser *user);
+
+const gchar *lightdm_language_get_code(LightDMLanguage *language);
+const gchar *lightdm_language_get_name(LightDMLanguage *language);
+const gchar *lightdm_language_get_territory(LightDMLanguage *language);
+
+const gchar *lightdm_layout_get_name(LightDMLayout *layout);
+const gchar *lightdm_layout_get_short_description(LightDMLayout *layout);
+const gchar *lightdm_layout_get_description(LightDMLayout *layout);
+
+const gchar *lightdm_session_get_key(LightDMSession *session);
+const gchar *lightdm_session_get_name(LightDMSession *session);
+const gchar *lightdm_session_get_comment(LightDMSession *session);
+
+
+/* ---->>> Greeter <<<---- */
+
+LightDMGreeter *lightdm_greeter_new(void);
+gboolean lightdm_greeter_connect_sync(LightDMGreeter *greeter, GError **error);
+
+const gchar *lightdm_greeter_get_hint(LightDMGreeter *greeter, const gchar *name);
+const gchar *lightdm_greeter_get_default_session_hint(LightDMGreeter *greeter);
+gboolean lightdm_greeter_get_hide_users_hint(LightDMGreeter *greeter);
+gboolean lightdm_greeter_get_has_guest_account_hint(LightDMGreeter *greeter);
+const gchar *lightdm_greeter_get_select_user_hint(LightDMGreeter *greeter);
+gboolean lightdm_greeter_get_select_guest_hint(LightDMGreeter *greeter);
+const gchar *lightdm_greeter_get_autologin_user_hint(LightDMGreeter *greeter);
+gboolean lightdm_greeter_get_autologin_guest_hint(LightDMGreeter *greeter);
+gint lightdm_greeter_get_autologin_timeout_hint(LightDMGreeter *greeter);
+gboolean lightdm_greeter_get_lock_hint(LightDMGreeter *greeter);
+void lightdm_greeter_cancel_autologin(LightDMGreeter *greeter);
+
+gboolean lightdm_greeter_get_in_authentication(LightDMGreeter *greeter);
+gboolean lightdm_greeter_get_is_authenticated(LightDMGreeter *greeter);
+const gchar *lightdm_greeter_get_authentication_user(LightDMGreeter *greeter);
+gboolean lightdm_greeter_start_session_sync(LightDMGreeter *greeter, const gchar *session, GError **error);
+
+#ifdef HAS_LIGHTDM_1_19_2
+gboolean lightdm_greeter_authenticate(LightDMGreeter *greeter, const gchar *username, GError **error);
+gboolean lightdm_greeter_authenticate_as_guest(LightDMGreeter *greeter, GError **error);
+gboolean lightdm_greeter_respond(LightDMGreeter *greeter, const gchar *response, GError **error);
+gboolean lightdm_greeter_cancel_authentication(LightDMGreeter *greeter, GError **error);
+gboolean lightdm_greeter_set_language(LightDMGreeter *greeter, const gchar *language, GError **error);
+gchar *lightdm_greeter_ensure_shared_data_dir_sync(LightDMGreeter *greeter, const gchar *username, GError **error);
+#else
+void lightdm_greeter_authenticate(LightDMGreeter *greeter, const gchar *username);
+void lightdm_greeter_authenticate_as_guest(LightDMGreeter *greeter);
+void lightdm_greeter_respond(LightDMGreeter *greeter, const gchar *response);
+void lightdm_greeter_cancel_authentication(LightDMGreeter *greeter);
+void lightdm_greeter_set_language(LightDMGreeter *greeter, const gchar *language);
+gchar *lightdm_greeter_ensure_shared_data_dir_sync(LightDMGreeter *greeter, const gchar *username);
+#endif
+
+G_END_DECLS
+
+#endif /* MOCK_LIGHTDM_H */
@@ -0,0 +1,339 @@
+/*
+ * mock-lightdm.c
+ *
+ * Copyright © 2017 Antergos Developers <dev@antergos.com>
+ *
+ * This file is part of lightdm-webkit2-greeter.
+ *
+ * lightdm-webkit2-greeter is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * lightdm-webkit2-greeter is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * The following additional terms are in effect as per Section 7 of the license:
+ *
+ * The preservation of all legal notices and author attributions in
+ * the material or in the Appropriate Legal Notices displayed
+ * by works containing it is required.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with lightdm-webkit2-greeter; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include "lightdm.h"
+
+
+typedef struct _MockLightDMObject MockLightDMObject;
+
+struct _MockLightDMObject {
+	GObject parent_instance;
+
+	gchar *name;
+	gchar *real_name;
+	gchar *home_directory;
+	gchar *image;
+	gchar *language;
+	gchar *layout;
+	gchar *session;
+	gchar *description;
+	gchar *territory;
+};
+
+typedef struct {
+	GObjectClass parent_class;
+} MockLightDMObjectClass;
+
+G_DEFINE_TYPE(MockLightDMObject, mock_lightdm_object, G_TYPE_OBJECT)
+
+
+static GList
+	*users,
+	*languages,
+	*layouts,
+	*sessions;
+
+static LightDMUserList *user_list;
+
+
+static void
+mock_lightdm_object_finalize(GObject *object) {
+	MockLightDMObject *self = (MockLightDMObject *) object;
+
+	g_free(self->name);
+	g_free(self->real_name);
+	g_free(self->home_directory);
+	g_free(self->image);
+	g_free(self->language);
+	g_free(self->layout);
+	g_free(self->session);
+	g_free(self->description);
+	g_free(self->territory);
+
+	G_OBJECT_CLASS(mock_lightdm_object_parent_class)->finalize(object);
+}
+
+
+static void
+mock_lightdm_object_class_init(MockLightDMObjectClass *klass) {
+	G_OBJECT_CLASS(klass)->finalize = mock_lightdm_object_finalize;
+}
+
+
+static void
+mock_lightdm_object_init(MockLightDMObject *self) {
+}
+
+
+static MockLightDMObject *
+mock_object_new(gchar *name) {
+	MockLightDMObject *object = g_object_new(mock_lightdm_object_get_type(), NULL);
+
+	object->name = name;
+
+	return object;
+}
+
+
+static void
+replace_list(GList **list, GList *items) {
+	g_list_free_full(*list, g_object_unref);
+	*list = items;
+}
+
+
+/*
+ * Users look like the ones liblightdm builds from /etc/passwd and AccountsService.
+ */
+void
+mock_lightdm_set_users(guint n_users) {
+	GList *items = NULL;
+	guint i;
+
+	for (i = n_users; i > 0; i--) {
+		MockLightDMObject *user = mock_object_new(g_strdup_printf("user%u", i - 1));
+
+		user->real_name = g_strdup_printf("Bench User %u", i - 1);
+		user->home_directory = g_strdup_printf("/home/%s", user->name);
+		user->image = g_strdup_printf("/var/lib/AccountsService/icons/%s", user->name);
+		user->language = g_strdup("en_US.UTF-8");
+		user->layout = g_strdup("us");
+		user->session = g_strdup("session0");
+
+		items = g_list_prepend(items, user);
+	}
+
+	replace_list(&users, items);
+}
+
+
+void
+mock_lightdm_set_languages(guint n_languages) {
+	GList *items = NULL;
+	guint i;
+
+	for (i = n_languages; i > 0; i--) {
+		MockLightDMObject *language = mock_object_new(g_strdup_printf("l%u_XX.UTF-8", i - 1));
+
+		language->description = g_strdup_printf("Language %u", i - 1);
+		language->territory = g_strdup_printf("Territory %u", i - 1);
+
+		items = g_list_prepend(items, language);
+	}
+
+	replace_list(&languages, items);
+}
+
+
+void
+mock_lightdm_set_layouts(guint n_layouts) {
+	GList *items = NULL;
+	guint i;
+
+	for (i = n_layouts; i > 0; i--) {
+		MockLightDMObject *layout = mock_object_new(g_strdup_printf("l%u", i - 1));
+
+		layout->real_name = g_strdup_printf("l%u", i - 1);
+		layout->description = g_strdup_printf("Layout %u", i - 1);
+
+		items = g_list_prepend(items, layout);
+	}
+
+	replace_list(&layouts, items);
+}
+
+
+void
+mock_lightdm_set_sessions(guint n_sessions) {
+	GList *items = NULL;
+	guint i;
+
+	for (i = n_sessions; i > 0; i--) {
+		MockLightDMObject *session = mock_object_new(g_strdup_printf("session%u", i - 1));
+
+		session->real_name = g_strdup_printf("Session %u", i - 1);
+		session->description = g_strdup_printf("Benchmark session %u", i - 1);
+
+		items = g_list_prepend(items, session);
+	}
+
+	replace_list(&sessions, items);
+}
+
+
+/* ---->>> Common <<<---- */
+
+const gchar *
+lightdm_get_hostname(void) {
+	return "bench";
+}
+
+GList *
+lightdm_get_languages(void) {
+	return languages;
+}
+
+LightDMLanguage *
+lightdm_get_language(void) {
+	return (NULL != languages) ? languages->data : NULL;
+}
+
+GList *
+lightdm_get_layouts(void) {
+	return layouts;
+}
+
+LightDMLayout *
+lightdm_get_layout(void) {
+	return (NULL != layouts) ? layouts->data : NULL;
+}
+
+void
+lightdm_set_layout(LightDMLayout *layout) {
+	g_object_unref(layout);
+}
+
+GList *
+lightdm_get_sessions(void) {
+	return sessions;
+}
+
+gboolean lightdm_get_can_suspend(void)   { return TRUE; }
+gboolean lightdm_get_can_hibernate(void) { return TRUE; }
+gboolean lightdm_get_can_restart(void)   { return TRUE; }
+gboolean lightdm_get_can_shutdown(void)  { return TRUE; }
+
+gboolean lightdm_suspend(GError **error)   { return TRUE; }
+gboolean lightdm_hibernate(GError **error) { return TRUE; }
+gboolean lightdm_restart(GError **error)   { return TRUE; }
+gboolean lightdm_shutdown(GError **error)  { return TRUE; }
+
+
+/* ---->>> Objects <<<---- */
+
+LightDMUserList *
+lightdm_user_list_get_instance(void) {
+	if (NULL == user_list) {
+		user_list = mock_object_new(NULL);
+	}
+
+	return user_list;
+}
+
+GList *
+lightdm_user_list_get_users(LightDMUserList *list) {
+	return users;
+}
+
+const gchar *lightdm_user_get_name(LightDMUser *user)           { return user->name; }
+const gchar *lightdm_user_get_real_name(LightDMUser *user)      { return user->real_name; }
+const gchar *lightdm_user_get_display_name(LightDMUser *user)   { return user->real_name; }
+const gchar *lightdm_user_get_home_directory(LightDMUser *user) { return user->home_directory; }
+const gchar *lightdm_user_get_image(LightDMUser *user)          { return user->image; }
+const gchar *lightdm_user_get_language(LightDMUser *user)       { return user->language; }
+const gchar *lightdm_user_get_layout(LightDMUser *user)         { return user->layout; }
+const gchar *lightdm_user_get_session(LightDMUser *user)        { return user->session; }
+gboolean lightdm_user_get_logged_in(LightDMUser *user)          { return FALSE; }
+
+const gchar *lightdm_language_get_code(LightDMLanguage *language)      { return language->name; }
+const gchar *lightdm_language_get_name(LightDMLanguage *language)      { return language->description; }
+const gchar *lightdm_language_get_territory(LightDMLanguage *language) { return language->territory; }
+
+const gchar *lightdm_layout_get_name(LightDMLayout *layout)              { return layout->name; }
+const gchar *lightdm_layout_get_short_description(LightDMLayout *layout) { return layout->real_name; }
+const gchar *lightdm_layout_get_description(LightDMLayout *layout)       { return layout->description; }
+
+const gchar *lightdm_session_get_key(LightDMSession *session)     { return session->name; }
+const gchar *lightdm_session_get_name(LightDMSession *session)    { return session->real_name; }
+const gchar *lightdm_session_get_comment(LightDMSession *session) { return session->description; }
+
+
+/* ---->>> Greeter <<<---- */
+
+LightDMGreeter *
+lightdm_greeter_new(void) {
+	return mock_object_new(NULL);
+}
+
+gboolean
+lightdm_greeter_connect_sync(LightDMGreeter *greeter, GError **error) {
+	return TRUE;
+}
+
+const gchar *
+lightdm_greeter_get_hint(LightDMGreeter *greeter, const gchar *name) {
+	return NULL;
+}
+
+const gchar *
+lightdm_greeter_get_default_session_hint(LightDMGreeter *greeter) {
+	return "session0";
+}
+
+gboolean lightdm_greeter_get_hide_users_hint(LightDMGreeter *greeter)              { return FALSE; }
+gboolean lightdm_greeter_get_has_guest_account_hint(LightDMGreeter *greeter)       { return FALSE; }
+const gchar *lightdm_greeter_get_select_user_hint(LightDMGreeter *greeter)         { return NULL; }
+gboolean lightdm_greeter_get_select_guest_hint(LightDMGreeter *greeter)            { return FALSE; }
+const gchar *lightdm_greeter_get_autologin_user_hint(LightDMGreeter *greeter)      { return NULL; }
+gboolean lightdm_greeter_get_autologin_guest_hint(LightDMGreeter *greeter)         { return FALSE; }
+gint lightdm_greeter_get_autologin_timeout_hint(LightDMGreeter *greeter)           { return 0; }
+gboolean lightdm_greeter_get_lock_hint(LightDMGreeter *greeter)                    { return FALSE; }
+void lightdm_greeter_cancel_autologin(LightDMGreeter *greeter)                     { }
+
+gboolean lightdm_greeter_get_in_authentication(LightDMGreeter *greeter)            { return FALSE; }
+gboolean lightdm_greeter_get_is_authenticated(LightDMGreeter *greeter)             { return FALSE; }
+const gchar *lightdm_greeter_get_authentication_user(LightDMGreeter *greeter)      { return NULL; }
+
+gboolean
+lightdm_greeter_start_session_sync(LightDMGreeter *greeter, const gchar *session, GError **error) {
+	return TRUE;
+}
+
+#ifdef HAS_LIGHTDM_1_19_2
+gboolean lightdm_greeter_authenticate(LightDMGreeter *greeter, const gchar *username, GError **error)  { return TRUE; }
+gboolean lightdm_greeter_authenticate_as_guest(LightDMGreeter *greeter, GError **error)               { return TRUE; }
+gboolean lightdm_greeter_respond(LightDMGreeter *greeter, const gchar *response, GError **error)      { return TRUE; }
+gboolean lightdm_greeter_cancel_authentication(LightDMGreeter *greeter, GError **error)               { return TRUE; }
+gboolean lightdm_greeter_set_language(LightDMGreeter *greeter, const gchar *language, GError **error) { return TRUE; }
+
+gchar *
+lightdm_greeter_ensure_shared_data_dir_sync(LightDMGreeter *greeter, const gchar *username, GError **error) {
+	return g_strdup_printf("/var/lib/lightdm-data/%s", username);
+}
+#else
+void lightdm_greeter_authenticate(LightDMGreeter *greeter, const gchar *username)  { }
+void lightdm_greeter_authenticate_as_guest(LightDMGreeter *greeter)               { }
+void lightdm_greeter_respond(LightDMGreeter *greeter, const gchar *response)      { }
+void lightdm_greeter_cancel_authentication(LightDMGreeter *greeter)               { }
+void lightdm_greeter_set_language(LightDMGreeter *greeter, const gchar *language) { }
+
+gchar *
+lightdm_greeter_ensure_shared_data_dir_sync(LightDMGreeter *greeter, const gchar *username) {
+	return g_strdup_printf("/var/lib/lightdm-data/%s", username);
+}
+#endif
@@ -0,0 +1,360 @@
+/*
+ * fake-system.c
+ *
+ * Copyright © 2017 Antergos Developers <dev@antergos.com>
+ *
+ * This file is part of lightdm-webkit2-greeter.
+ *
+ * lightdm-webkit2-greeter is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * lightdm-webkit2-greeter is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * The following additional terms are in effect as per Section 7 of the license:
+ *
+ * The preservation of all legal notices and author attributions in
+ * the material or in the Appropriate Legal Notices displayed
+ * by works containing it is required.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with lightdm-webkit2-greeter; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* LD_PRELOAD shim that makes liblightdm see the fixture written by greeter-e2e-bench.py
+ * instead of the system it runs on. liblightdm reads users, sessions and keyboard layouts
+ * on the client side, so the mock daemon alone can't script them:
+ *
+ *   * Paths below the prefixes in `remapped_prefixes` are looked up below
+ *     $GREETER_BENCH_ROOT instead.
+ *   * getpwent() and friends enumerate $GREETER_BENCH_ROOT/etc/passwd. Lookups of users
+ *     that are not in the fixture fall through to the real database so that GLib can
+ *     still find the home directory of the user running the benchmark.
+ *
+ * Only the calls GLib, liblightdm and libxklavier actually use are wrapped.
+ */
+
+#define _GNU_SOURCE
+
+#include <dirent.h>
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pwd.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+
+#define REAL(func) \
+	static __typeof__(func) *real_##func; \
+	if (NULL == real_##func) { real_##func = dlsym(RTLD_NEXT, #func); }
+
+
+static const char *remapped_prefixes[] = {
+	"/usr/share/xsessions",
+	"/usr/share/wayland-sessions",
+	"/usr/share/X11/xkb/rules",
+	NULL
+};
+
+static FILE *passwd_file;
+
+
+/*
+ * Returns `path` or, when it should come from the fixture, its location below
+ * $GREETER_BENCH_ROOT (written to `buffer`).
+ */
+static const char *
+remap(const char *path, char *buffer) {
+	const char *root = getenv("GREETER_BENCH_ROOT");
+	const char **prefix;
+
+	if (NULL == path || NULL == root || '/' != path[0]) {
+		return path;
+	}
+
+	for (prefix = remapped_prefixes; NULL != *prefix; prefix++) {
+		size_t length = strlen(*prefix);
+
+		if (0 == strncmp(path, *prefix, length) && ('\0' == path[length] || '/' == path[length])) {
+			if (snprintf(buffer, PATH_MAX, "%s%s", root, path) < PATH_MAX) {
+				return buffer;
+			}
+		}
+	}
+
+	return path;
+}
+
+
+static const char *
+get_passwd_path(char *buffer) {
+	const char *root = getenv("GREETER_BENCH_ROOT");
+
+	if (NULL == root || snprintf(buffer, PATH_MAX, "%s/etc/passwd", root) >= PATH_MAX) {
+		return NULL;
+	}
+
+	return buffer;
+}
+
+
+/* ---------------------------------------------------------------- files */
+
+int
+open(const char *path, int flags, ...) {
+	char buffer[PATH_MAX];
+	mode_t mode = 0;
+	REAL(open);
+
+	if (flags & (O_CREAT | O_TMPFILE)) {
+		va_list args;
+		va_start(args, flags);
+		mode = va_arg(args, mode_t);
+		va_end(args);
+	}
+
+	return real_open(remap(path, buffer), flags, mode);
+}
+
+
+int
+open64(const char *path, int flags, ...) {
+	char buffer[PATH_MAX];
+	mode_t mode = 0;
+	REAL(open64);
+
+	if (flags & (O_CREAT | O_TMPFILE)) {
+		va_list args;
+		va_start(args, flags);
+		mode = va_arg(args, mode_t);
+		va_end(args);
+	}
+
+	return real_open64(remap(path, buffer), flags, mode);
+}
+
+
+int
+openat(int dirfd, const char *path, int flags, ...) {
+	char buffer[PATH_MAX];
+	mode_t mode = 0;
+	REAL(openat);
+
+	if (flags & (O_CREAT | O_TMPFILE)) {
+		va_list args;
+		va_start(args, flags);
+		mode = va_arg(args, mode_t);
+		va_end(args);
+	}
+
+	return real_openat(dirfd, remap(path, buffer), flags, mode);
+}
+
+
+FILE *
+fopen(const char *path, const char *mode) {
+	char buffer[PATH_MAX];
+	REAL(fopen);
+
+	return real_fopen(remap(path, buffer), mode);
+}
+
+
+FILE *
+fopen64(const char *path, const char *mode) {
+	char buffer[PATH_MAX];
+	REAL(fopen64);
+
+	return real_fopen64(remap(path, buffer), mode);
+}
+
+
+DIR *
+opendir(const char *path) {
+	char buffer[PATH_MAX];
+	REAL(opendir);
+
+	return real_opendir(remap(path, buffer));
+}
+
+
+int
+access(const char *path, int mode) {
+	char buffer[PATH_MAX];
+	REAL(access);
+
+	return real_access(remap(path, buffer), mode);
+}
+
+
+int
+stat(const char *path, struct stat *result) {
+	char buffer[PATH_MAX];
+	REAL(stat);
+
+	return real_stat(remap(path, buffer), result);
+}
+
+
+int
+lstat(const char *path, struct stat *result) {
+	char buffer[PATH_MAX];
+	REAL(lstat);
+
+	return real_lstat(remap(path, buffer), result);
+}
+
+
+int
+stat64(const char *path, struct stat64 *result) {
+	char buffer[PATH_MAX];
+	REAL(stat64);
+
+	return real_stat64(remap(path, buffer), result);
+}
+
+
+int
+lstat64(const char *path, struct stat64 *result) {
+	char buffer[PATH_MAX];
+	REAL(lstat64);
+
+	return real_lstat64(remap(path, buffer), result);
+}
+
+
+int
+fstatat(int dirfd, const char *path, struct stat *result, int flags) {
+	char buffer[PATH_MAX];
+	REAL(fstatat);
+
+	return real_fstatat(dirfd, remap(path, buffer), result, flags);
+}
+
+
+/* GLib 2.66 and later query file info with statx() */
+int
+statx(int dirfd, const char *path, int flags, unsigned int mask, struct statx *result) {
+	char buffer[PATH_MAX];
+	REAL(statx);
+
+	return real_statx(dirfd, remap(path, buffer), flags, mask, result);
+}
+
+
+/* glibc before 2.33 routes stat() through these */
+int
+__xstat(int version, const char *path, struct stat *result) {
+	char buffer[PATH_MAX];
+	static int (*real_xstat)(int, const char *, struct stat *);
+
+	if (NULL == real_xstat) {
+		real_xstat = dlsym(RTLD_NEXT, "__xstat");
+	}
+
+	return real_xstat(version, remap(path, buffer), result);
+}
+
+
+int
+__xstat64(int version, const char *path, struct stat64 *result) {
+	char buffer[PATH_MAX];
+	static int (*real_xstat64)(int, const char *, struct stat64 *);
+
+	if (NULL == real_xstat64) {
+		real_xstat64 = dlsym(RTLD_NEXT, "__xstat64");
+	}
+
+	return real_xstat64(version, remap(path, buffer), result);
+}
+
+
+/* ---------------------------------------------------------------- users */
+
+void
+setpwent(void) {
+	char buffer[PATH_MAX];
+	const char *path = get_passwd_path(buffer);
+	REAL(fopen);
+
+	if (NULL != passwd_file) {
+		rewind(passwd_file);
+	} else if (NULL != path) {
+		passwd_file = real_fopen(path, "re");
+	}
+}
+
+
+void
+endpwent(void) {
+	if (NULL != passwd_file) {
+		fclose(passwd_file);
+		passwd_file = NULL;
+	}
+}
+
+
+struct passwd *
+getpwent(void) {
+	if (NULL == passwd_file) {
+		setpwent();
+	}
+
+	return (NULL == passwd_file) ? NULL : fgetpwent(passwd_file);
+}
+
+
+/*
+ * Returns the fixture entry matching `name` (or `uid` when `name` is NULL) or NULL.
+ */
+static struct passwd *
+find_fixture_user(const char *name, uid_t uid) {
+	char buffer[PATH_MAX];
+	const char *path = get_passwd_path(buffer);
+	struct passwd *entry;
+	FILE *file;
+	REAL(fopen);
+
+	if (NULL == path || NULL == (file = real_fopen(path, "re"))) {
+		return NULL;
+	}
+
+	while (NULL != (entry = fgetpwent(file))) {
+		if ((NULL != name) ? (0 == strcmp(name, entry->pw_name)) : (uid == entry->pw_uid)) {
+			break;
+		}
+	}
+
+	fclose(file);
+
+	/* fgetpwent() returns a static buffer that survives fclose() */
+	return entry;
+}
+
+
+struct passwd *
+getpwnam(const char *name) {
+	struct passwd *entry = find_fixture_user(name, 0);
+	REAL(getpwnam);
+
+	return (NULL != entry) ? entry : real_getpwnam(name);
+}
+
+
+struct passwd *
+getpwuid(uid_t uid) {
+	struct passwd *entry = find_fixture_user(NULL, uid);
+	REAL(getpwuid);
+
+	return (NULL != entry) ? entry : real_getpwuid(uid);
+}
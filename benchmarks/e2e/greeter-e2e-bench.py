@@ -0,0 +1,717 @@
+#!/usr/bin/env python3
+#
+# greeter-e2e-bench.py
+#
+# Copyright © 2017 Antergos Developers <dev@antergos.com>
+#
+# This file is part of lightdm-webkit2-greeter.
+#
+# lightdm-webkit2-greeter is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# lightdm-webkit2-greeter is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+# GNU General Public License for more details.
+#
+# The following additional terms are in effect as per Section 7 of the license:
+#
+# The preservation of all legal notices and author attributions in
+# the material or in the Appropriate Legal Notices displayed
+# by works containing it is required.
+#
+# You should have received a copy of the GNU General Public License
+# along with lightdm-webkit2-greeter; If not, see <http://www.gnu.org/licenses/>.
+
+"""
+End-to-end greeter benchmark.
+
+Starts the greeter under Xvfb and plays the part of the LightDM daemon on the other end
+of its pipes. Users, sessions and keyboard layouts come from a generated fixture that
+fake-system.so (LD_PRELOAD) puts in place of the real ones. Each theme is logged into
+with the keyboard (xdotool), the way a person would, and the following is reported:
+
+    connect        Greeter started -> greeter connected to the daemon
+    paint          Greeter started -> first frame drawn after the theme's load was committed
+    idle           Greeter started -> greeter and web process stopped using the CPU
+    prompt         Greeter started -> daemon sent the first PAM prompt
+    respond        Enter pressed on the password -> password reached the daemon
+    login          Enter pressed on the password -> greeter asked to start the session
+    exit           SIGTERM sent -> greeter exited
+    rss            RSS of the greeter and its web process when the session starts (KiB)
+    size           Size of the theme's directory in THEME_DIR (KiB)
+
+Themes are loaded from the greeter's THEME_DIR, so configure the build with
+-Dwith-theme-dir=$PWD/themes to benchmark the themes in the source tree. Themes that
+were not precompiled (-Dprecompile-themes) also load files from _vendor, which their
+size doesn't include.
+
+--webext-dir only takes effect in greeters built with -Denable-benchmarks=true, other
+builds always load the installed web extension.
+"""
+
+import argparse
+import json
+import os
+import queue
+import re
+import signal
+import socket
+import statistics
+import struct
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+
+# Greeter -> daemon
+GREETER_MESSAGE_CONNECT = 0
+GREETER_MESSAGE_AUTHENTICATE = 1
+GREETER_MESSAGE_AUTHENTICATE_AS_GUEST = 2
+GREETER_MESSAGE_CONTINUE_AUTHENTICATION = 3
+GREETER_MESSAGE_START_SESSION = 4
+GREETER_MESSAGE_CANCEL_AUTHENTICATION = 5
+GREETER_MESSAGE_SET_LANGUAGE = 6
+GREETER_MESSAGE_ENSURE_SHARED_DIR = 8
+
+# Daemon -> greeter
+SERVER_MESSAGE_CONNECTED = 0
+SERVER_MESSAGE_PROMPT_AUTHENTICATION = 1
+SERVER_MESSAGE_END_AUTHENTICATION = 2
+SERVER_MESSAGE_SESSION_RESULT = 3
+SERVER_MESSAGE_SHARED_DIR_RESULT = 4
+
+# PAM message styles
+PAM_PROMPT_ECHO_OFF = 1
+PAM_PROMPT_ECHO_ON = 2
+PAM_TEXT_INFO = 4
+
+PAM_SUCCESS = 0
+
+METRICS = ['connect', 'paint', 'idle', 'prompt', 'respond', 'login', 'exit', 'rss', 'size']
+
+FIRST_PAINT_RE = re.compile(r'^greeter_startup_phase_seconds\{phase="first_paint"\} (\S+)$', re.M)
+
+
+class BenchmarkError(Exception):
+	pass
+
+
+def now_ms():
+	return time.monotonic() * 1000
+
+
+# --------------------------------------------------------------- fixture
+
+class Fixture:
+	"""
+	Everything the greeter reads from disk: the users, sessions and layouts liblightdm
+	enumerates (see fake-system.c), the greeter config file and a LightDM data directory.
+	"""
+
+	def __init__(self, root, args):
+		self.root = root
+		self.args = args
+
+		self.config_file = os.path.join(root, 'lightdm-webkit2-greeter.conf')
+		self.shared_dir = os.path.join(root, 'var/lib/lightdm-data')
+		self.cache_dir = os.path.join(root, 'cache')
+		self.runtime_dir = os.path.join(root, 'run')
+		# See greeter_paths_get_metrics_socket()
+		self.metrics_socket = os.path.join(self.runtime_dir, 'lightdm-webkit2-greeter/metrics-seat0.sock')
+		self.usernames = ['bench{}'.format(i) for i in range(args.users)]
+
+		self._write_passwd()
+		self._write_sessions()
+		self._write_layouts()
+
+		os.makedirs(self.shared_dir)
+		os.makedirs(self.cache_dir)
+		os.makedirs(self.runtime_dir, mode=0o700)
+
+	def _path(self, relative):
+		path = os.path.join(self.root, relative)
+		os.makedirs(os.path.dirname(path), exist_ok=True)
+
+		return path
+
+	def _write_passwd(self):
+		with open(self._path('etc/passwd'), 'w') as passwd:
+			for uid, username in enumerate(self.usernames, 2000):
+				passwd.write('{0}:x:{1}:{1}:Bench User {2}:/home/{0}:/bin/bash\n'.format(
+					username, uid, uid - 2000
+				))
+
+	def _write_sessions(self):
+		for i in range(self.args.sessions):
+			with open(self._path('usr/share/xsessions/bench{}.desktop'.format(i)), 'w') as desktop:
+				desktop.write(
+					'[Desktop Entry]\nType=Application\nName=Bench Session {0}\n'
+					'Comment=Benchmark session {0}\nExec=true\n'.format(i)
+				)
+
+	def _write_layouts(self):
+		layouts = []
+
+		for i in range(self.args.layouts):
+			layouts.append(
+				'<layout><configItem><name>b{0}</name><shortDescription>b{0}</shortDescription>'
+				'<description>Bench Layout {0}</description></configItem>'
+				'<variantList><variant><configItem><name>alt</name>'
+				'<description>Bench Layout {0} (alt)</description></configItem></variant>'
+				'</variantList></layout>'.format(i)
+			)
+
+		with open(self._path('usr/share/X11/xkb/rules/evdev.xml'), 'w') as registry:
+			registry.write(
+				'<?xml version="1.0" encoding="UTF-8"?>\n<xkbConfigRegistry version="1.1">'
+				'<modelList/><layoutList>{}</layoutList><optionList/></xkbConfigRegistry>\n'.format(
+					''.join(layouts)
+				)
+			)
+
+	def write_config(self, theme):
+		with open(self.config_file, 'w') as config:
+			config.write(
+				'[greeter]\n'
+				'clock_tick_interval = 60\n'
+				'debug_mode = false\n'
+				'detect_theme_errors = false\n'
+				'low_power_mode = true\n'
+				'metrics_socket = true\n'
+				'screensaver_timeout = 300\n'
+				'secure_mode = true\n'
+				'speculative_authentication = false\n'
+				'time_format = LT\n'
+				'time_language = auto\n'
+				'webkit_theme = {}\n'
+				'\n'
+				'[branding]\n'
+				'background_images = /usr/share/backgrounds\n'
+				'logo = /usr/share/pixmaps/archlinux-logo.svg\n'
+				'user_image = /usr/share/pixmaps/archlinux-user.svg\n'.format(theme)
+			)
+
+
+# ------------------------------------------------------------ mock daemon
+
+class MockDaemon:
+	"""
+	The daemon's side of the greeter protocol (see liblightdm-gobject/greeter.c).
+	Messages from the greeter are queued together with the time they arrived.
+	"""
+
+	def __init__(self, shared_dir):
+		self.shared_dir = shared_dir
+		self.from_greeter, self.greeter_to_server = os.pipe()
+		self.greeter_from_server, self.to_greeter = os.pipe()
+		self.messages = queue.Queue()
+
+		os.set_inheritable(self.greeter_to_server, True)
+		os.set_inheritable(self.greeter_from_server, True)
+
+		self._reader = threading.Thread(target=self._read_messages, daemon=True)
+
+	def start(self):
+		# Our copies of the greeter's ends must be closed or we would never see EOF
+		os.close(self.greeter_to_server)
+		os.close(self.greeter_from_server)
+		self._reader.start()
+
+	def close(self):
+		os.close(self.to_greeter)
+
+	@property
+	def greeter_fds(self):
+		return (self.greeter_to_server, self.greeter_from_server)
+
+	def _read_exactly(self, length):
+		data = b''
+
+		while len(data) < length:
+			chunk = os.read(self.from_greeter, length - len(data))
+
+			if not chunk:
+				return None
+
+			data += chunk
+
+		return data
+
+	def _read_messages(self):
+		while True:
+			header = self._read_exactly(8)
+
+			if header is None:
+				break
+
+			message_id, length = struct.unpack('>II', header)
+			payload = self._read_exactly(length) if length else b''
+
+			if payload is None:
+				break
+
+			self.messages.put((now_ms(), message_id, payload))
+
+		os.close(self.from_greeter)
+		self.messages.put((now_ms(), None, b''))
+
+	def wait_for(self, wanted, timeout):
+		"""
+		Returns (time, payload) of the next `wanted` message. Requests we don't script
+		(language changes, shared data directories) are answered along the way.
+		"""
+		deadline = time.monotonic() + timeout
+
+		while True:
+			remaining = deadline - time.monotonic()
+
+			if remaining <= 0:
+				raise BenchmarkError('timed out waiting for greeter message {}'.format(wanted))
+
+			try:
+				received, message_id, payload = self.messages.get(timeout=remaining)
+			except queue.Empty:
+				continue
+
+			if message_id is None:
+				raise BenchmarkError('greeter closed its connection')
+
+			if message_id == wanted:
+				return received, payload
+
+			if message_id == GREETER_MESSAGE_ENSURE_SHARED_DIR:
+				username = read_string(payload, 0)[0]
+				self.send(SERVER_MESSAGE_SHARED_DIR_RESULT, pack_string(os.path.join(self.shared_dir, username)))
+
+	def send(self, message_id, payload=b''):
+		os.write(self.to_greeter, struct.pack('>II', message_id, len(payload)) + payload)
+
+	def connected(self, hints):
+		payload = pack_string('1.30.0')
+
+		for name, value in hints.items():
+			payload += pack_string(name) + pack_string(value)
+
+		self.send(SERVER_MESSAGE_CONNECTED, payload)
+
+	def prompt(self, sequence, username, style, text):
+		self.send(
+			SERVER_MESSAGE_PROMPT_AUTHENTICATION,
+			struct.pack('>I', sequence) + pack_string(username) + struct.pack('>II', 1, style) + pack_string(text)
+		)
+
+	def end_authentication(self, sequence, username, result):
+		self.send(
+			SERVER_MESSAGE_END_AUTHENTICATION,
+			struct.pack('>I', sequence) + pack_string(username) + struct.pack('>I', result)
+		)
+
+
+def pack_string(value):
+	data = value.encode('utf-8')
+
+	return struct.pack('>I', len(data)) + data
+
+
+def read_string(payload, offset):
+	length, = struct.unpack_from('>I', payload, offset)
+	offset += 4
+
+	return payload[offset:offset + length].decode('utf-8'), offset + length
+
+
+def read_int(payload, offset):
+	return struct.unpack_from('>I', payload, offset)[0], offset + 4
+
+
+def read_secrets(payload):
+	count, offset = read_int(payload, 0)
+	secrets = []
+
+	for i in range(count):
+		secret, offset = read_string(payload, offset)
+		secrets.append(secret)
+
+	return secrets
+
+
+# --------------------------------------------------------------- processes
+
+def process_tree(root_pid):
+	children = {}
+
+	for entry in os.listdir('/proc'):
+		if not entry.isdigit():
+			continue
+
+		try:
+			with open('/proc/{}/stat'.format(entry)) as stat:
+				fields = stat.read().rsplit(')', 1)[1].split()
+		except OSError:
+			continue
+
+		children.setdefault(int(fields[1]), []).append(int(entry))
+
+	pids, pending = [], [root_pid]
+
+	while pending:
+		pid = pending.pop()
+		pids.append(pid)
+		pending.extend(children.get(pid, []))
+
+	return pids
+
+
+def read_proc_value(pid, name, field):
+	try:
+		with open('/proc/{}/{}'.format(pid, name)) as proc_file:
+			contents = proc_file.read()
+	except OSError:
+		return 0
+
+	if 'stat' == name:
+		return sum(int(value) for value in contents.rsplit(')', 1)[1].split()[11:13])
+
+	for line in contents.splitlines():
+		if line.startswith(field + ':'):
+			return int(line.split()[1])
+
+	return 0
+
+
+def tree_rss_kib(root_pid):
+	return sum(read_proc_value(pid, 'status', 'VmRSS') for pid in process_tree(root_pid))
+
+
+def theme_size_kib(theme_dir):
+	size = 0
+
+	for root, dirs, files in os.walk(theme_dir):
+		size += sum(os.path.getsize(os.path.join(root, name)) for name in files)
+
+	return size / 1024
+
+
+def check_theme(theme_dir):
+	"""
+	Catches precompiled themes that lost their scripts, they would never show a prompt.
+	"""
+	if not os.path.exists(os.path.join(theme_dir, 'bundle.js')):
+		return
+
+	with open(os.path.join(theme_dir, 'index.html'), encoding='utf-8') as index:
+		if not re.search(r'<script\b[^>]*\bsrc=["\']bundle\.js["\']', index.read(), re.I):
+			raise BenchmarkError('index.html does not load bundle.js')
+
+
+def first_paint_ms(path):
+	"""
+	Scrapes the greeter's metrics socket for the first_paint startup phase, which the
+	greeter measures from its own start.
+	"""
+	text = b''
+
+	with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as client:
+		client.connect(path)
+
+		for chunk in iter(lambda: client.recv(65536), b''):
+			text += chunk
+
+	match = FIRST_PAINT_RE.search(text.decode('utf-8'))
+
+	if match is None:
+		raise BenchmarkError('the greeter did not report its first paint')
+
+	return float(match.group(1)) * 1000
+
+
+def wait_until_idle(root_pid, timeout, window=0.25, budget_ticks=1):
+	"""
+	Returns once the greeter and its web process used at most `budget_ticks` clock ticks
+	of CPU time over `window` seconds.
+	"""
+	deadline = time.monotonic() + timeout
+	previous = None
+
+	while time.monotonic() < deadline:
+		ticks = sum(read_proc_value(pid, 'stat', None) for pid in process_tree(root_pid))
+
+		if previous is not None and ticks - previous <= budget_ticks:
+			return now_ms() - window * 1000
+
+		previous = ticks
+		time.sleep(window)
+
+	raise BenchmarkError('greeter never became idle')
+
+
+class Xdotool:
+	def __init__(self, xdotool, display):
+		self.xdotool = xdotool
+		self.env = dict(os.environ, DISPLAY=display)
+
+	def _run(self, *args):
+		subprocess.run([self.xdotool] + list(args), env=self.env, check=True)
+
+	def key(self, *keys):
+		self._run('key', '--delay', '20', *keys)
+
+	def type(self, text):
+		self._run('type', '--delay', '20', text)
+
+
+def start_xvfb(xvfb):
+	read_fd, write_fd = os.pipe()
+	server = subprocess.Popen(
+		[xvfb, '-displayfd', str(write_fd), '-screen', '0', '1920x1080x24', '-nolisten', 'tcp'],
+		pass_fds=(write_fd,),
+		stdout=subprocess.DEVNULL,
+		stderr=subprocess.DEVNULL
+	)
+
+	os.close(write_fd)
+
+	with os.fdopen(read_fd) as display_pipe:
+		display = display_pipe.readline().strip()
+
+	if not display:
+		server.kill()
+		raise BenchmarkError('Xvfb did not start')
+
+	return server, ':' + display
+
+
+# --------------------------------------------------------------- scripts
+
+def log_in_simple(daemon, keyboard, args, result, started):
+	"""
+	The simple theme asks for the username itself as soon as it has loaded.
+	"""
+	payload = daemon.wait_for(GREETER_MESSAGE_AUTHENTICATE, args.timeout)[1]
+	sequence = read_int(payload, 0)[0]
+
+	time.sleep(args.pam_delay / 1000)
+	daemon.prompt(sequence, '', PAM_PROMPT_ECHO_ON, 'login:')
+	result['prompt'] = now_ms() - started
+
+	keyboard.key('Tab')
+	keyboard.type(args.username)
+	keyboard.key('Return')
+
+	username = read_secrets(daemon.wait_for(GREETER_MESSAGE_CONTINUE_AUTHENTICATION, args.timeout)[1])[0]
+
+	if username != args.username:
+		raise BenchmarkError('greeter responded with {!r} instead of the username'.format(username))
+
+	return sequence, username
+
+
+def log_in_antergos(daemon, keyboard, args, result, started):
+	"""
+	Enter shows the user list and numbers its entries with tabindex, so the first Tab
+	focuses the first user and Enter selects it.
+	"""
+	keyboard.key('Return')
+	time.sleep(1)
+	keyboard.key('Tab', 'Return')
+
+	payload = daemon.wait_for(GREETER_MESSAGE_AUTHENTICATE, args.timeout)[1]
+	sequence, offset = read_int(payload, 0)
+	username = read_string(payload, offset)[0]
+
+	if username != args.username:
+		raise BenchmarkError('theme selected {!r} instead of the first user'.format(username))
+
+	result['prompt'] = now_ms() - started
+
+	return sequence, username
+
+
+THEME_SCRIPTS = {
+	'simple': log_in_simple,
+	'antergos': log_in_antergos,
+}
+
+
+def run_iteration(theme, fixture, display, args):
+	result = {}
+	daemon = MockDaemon(fixture.shared_dir)
+	to_server, from_server = daemon.greeter_fds
+	env = dict(
+		os.environ,
+		DISPLAY=display,
+		LIGHTDM_TO_SERVER_FD=str(to_server),
+		LIGHTDM_FROM_SERVER_FD=str(from_server),
+		LD_PRELOAD=args.preload,
+		GREETER_BENCH_ROOT=fixture.root,
+		LIGHTDM_WEBKIT2_GREETER_CONFIG=fixture.config_file,
+		LIGHTDM_WEBKIT2_GREETER_WEBEXT_DIR=args.webext_dir,
+		XDG_CACHE_HOME=fixture.cache_dir,
+		XDG_RUNTIME_DIR=fixture.runtime_dir,
+		# Keep liblightdm away from the real AccountsService
+		DBUS_SYSTEM_BUS_ADDRESS='unix:path=/nonexistent',
+	)
+
+	check_theme(os.path.join(args.theme_dir, theme))
+	fixture.write_config(theme)
+	keyboard = Xdotool(args.xdotool, display)
+
+	started = now_ms()
+	greeter = subprocess.Popen(
+		[args.greeter],
+		env=env,
+		pass_fds=daemon.greeter_fds,
+		stdout=subprocess.DEVNULL if not args.verbose else None,
+		stderr=subprocess.DEVNULL if not args.verbose else None
+	)
+	daemon.start()
+
+	try:
+		received = daemon.wait_for(GREETER_MESSAGE_CONNECT, args.timeout)[0]
+		result['connect'] = received - started
+		daemon.connected({'default-session': 'bench0', 'has-guest-account': 'false'})
+
+		result['idle'] = wait_until_idle(greeter.pid, args.timeout) - started
+		result['paint'] = first_paint_ms(fixture.metrics_socket)
+		result['size'] = theme_size_kib(os.path.join(args.theme_dir, theme))
+
+		sequence, username = THEME_SCRIPTS[theme](daemon, keyboard, args, result, started)
+
+		time.sleep(args.pam_delay / 1000)
+		daemon.prompt(sequence, username, PAM_PROMPT_ECHO_OFF, 'Password: ')
+
+		# Give the theme a moment to show and focus the password field
+		time.sleep(0.5)
+		keyboard.type(args.password)
+		keyboard.key('Return')
+		entered = now_ms()
+
+		daemon.wait_for(GREETER_MESSAGE_CONTINUE_AUTHENTICATION, args.timeout)
+		result['respond'] = now_ms() - entered
+
+		time.sleep(args.pam_delay / 1000)
+		daemon.end_authentication(sequence, username, PAM_SUCCESS)
+
+		received = daemon.wait_for(GREETER_MESSAGE_START_SESSION, args.timeout)[0]
+		result['login'] = received - entered
+		result['rss'] = tree_rss_kib(greeter.pid)
+
+		daemon.send(SERVER_MESSAGE_SESSION_RESULT, struct.pack('>I', 0))
+
+		# The daemon stops the greeter once the session has started
+		terminated = now_ms()
+		greeter.send_signal(signal.SIGTERM)
+		greeter.wait(timeout=args.timeout)
+		result['exit'] = now_ms() - terminated
+
+	finally:
+		if greeter.poll() is None:
+			greeter.kill()
+			greeter.wait()
+
+		daemon.close()
+
+	return result
+
+
+def summarize(theme, results):
+	summary = {'theme': theme, 'iterations': len(results)}
+
+	for metric in METRICS:
+		values = [result[metric] for result in results]
+		summary[metric] = {
+			'median': statistics.median(values),
+			'min': min(values),
+			'max': max(values),
+		}
+
+	return summary
+
+
+def print_table(summaries):
+	print('{:<10} {:>10} {:>10} {:>10} {:>10} {:>10} {:>10} {:>10} {:>10} {:>10}'.format(
+		'theme', 'connect', 'paint', 'idle', 'prompt', 'respond', 'login', 'exit', 'rss', 'size'
+	))
+
+	for summary in summaries:
+		print('{:<10} {:>8.0f}ms {:>8.0f}ms {:>8.0f}ms {:>8.0f}ms {:>8.1f}ms {:>8.0f}ms {:>8.1f}ms {:>7.0f}KiB {:>7.0f}KiB'.format(
+			summary['theme'], *[summary[metric]['median'] for metric in METRICS]
+		))
+
+
+def parse_args():
+	parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+
+	parser.add_argument('--greeter', required=True, help='lightdm-webkit2-greeter executable')
+	parser.add_argument('--webext-dir', required=True, help='directory containing the web extension')
+	parser.add_argument('--preload', required=True, help='path to fake-system.so')
+	parser.add_argument('--theme-dir', required=True, help="the greeter's THEME_DIR")
+	parser.add_argument('--xvfb', default='Xvfb')
+	parser.add_argument('--xdotool', default='xdotool')
+	parser.add_argument('--theme', action='append', choices=sorted(THEME_SCRIPTS), help='may be repeated (default: all)')
+	parser.add_argument('--iterations', type=int, default=3)
+	parser.add_argument('--users', type=int, default=50)
+	parser.add_argument('--sessions', type=int, default=10)
+	parser.add_argument('--layouts', type=int, default=100)
+	parser.add_argument('--password', default='hunter2')
+	parser.add_argument('--pam-delay', type=int, default=0, help='milliseconds PAM takes for each step')
+	parser.add_argument('--timeout', type=float, default=60, help='seconds')
+	parser.add_argument('--json', action='store_true', help='print one JSON object per theme')
+	parser.add_argument('--verbose', action='store_true', help="show the greeter's output")
+
+	args = parser.parse_args()
+	args.preload = os.path.abspath(args.preload)
+	args.webext_dir = os.path.abspath(args.webext_dir)
+
+	if args.users < 1:
+		parser.error('--users must be at least 1')
+
+	return args
+
+
+def main():
+	args = parse_args()
+	args.username = 'bench0'
+	themes = args.theme or sorted(THEME_SCRIPTS)
+	summaries = []
+	failed = False
+
+	xvfb, display = start_xvfb(args.xvfb)
+
+	try:
+		with tempfile.TemporaryDirectory(prefix='greeter-e2e-') as root:
+			fixture = Fixture(root, args)
+
+			for theme in themes:
+				results = []
+
+				for iteration in range(args.iterations):
+					try:
+						results.append(run_iteration(theme, fixture, display, args))
+					except (BenchmarkError, subprocess.SubprocessError) as err:
+						print('{} (iteration {}): {}'.format(theme, iteration + 1, err), file=sys.stderr)
+						failed = True
+
+				if results:
+					summaries.append(summarize(theme, results))
+
+	finally:
+		xvfb.terminate()
+		xvfb.wait()
+
+	if args.json:
+		for summary in summaries:
+			print(json.dumps(summary))
+	else:
+		print_table(summaries)
+
+	return 1 if failed else 0
+
+
+if '__main__' == __name__:
+	sys.exit(main())
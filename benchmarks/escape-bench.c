@@ -0,0 +1,170 @@
+/*
+ * escape-bench.c
+ *
+ * Copyright © 2017 Antergos Developers <dev@antergos.com>
+ *
+ * This file is part of lightdm-webkit2-greeter.
+ *
+ * lightdm-webkit2-greeter is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * lightdm-webkit2-greeter is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * The following additional terms are in effect as per Section 7 of the license:
+ *
+ * The preservation of all legal notices and author attributions in
+ * the material or in the Appropriate Legal Notices displayed
+ * by works containing it is required.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with lightdm-webkit2-greeter; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Compares the single-pass escaper against the split/join code it replaced.
+ *
+ * Usage: escape-bench [ITERATIONS]
+ */
+
+#include <stdlib.h>
+#include <glib.h>
+
+#include "text-escape.h"
+
+
+typedef struct {
+	const gchar *name;
+	const gchar *text;
+} Corpus;
+
+
+static const Corpus corpora[] = {
+	{"username",     "dustin"},
+	{"real-name",    "Dustin Falgout"},
+	{"pam-prompt",   "Password: "},
+	{"pam-message",  "Your password will expire in 3 days. Contact your \"IT\" department <it@example.com>.\n"},
+	{"utf8-prompt",  "Contraseña para el usuario «dustin»: "},
+	{"long-plain",   "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor "
+	                 "incididunt ut labore et dolore magna aliqua. Ut enim ad minim veniam, quis nostrud "
+	                 "exercitation ullamco laboris nisi ut aliquip ex ea commodo consequat."},
+	{"long-markup",  "<b>Notice</b> & \"terms\":\nLorem ipsum dolor sit amet, consectetur adipiscing "
+	                 "elit, sed do eiusmod <tempor> incididunt ut 'labore' et dolore magna aliqua.\n"},
+	{NULL,           NULL}
+};
+
+
+/* ---->>> Previous implementation (webkit2-extension.c) <<<---- */
+
+static gchar *
+g_strreplace(gchar *txt, gchar *from, gchar *to) {
+	gchar **split;
+	gchar *result;
+
+	split = g_strsplit(txt, from, -1);
+	g_free(txt);
+	result = g_strjoinv(to, split);
+	g_strfreev(split);
+	return result;
+}
+
+
+static gchar *
+legacy_txt2html(const gchar *text) {
+	gchar *txt = g_strdup(text);
+
+	txt = g_strreplace(txt, "&", "&amp;");
+	txt = g_strreplace(txt, "\"", "&quot;");
+	txt = g_strreplace(txt, "<", "&lt;");
+	txt = g_strreplace(txt, ">", "&gt;");
+	txt = g_strreplace(txt, "\n", "<br>");
+
+	return txt;
+}
+
+
+static gchar *
+legacy_escape(const gchar *text) {
+	gchar *escaped = g_strescape(text, NULL);
+
+	return g_strreplace(escaped, "'", "\\'");
+}
+
+/* ---->>> Previous implementation (webkit2-extension.c) <<<---- */
+
+
+static gchar *
+new_txt2html(const gchar *text) {
+	return text_escape(text, TEXT_ESCAPE_HTML);
+}
+
+
+static gchar *
+new_escape(const gchar *text) {
+	return text_escape(text, TEXT_ESCAPE_JS_STRING);
+}
+
+
+static gdouble
+time_ns_per_call(gchar *(*func)(const gchar *), const gchar *text, guint iterations) {
+	gint64 start;
+	guint i;
+
+	start = g_get_monotonic_time();
+
+	for (i = 0; i < iterations; i++) {
+		g_free(func(text));
+	}
+
+	return (gdouble) (g_get_monotonic_time() - start) * 1000.0 / iterations;
+}
+
+
+static void
+run(const gchar *label,
+	gchar *(*legacy)(const gchar *),
+	gchar *(*current)(const gchar *),
+	guint iterations) {
+
+	const Corpus *corpus;
+	gdouble before, after;
+
+	g_print("\n%s\n", label);
+	g_print("  %-14s %12s %12s %9s\n", "corpus", "legacy ns", "single ns", "speedup");
+
+	for (corpus = corpora; NULL != corpus->name; corpus++) {
+		/* Warm up allocator and caches */
+		time_ns_per_call(legacy, corpus->text, iterations / 10 + 1);
+		time_ns_per_call(current, corpus->text, iterations / 10 + 1);
+
+		before = time_ns_per_call(legacy, corpus->text, iterations);
+		after = time_ns_per_call(current, corpus->text, iterations);
+
+		g_print("  %-14s %12.1f %12.1f %8.1fx\n", corpus->name, before, after, before / after);
+	}
+}
+
+
+int
+main(int argc, char **argv) {
+	guint iterations = 200000;
+
+	if (argc > 1) {
+		iterations = (guint) MAX(1, atoi(argv[1]));
+	}
+
+	g_print("escape-bench: %u iterations per corpus", iterations);
+#ifdef __SSE2__
+	g_print(" (SSE2 scan enabled)\n");
+#else
+	g_print(" (scalar scan)\n");
+#endif
+
+	run("txt2html (TEXT_ESCAPE_HTML)", legacy_txt2html, new_txt2html, iterations);
+	run("prompt escape (TEXT_ESCAPE_JS_STRING)", legacy_escape, new_escape, iterations);
+
+	return 0;
+}
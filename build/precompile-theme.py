@@ -0,0 +1,876 @@
+#!/usr/bin/env python3
+#
+# precompile-theme.py
+#
+# Copyright © 2017 Antergos Developers <dev@antergos.com>
+#
+# This file is part of lightdm-webkit2-greeter.
+#
+# lightdm-webkit2-greeter is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# lightdm-webkit2-greeter is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+# GNU General Public License for more details.
+#
+# The following additional terms are in effect as per Section 7 of the license:
+#
+# The preservation of all legal notices and author attributions in
+# the material or in the Appropriate Legal Notices displayed
+# by works containing it is required.
+#
+# You should have received a copy of the GNU General Public License
+# along with lightdm-webkit2-greeter; If not, see <http://www.gnu.org/licenses/>.
+
+"""
+Precompiles a greeter theme into a self-contained directory.
+
+    * The stylesheets and scripts that index.html links are combined into bundle.css and
+      bundle.js. Anything that is not already minified is minified conservatively: comments
+      and indentation go, line breaks stay so automatic semicolon insertion is unaffected.
+    * The CSS rules that match the markup in index.html are inlined into a <style> element
+      so the first frame doesn't wait for bundle.css, which is then loaded without blocking.
+    * Fonts referenced by the CSS are copied next to the theme. When fontTools is installed
+      they are subset to the characters the theme can display (and, for icon fonts, to the
+      icons it uses); otherwise they are copied as they are.
+    * manifest.json lists every file with its size and SHA-256 together with the assets to
+      preload, which are also added to index.html as <link rel="preload"> elements.
+
+Only the Python standard library is required.
+"""
+
+import argparse
+import hashlib
+import html
+import json
+import os
+import re
+import shutil
+import sys
+import tempfile
+
+
+URL_RE = re.compile(r'url\(\s*([\'"]?)([^\'")]+)\1\s*\)')
+STYLESHEET_RE = re.compile(r'[ \t]*<link\b[^>]*\brel=["\']stylesheet["\'][^>]*>[ \t]*\n?', re.I)
+SCRIPT_RE = re.compile(r'[ \t]*<script\b[^>]*\bsrc=["\']([^"\']+)["\'][^>]*>\s*</script>[ \t]*\n?', re.I)
+HREF_RE = re.compile(r'\bhref=["\']([^"\']+)["\']', re.I)
+HTML_COMMENT_RE = re.compile(r'<!--.*?-->', re.S)
+TAG_RE = re.compile(r'<([a-zA-Z][a-zA-Z0-9-]*)')
+CLASS_ATTR_RE = re.compile(r'\bclass=["\']([^"\']*)["\']', re.I)
+ID_ATTR_RE = re.compile(r'\bid=["\']([^"\']*)["\']', re.I)
+
+# The characters before a `/` that make it the start of a regular expression literal
+REGEX_PRECEDERS = set('(,=:[!&|?{};+-*%<>~^')
+REGEX_KEYWORDS = {'return', 'typeof', 'instanceof', 'in', 'of', 'new', 'delete', 'void', 'throw', 'case', 'do', 'else'}
+
+# Icon fonts map their glyphs to the Private Use Area
+PRIVATE_USE_AREA = range(0xE000, 0xF900)
+
+FONT_TYPES = {'.ttf': 'font/ttf', '.otf': 'font/otf', '.woff': 'font/woff', '.woff2': 'font/woff2'}
+
+
+class PrecompileError(Exception):
+	pass
+
+
+def read_text(path, depends):
+	depends.add(path)
+
+	with open(path, encoding='utf-8') as source:
+		return source.read()
+
+
+def is_local_url(url):
+	return not (
+		'' == url or url.startswith(('data:', '#', '/')) or re.match(r'^[a-zA-Z][a-zA-Z0-9+.-]*:', url)
+	)
+
+
+def split_url(url):
+	match = re.match(r'^([^?#]*)(.*)$', url)
+
+	return match.group(1), match.group(2)
+
+
+# ------------------------------------------------------------ JavaScript
+
+def is_word_char(c):
+	return c.isalnum() or c in '_$\\' or ord(c) > 0x7F
+
+
+def needs_space(before, after):
+	"""
+	Whether dropping the whitespace between `before` and `after` would merge two tokens,
+	eg: `return x`, `a + +b` or `1 .toString()`.
+	"""
+	if '' == before:
+		return False
+
+	return (
+		(is_word_char(before) and is_word_char(after))
+		or (before in '+-' and after in '+-')
+		or (before.isdigit() and '.' == after)
+		or ('/' == before and '/' == after)
+	)
+
+
+def minify_js(source):
+	"""
+	Strips comments and redundant whitespace. Line breaks are kept, so this can't change
+	what automatic semicolon insertion does. Strings, template literals and regular
+	expression literals are copied verbatim.
+	"""
+	out = []
+	i = 0
+	length = len(source)
+	# One entry per open template literal: the brace depth its current `${` started at
+	templates = []
+	depth = 0
+	last = ''
+	last_word = ''
+
+	def emit(text):
+		nonlocal last, last_word
+
+		out.append(text)
+		stripped = text.strip()
+
+		if stripped:
+			last = stripped[-1]
+			last_word = stripped if re.match(r'^[\w$]+$', stripped) else ''
+
+	def read_template(start):
+		# Returns the end of the template literal chunk starting at `start` (after ` or })
+		j = start
+
+		while j < length:
+			if '\\' == source[j]:
+				j += 2
+			elif '`' == source[j]:
+				return j + 1, False
+			elif source.startswith('${', j):
+				return j + 2, True
+			else:
+				j += 1
+
+		raise PrecompileError('unterminated template literal')
+
+	while i < length:
+		c = source[i]
+
+		if source.startswith('//', i):
+			end = source.find('\n', i)
+			i = length if -1 == end else end
+
+		elif source.startswith('/*', i):
+			end = source.find('*/', i + 2)
+
+			if -1 == end:
+				raise PrecompileError('unterminated comment')
+
+			# /*! ... */ is the convention for comments that must be kept, ie: licenses
+			if source.startswith('/*!', i):
+				out.append('\n{}\n'.format(source[i:end + 2]))
+
+			# A comment that spans lines might be standing in for a line break
+			if '\n' in source[i:end]:
+				out.append('\n')
+
+			i = end + 2
+
+		elif c in '\'"':
+			j = i + 1
+
+			while j < length and source[j] != c:
+				j += 2 if '\\' == source[j] else 1
+
+			emit(source[i:j + 1])
+			i = j + 1
+
+		elif '`' == c:
+			end, opened = read_template(i + 1)
+			emit(source[i:end])
+			i = end
+
+			if opened:
+				templates.append(depth)
+				depth += 1
+
+		elif '}' == c and templates and templates[-1] == depth - 1:
+			depth -= 1
+			templates.pop()
+			end, opened = read_template(i + 1)
+			emit(source[i:end])
+			i = end
+
+			if opened:
+				templates.append(depth)
+				depth += 1
+
+		elif '/' == c and ('' == last or last in REGEX_PRECEDERS or last_word in REGEX_KEYWORDS):
+			j = i + 1
+			in_class = False
+
+			while j < length and '\n' != source[j]:
+				if '\\' == source[j]:
+					j += 2
+					continue
+
+				if '[' == source[j]:
+					in_class = True
+				elif ']' == source[j]:
+					in_class = False
+				elif '/' == source[j] and not in_class:
+					break
+
+				j += 1
+
+			j += 1
+
+			while j < length and (source[j].isalnum() or '_' == source[j]):
+				j += 1
+
+			emit(source[i:j])
+			i = j
+
+		elif c in ' \t\r\n':
+			j = i
+
+			while j < length and source[j] in ' \t\r\n':
+				j += 1
+
+			if '\n' in source[i:j]:
+				out.append('\n')
+			elif out and j < length and needs_space(out[-1][-1:], source[j]):
+				out.append(' ')
+
+			i = j
+
+		elif c.isalnum() or c in '_$':
+			j = i
+
+			while j < length and (source[j].isalnum() or source[j] in '_$'):
+				j += 1
+
+			emit(source[i:j])
+			i = j
+
+		else:
+			if '{' == c:
+				depth += 1
+			elif '}' == c:
+				depth -= 1
+
+			emit(c)
+			i += 1
+
+	# Drop the whitespace the tokens above no longer need
+	result = []
+
+	for line in ''.join(out).split('\n'):
+		line = line.strip()
+
+		if line:
+			result.append(line)
+
+	return '\n'.join(result) + '\n'
+
+
+# ------------------------------------------------------------------- CSS
+
+def strip_css_comments(source, kept):
+	"""
+	Removes the comments from `source`. /*! ... */ comments are appended to `kept`.
+	"""
+	out = []
+	i = 0
+
+	while i < len(source):
+		if source[i] in '\'"':
+			j = i + 1
+
+			while j < len(source) and source[j] != source[i]:
+				j += 2 if '\\' == source[j] else 1
+
+			out.append(source[i:j + 1])
+			i = j + 1
+
+		elif source.startswith('/*', i):
+			end = source.find('*/', i + 2)
+			end = len(source) if -1 == end else end + 2
+
+			if source.startswith('/*!', i):
+				kept.append(source[i:end])
+
+			i = end
+
+		else:
+			out.append(source[i])
+			i += 1
+
+	return ''.join(out)
+
+
+def minify_css(source, kept):
+	source = strip_css_comments(source, kept)
+	parts = re.split(r'(\'(?:\\.|[^\'\\])*\'|"(?:\\.|[^"\\])*")', source)
+
+	for index in range(0, len(parts), 2):
+		part = re.sub(r'\s+', ' ', parts[index])
+		part = re.sub(r'\s*([{};,>])\s*', r'\1', part)
+		part = re.sub(r':\s+', ':', part)
+		parts[index] = part.replace(';}', '}')
+
+	return ''.join(parts).strip()
+
+
+def parse_css_blocks(source):
+	"""
+	Splits minified CSS into top-level (prelude, body) pairs. `body` is None for statements
+	such as @charset.
+	"""
+	blocks = []
+	i = 0
+	start = 0
+
+	while i < len(source):
+		c = source[i]
+
+		if c in '\'"':
+			j = i + 1
+
+			while j < len(source) and source[j] != c:
+				j += 2 if '\\' == source[j] else 1
+
+			i = j + 1
+			continue
+
+		if ';' == c:
+			blocks.append((source[start:i].strip(), None))
+			start = i + 1
+
+		elif '{' == c:
+			nesting = 1
+			j = i + 1
+
+			while j < len(source) and nesting:
+				if source[j] in '\'"':
+					quote = source[j]
+					j += 1
+
+					while j < len(source) and source[j] != quote:
+						j += 2 if '\\' == source[j] else 1
+
+				elif '{' == source[j]:
+					nesting += 1
+				elif '}' == source[j]:
+					nesting -= 1
+
+				j += 1
+
+			blocks.append((source[start:i].strip(), source[i + 1:j - 1]))
+			start = i = j
+			continue
+
+		i += 1
+
+	return blocks
+
+
+def serialize_css_blocks(blocks):
+	return ''.join(
+		'{};'.format(prelude) if body is None else '{}{{{}}}'.format(prelude, body)
+		for prelude, body in blocks
+	)
+
+
+class Markup:
+	"""
+	The tag names, classes and ids used by a theme. `static` only has what's in index.html,
+	`dynamic` adds anything the theme's scripts could be adding at runtime.
+	"""
+
+	def __init__(self, index_html, scripts):
+		index_html = HTML_COMMENT_RE.sub('', index_html)
+
+		self.tags = {tag.lower() for tag in TAG_RE.findall(index_html)} | {'html', 'body'}
+		self.classes = {name for attr in CLASS_ATTR_RE.findall(index_html) for name in attr.split()}
+		self.ids = set(ID_ATTR_RE.findall(index_html))
+		self.scripts = scripts
+
+	def selector_matches(self, selector):
+		# Pseudo-classes, pseudo-elements and attribute selectors are assumed to match
+		selector = re.sub(r'\[[^\]]*\]', '', selector)
+		selector = re.sub(r'::?[a-zA-Z-]+(\([^)]*\))?', '', selector)
+
+		for compound in re.split(r'[\s>+~]+', selector.strip()):
+			for kind, name in re.findall(r'([.#]?)([a-zA-Z_-][\w-]*)', compound):
+				if '.' == kind and name not in self.classes:
+					return False
+				if '#' == kind and name not in self.ids:
+					return False
+				if '' == kind and name.lower() not in self.tags:
+					return False
+
+		return True
+
+	def class_is_used(self, name):
+		if name in self.classes or re.search(r'(?<![\w-]){}(?![\w-])'.format(re.escape(name)), self.scripts):
+			return True
+
+		# Class names built at runtime, eg: `fa-${icon}` or 'fa-' + icon
+		prefix, _, rest = name.partition('-')
+
+		if rest and re.search(r'{}-(\$\{{|[\'"]\s*\+)'.format(re.escape(prefix)), self.scripts):
+			return re.search(r'[\'"`]{}[\'"`]'.format(re.escape(rest)), self.scripts) is not None
+
+		return False
+
+
+def critical_css(blocks, markup):
+	"""
+	Returns the rules that can apply to the markup in index.html. Other at-rules (@font-face,
+	@keyframes, ...) are kept, @media blocks are filtered recursively.
+	"""
+	result = []
+
+	for prelude, body in blocks:
+		if body is None:
+			continue
+
+		if prelude.startswith('@media'):
+			inner = critical_css(parse_css_blocks(body), markup)
+
+			if inner:
+				result.append((prelude, serialize_css_blocks(inner)))
+
+		elif prelude.startswith('@'):
+			result.append((prelude, body))
+
+		elif any(markup.selector_matches(selector) for selector in prelude.split(',')):
+			result.append((prelude, body))
+
+	return result
+
+
+def icon_codepoints(blocks, markup):
+	"""
+	Returns the Private Use Area codepoints of the `content` of rules for classes the theme
+	uses, ie: the icons it can display.
+	"""
+	codepoints = set()
+
+	for prelude, body in blocks:
+		if body is None:
+			continue
+
+		if prelude.startswith('@media'):
+			codepoints |= icon_codepoints(parse_css_blocks(body), markup)
+			continue
+
+		for escape in re.findall(r'content:\s*["\']\\([0-9a-fA-F]{1,6})', body):
+			codepoint = int(escape, 16)
+
+			if codepoint not in PRIVATE_USE_AREA:
+				continue
+
+			for selector in prelude.split(','):
+				classes = re.findall(r'\.([a-zA-Z_-][\w-]*)', selector)
+
+				if classes and all(markup.class_is_used(name) for name in classes):
+					codepoints.add(codepoint)
+					break
+
+	return codepoints
+
+
+# ------------------------------------------------------------- the theme
+
+class Theme:
+	def __init__(self, args):
+		self.source_dir = os.path.abspath(args.theme_dir)
+		self.themes_dir = os.path.dirname(self.source_dir)
+		self.name = os.path.basename(self.source_dir)
+		self.output = args.output
+		self.exclude = set(args.exclude or [])
+		self.depends = set()
+
+		# Source path -> path relative to the output directory
+		self.assets = {}
+		self.bundled = set()
+
+	def output_path(self, source_path):
+		"""
+		Where `source_path` ends up relative to the output directory. Files from outside the
+		theme (ie: _vendor) keep their path relative to the themes directory.
+		"""
+		source_path = os.path.normpath(source_path)
+
+		if source_path.startswith(self.source_dir + os.sep):
+			relative = os.path.relpath(source_path, self.source_dir)
+		elif source_path.startswith(self.themes_dir + os.sep):
+			relative = os.path.relpath(source_path, self.themes_dir)
+		else:
+			raise PrecompileError('{} is outside of the themes directory'.format(source_path))
+
+		return relative.replace(os.sep, '/')
+
+	def rebase_urls(self, css, css_path):
+		def rebase(match):
+			url = match.group(2).strip()
+
+			if not is_local_url(url):
+				return match.group(0)
+
+			path, suffix = split_url(url)
+			source_path = os.path.normpath(os.path.join(os.path.dirname(css_path), path))
+
+			if not os.path.isfile(source_path):
+				print('{}: {} not found, leaving it as it is'.format(css_path, url), file=sys.stderr)
+				return match.group(0)
+
+			self.assets[source_path] = self.output_path(source_path)
+
+			return "url('{}{}')".format(self.assets[source_path], suffix)
+
+		return URL_RE.sub(rebase, css)
+
+	def collect(self, index_html):
+		stylesheets = []
+		scripts = []
+		markup = HTML_COMMENT_RE.sub('', index_html)
+
+		for link in STYLESHEET_RE.finditer(markup):
+			href = HREF_RE.search(link.group(0))
+
+			if href and is_local_url(href.group(1)):
+				stylesheets.append(os.path.normpath(os.path.join(self.source_dir, split_url(href.group(1))[0])))
+
+		for script in SCRIPT_RE.finditer(markup):
+			if is_local_url(script.group(1)):
+				scripts.append(os.path.normpath(os.path.join(self.source_dir, split_url(script.group(1))[0])))
+
+		return stylesheets, scripts
+
+	def build_js(self, scripts):
+		chunks = []
+
+		for path in scripts:
+			source = read_text(path, self.depends)
+
+			if not path.endswith('.min.js'):
+				source = minify_js(source)
+
+			# Keep every file's last statement to itself
+			chunks.append(source.rstrip().rstrip(';') + ';\n')
+			self.bundled.add(path)
+
+		return ''.join(chunks)
+
+	def build_css(self, stylesheets):
+		chunks = []
+		licenses = []
+
+		for path in stylesheets:
+			chunks.append(self.rebase_urls(minify_css(read_text(path, self.depends), licenses), path))
+			self.bundled.add(path)
+
+		return ''.join(chunks), ''.join(comment + '\n' for comment in licenses)
+
+	def used_characters(self, texts, blocks, markup):
+		characters = {chr(codepoint) for codepoint in range(0x20, 0x7F)} | {'\u00a0', '\u2026'}
+
+		for text in texts:
+			characters.update(html.unescape(text))
+
+		for codepoint in icon_codepoints(blocks, markup):
+			characters.add(chr(codepoint))
+
+		return {c for c in characters if c.isprintable()}
+
+	def copy_fonts(self, output_dir, characters):
+		try:
+			from fontTools import subset
+		except ImportError:
+			subset = None
+
+		text = ''.join(sorted(characters))
+
+		for source_path, relative in self.assets.items():
+			destination = os.path.join(output_dir, relative)
+			extension = os.path.splitext(source_path)[1].lower()
+			os.makedirs(os.path.dirname(destination), exist_ok=True)
+			self.depends.add(source_path)
+
+			if subset is None or extension not in FONT_TYPES:
+				shutil.copyfile(source_path, destination)
+				continue
+
+			options = subset.Options()
+			options.flavor = extension[1:] if extension in ('.woff', '.woff2') else None
+			options.layout_features = ['*']
+			options.name_IDs = ['*']
+			options.notdef_outline = True
+
+			font = subset.load_font(source_path, options)
+			subsetter = subset.Subsetter(options)
+			subsetter.populate(text=text)
+			subsetter.subset(font)
+			subset.save_font(font, destination, options)
+
+		return subset is not None
+
+	def copy_theme_files(self, output_dir):
+		for root, dirs, files in os.walk(self.source_dir):
+			relative_root = os.path.relpath(root, self.source_dir)
+			dirs[:] = sorted(
+				name for name in dirs
+				if not name.startswith('.') and os.path.normpath(os.path.join(relative_root, name)) not in self.exclude
+			)
+
+			for name in sorted(files):
+				source_path = os.path.join(root, name)
+				relative = os.path.normpath(os.path.join(relative_root, name))
+
+				if name.startswith('.') or 'index.html' == relative or relative in self.exclude:
+					continue
+
+				if source_path in self.bundled or source_path in self.assets:
+					continue
+
+				os.makedirs(os.path.join(output_dir, relative_root), exist_ok=True)
+				shutil.copyfile(source_path, os.path.join(output_dir, relative))
+				self.depends.add(source_path)
+
+	def preload_list(self, critical_blocks, has_css):
+		preload = []
+
+		if has_css:
+			preload.append({'href': 'bundle.css', 'as': 'style'})
+
+		# Fonts and images the first frame needs
+		for prelude, body in critical_blocks:
+			for match in URL_RE.finditer(body or ''):
+				href = split_url(match.group(2))[0]
+
+				if not is_local_url(match.group(2)) or any(href == item['href'] for item in preload):
+					continue
+
+				if prelude.startswith('@font-face'):
+					extension = os.path.splitext(href)[1].lower()
+					preload.append({'href': href, 'as': 'font', 'type': FONT_TYPES.get(extension, '')})
+
+					# Only the first source the engine supports gets loaded
+					break
+
+				if not prelude.startswith('@'):
+					preload.append({'href': href, 'as': 'image'})
+
+		return preload
+
+	def rewrite_index(self, index_html, critical, preload, has_css, has_js):
+		links = []
+
+		for item in preload:
+			if 'style' == item['as']:
+				continue
+
+			attributes = ['rel="preload"', 'href="{}"'.format(item['href']), 'as="{}"'.format(item['as'])]
+
+			if 'font' == item['as']:
+				attributes += ['type="{}"'.format(item['type']), 'crossorigin']
+
+			links.append('\t<link {}>\n'.format(' '.join(attributes)))
+
+		if has_css:
+			links.append('\t<style>{}</style>\n'.format(critical))
+			links.append(
+				'\t<link rel="stylesheet" href="bundle.css" media="print" onload="this.media=\'all\'">\n'
+				'\t<noscript><link rel="stylesheet" href="bundle.css"></noscript>\n'
+			)
+
+		if has_js:
+			links.append('\t<script src="bundle.js"></script>\n')
+
+		# The bundle goes where the first local tag was. It is only inserted once every
+		# original tag is gone, otherwise the second pass would remove our own <script>.
+		placeholder = '\0bundle\0'
+		inserted = False
+
+		def replace(match):
+			nonlocal inserted
+
+			if inserted:
+				return ''
+
+			inserted = True
+
+			return placeholder
+
+		def replace_local(match):
+			href = HREF_RE.search(match.group(0)) if match.re is STYLESHEET_RE else match
+
+			if href is None or not is_local_url(href.group(1)):
+				return match.group(0)
+
+			return replace(match)
+
+		# Comments may contain markup we must not touch, eg: the commented out mock.js
+		parts = re.split(r'(<!--.*?-->)', index_html, flags=re.S)
+
+		for index in range(0, len(parts), 2):
+			parts[index] = STYLESHEET_RE.sub(replace_local, parts[index])
+			parts[index] = SCRIPT_RE.sub(replace_local, parts[index])
+
+		index_html = ''.join(parts).replace(placeholder, ''.join(links))
+
+		if not inserted and links:
+			index_html = re.sub(r'(?i)</head>', lambda match: ''.join(links) + match.group(0), index_html, count=1)
+
+		if has_js and 'bundle.js' not in [script.group(1) for script in SCRIPT_RE.finditer(index_html)]:
+			raise PrecompileError('index.html does not load bundle.js')
+
+		return index_html
+
+	def write_manifest(self, output_dir, preload, fonts_subset):
+		files = {}
+		source_size = 0
+
+		for root, dirs, names in os.walk(output_dir):
+			dirs.sort()
+
+			for name in sorted(names):
+				path = os.path.join(root, name)
+
+				with open(path, 'rb') as data:
+					content = data.read()
+
+				files[os.path.relpath(path, output_dir).replace(os.sep, '/')] = {
+					'size': len(content),
+					'sha256': hashlib.sha256(content).hexdigest(),
+				}
+
+		for path in self.depends:
+			source_size += os.path.getsize(path)
+
+		manifest = {
+			'theme': self.name,
+			'files': files,
+			'preload': preload,
+			'total_size': sum(entry['size'] for entry in files.values()),
+			'source_size': source_size,
+			'fonts_subset': fonts_subset,
+		}
+
+		with open(os.path.join(output_dir, 'manifest.json'), 'w') as output:
+			json.dump(manifest, output, indent='\t', sort_keys=True)
+			output.write('\n')
+
+		return manifest
+
+	def build(self):
+		index_path = os.path.join(self.source_dir, 'index.html')
+		index_html = read_text(index_path, self.depends)
+		stylesheets, scripts = self.collect(index_html)
+
+		js = self.build_js(scripts)
+		css, licenses = self.build_css(stylesheets)
+		blocks = parse_css_blocks(css)
+
+		# Everything the theme could put on screen: markup, scripts and translations
+		texts = [HTML_COMMENT_RE.sub('', index_html), js]
+
+		for root, dirs, files in os.walk(self.source_dir):
+			for name in files:
+				if name.endswith(('.js', '.json')) and os.path.join(root, name) not in self.bundled:
+					texts.append(read_text(os.path.join(root, name), self.depends))
+
+		markup = Markup(index_html, '\n'.join(texts[1:]))
+		critical_blocks = critical_css(blocks, markup)
+		preload = self.preload_list(critical_blocks, bool(css))
+
+		# Build next to the output and swap it in, so a failed build leaves nothing behind
+		parent = os.path.dirname(os.path.abspath(self.output))
+		os.makedirs(parent, exist_ok=True)
+		staging = tempfile.mkdtemp(prefix='.{}-'.format(self.name), dir=parent)
+
+		try:
+			fonts_subset = self.copy_fonts(staging, self.used_characters(texts, blocks, markup))
+			self.copy_theme_files(staging)
+
+			if css:
+				with open(os.path.join(staging, 'bundle.css'), 'w', encoding='utf-8') as output:
+					output.write(licenses + css + '\n')
+
+			if js:
+				with open(os.path.join(staging, 'bundle.js'), 'w', encoding='utf-8') as output:
+					output.write(js)
+
+			with open(os.path.join(staging, 'index.html'), 'w', encoding='utf-8') as output:
+				output.write(self.rewrite_index(
+					index_html, serialize_css_blocks(critical_blocks), preload, bool(css), bool(js)
+				))
+
+			manifest = self.write_manifest(staging, preload, fonts_subset)
+
+			if os.path.isdir(self.output):
+				shutil.rmtree(self.output)
+
+			os.rename(staging, self.output)
+
+		except BaseException:
+			shutil.rmtree(staging, ignore_errors=True)
+			raise
+
+		# Ninja compares the directory's mtime against its inputs
+		os.utime(self.output)
+
+		return manifest
+
+	def write_depfile(self, depfile):
+		def escape(path):
+			return path.replace('\\', '\\\\').replace(' ', '\\ ').replace('$', '$$').replace('#', '\\#')
+
+		with open(depfile, 'w') as output:
+			output.write('{}: {}\n'.format(
+				escape(self.output), ' \\\n  '.join(escape(path) for path in sorted(self.depends))
+			))
+
+
+def parse_args():
+	parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+
+	parser.add_argument('theme_dir', help='the theme to precompile')
+	parser.add_argument('output', help='directory to write the precompiled theme to')
+	parser.add_argument('--exclude', action='append', help='file or directory (relative to the theme) to leave out')
+	parser.add_argument('--depfile', help='write a Makefile style list of the files that were read')
+
+	return parser.parse_args()
+
+
+def main():
+	args = parse_args()
+	theme = Theme(args)
+
+	try:
+		manifest = theme.build()
+	except (OSError, PrecompileError) as err:
+		print('precompile-theme: {}: {}'.format(theme.name, err), file=sys.stderr)
+		return 1
+
+	if args.depfile:
+		theme.write_depfile(args.depfile)
+
+	print('{}: {} files, {} bytes ({} bytes of sources){}'.format(
+		theme.name, len(manifest['files']), manifest['total_size'], manifest['source_size'],
+		'' if manifest['fonts_subset'] else ', fonts not subset (fontTools is not installed)'
+	))
+
+	return 0
+
+
+if '__main__' == __name__:
+	sys.exit(main())
@@ -12,11 +12,14 @@ clean_build_dir() {
 
 combine_javascript_sources() {
 	cd "${MESON_SOURCE_ROOT}/src/gresource/js" && {
-		cat _vendor/moment-with-locales.min.js \
+		cat GreeterReady.js \
 			LightDMObjects.js \
+			Gettext.js \
 			Greeter.js \
 			GreeterConfig.js \
-			ThemeUtils.js > "${MESON_SOURCE_ROOT}/src/gresource/js/bundle.js"
+			ThemeUtils.js \
+			ThemeHeartbeat.js \
+			ThemeErrorReporter.js > "${MESON_SOURCE_ROOT}/src/gresource/js/bundle.js"
 	}
 }
 
@@ -0,0 +1,293 @@
+/*
+ * avatar-cache.c
+ *
+ * Copyright © 2017 Antergos Developers <dev@antergos.com>
+ *
+ * This file is part of lightdm-webkit2-greeter.
+ *
+ * lightdm-webkit2-greeter is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * lightdm-webkit2-greeter is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * The following additional terms are in effect as per Section 7 of the license:
+ *
+ * The preservation of all legal notices and author attributions in
+ * the material or in the Appropriate Legal Notices displayed
+ * by works containing it is required.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with lightdm-webkit2-greeter; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Thumbnails are named after the MD5 of the image's path and the requested size, and carry
+ * the image's mtime so that a new .face invalidates them without a separate index. Until a
+ * thumbnail exists lookups return the original image and the theme is told once it's ready.
+ */
+
+#include <string.h>
+#include <unistd.h>
+#include <utime.h>
+#include <sys/stat.h>
+#include <glib/gstdio.h>
+#include <gdk-pixbuf/gdk-pixbuf.h>
+
+#include "avatar-cache.h"
+
+
+/* Decoding is memory bound, more threads would only compete with the web process */
+#define AVATAR_CACHE_THREADS 2
+
+
+typedef enum {
+	AVATAR_PENDING,
+	AVATAR_THUMBNAIL,
+	AVATAR_ORIGINAL, /* Small enough already, or gdk-pixbuf can't read it */
+} AvatarState;
+
+
+typedef struct {
+	AvatarState  state;
+	gint64       mtime;
+	gchar       *thumbnail;
+} AvatarEntry;
+
+
+typedef struct {
+	gchar  *key;
+	gchar  *image;
+	gchar  *path;
+	gint    size;
+	gint64  mtime;
+	gboolean created;
+} AvatarJob;
+
+
+static gchar *cache_directory = NULL;
+static GThreadPool *pool = NULL;
+static GHashTable *entries = NULL;
+static AvatarCacheReadyFunc ready_func = NULL;
+static gpointer ready_data = NULL;
+
+
+static void
+avatar_entry_free(AvatarEntry *entry) {
+	g_free(entry->thumbnail);
+	g_free(entry);
+}
+
+
+static void
+avatar_job_free(AvatarJob *job) {
+	g_free(job->key);
+	g_free(job->image);
+	g_free(job->path);
+	g_free(job);
+}
+
+
+static gchar *
+get_thumbnail_path(const gchar *image, gint size) {
+	gchar *checksum, *name, *path;
+
+	checksum = g_compute_checksum_for_string(G_CHECKSUM_MD5, image, -1);
+	name = g_strdup_printf("%s-%d.png", checksum, size);
+	path = g_build_filename(cache_directory, name, NULL);
+
+	g_free(name);
+	g_free(checksum);
+
+	return path;
+}
+
+
+/*
+ * Records the outcome of a job on the main thread. Jobs for an image that has changed
+ * since they were queued are dropped, the lookup that noticed it queued a new one.
+ */
+static gboolean
+avatar_job_done(gpointer data) {
+	AvatarJob *job = data;
+	AvatarEntry *entry = g_hash_table_lookup(entries, job->key);
+
+	if (NULL != entry && AVATAR_PENDING == entry->state && entry->mtime == job->mtime) {
+		if (job->created) {
+			entry->state = AVATAR_THUMBNAIL;
+			entry->thumbnail = g_strdup(job->path);
+
+			if (NULL != ready_func) {
+				ready_func(job->image, job->size, entry->thumbnail, ready_data);
+			}
+
+		} else {
+			entry->state = AVATAR_ORIGINAL;
+		}
+	}
+
+	avatar_job_free(job);
+
+	return G_SOURCE_REMOVE;
+}
+
+
+/*
+ * Scales the image so that its shorter side is `size` pixels, which is what themes
+ * get with `object-fit: cover` on a square <img>, and writes it to the cache.
+ *
+ * Runs on the thread pool.
+ */
+static void
+avatar_job_run(gpointer data, gpointer user_data) {
+	AvatarJob *job = data;
+	GdkPixbuf *pixbuf = NULL, *oriented = NULL;
+	struct utimbuf times;
+	gchar *temp_path = NULL;
+	gint width, height, shorter, fd;
+	gdouble scale;
+
+	if (NULL == gdk_pixbuf_get_file_info(job->image, &width, &height)) {
+		goto done;
+	}
+
+	shorter = MIN(width, height);
+
+	if (shorter <= job->size) {
+		goto done;
+	}
+
+	scale = (gdouble) job->size / shorter;
+	pixbuf = gdk_pixbuf_new_from_file_at_scale(
+		job->image,
+		MAX(1, (gint) (width * scale + 0.5)),
+		MAX(1, (gint) (height * scale + 0.5)),
+		TRUE,
+		NULL
+	);
+
+	if (NULL == pixbuf) {
+		goto done;
+	}
+
+	/* Camera photos usually rely on EXIF orientation, which <img> would have honoured */
+	oriented = gdk_pixbuf_apply_embedded_orientation(pixbuf);
+
+	temp_path = g_strdup_printf("%s.XXXXXX", job->path);
+	fd = g_mkstemp(temp_path);
+
+	if (-1 == fd) {
+		goto done;
+	}
+
+	close(fd);
+
+	times.actime = (time_t) job->mtime;
+	times.modtime = (time_t) job->mtime;
+
+	if (gdk_pixbuf_save(oriented, temp_path, "png", NULL, NULL)
+			&& 0 == g_utime(temp_path, &times)
+			&& 0 == g_rename(temp_path, job->path)) {
+		job->created = TRUE;
+	} else {
+		g_unlink(temp_path);
+	}
+
+done:
+	g_clear_object(&oriented);
+	g_clear_object(&pixbuf);
+	g_free(temp_path);
+
+	g_main_context_invoke(NULL, avatar_job_done, job);
+}
+
+
+/*
+ * Creates the cache directory and the thread pool. Until this is called (or if it
+ * fails) avatar_cache_lookup() hands out original images.
+ */
+void
+avatar_cache_init(const gchar *directory, AvatarCacheReadyFunc ready, gpointer user_data) {
+	GError *err = NULL;
+
+	if (NULL != pool || 0 != g_mkdir_with_parents(directory, 0700)) {
+		return;
+	}
+
+	pool = g_thread_pool_new(avatar_job_run, NULL, AVATAR_CACHE_THREADS, FALSE, &err);
+
+	if (NULL == pool) {
+		g_warning("Unable to start avatar thumbnailer: %s", err->message);
+		g_error_free(err);
+		return;
+	}
+
+	cache_directory = g_strdup(directory);
+	entries = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify) avatar_entry_free);
+	ready_func = ready;
+	ready_data = user_data;
+}
+
+
+/*
+ * Returns the path of the thumbnail of `image` at `size` pixels, or `image` itself when
+ * it is small enough already or its thumbnail is still being made. Never blocks on
+ * decoding: only the image and its cached thumbnail are stat()ed.
+ *
+ * Returns a newly allocated string, or NULL if `image` isn't readable.
+ */
+gchar *
+avatar_cache_lookup(const gchar *image, gint size) {
+	AvatarEntry *entry;
+	AvatarJob *job;
+	GStatBuf image_stat, thumbnail_stat;
+	gchar *key, *path;
+
+	if (NULL == image || 0 != g_access(image, R_OK) || 0 != g_stat(image, &image_stat)) {
+		return NULL;
+	}
+
+	if (NULL == pool) {
+		return g_strdup(image);
+	}
+
+	size = CLAMP(size, AVATAR_CACHE_MIN_SIZE, AVATAR_CACHE_MAX_SIZE);
+	key = g_strdup_printf("%d:%s", size, image);
+	entry = g_hash_table_lookup(entries, key);
+
+	if (NULL != entry && entry->mtime == (gint64) image_stat.st_mtime) {
+		g_free(key);
+
+		return g_strdup((AVATAR_THUMBNAIL == entry->state) ? entry->thumbnail : image);
+	}
+
+	entry = g_new0(AvatarEntry, 1);
+	entry->mtime = (gint64) image_stat.st_mtime;
+	path = get_thumbnail_path(image, size);
+
+	if (0 == g_stat(path, &thumbnail_stat) && thumbnail_stat.st_mtime == image_stat.st_mtime) {
+		/* Made by a previous greeter */
+		entry->state = AVATAR_THUMBNAIL;
+		entry->thumbnail = path;
+		g_hash_table_replace(entries, key, entry);
+
+		return g_strdup(path);
+	}
+
+	entry->state = AVATAR_PENDING;
+	g_hash_table_replace(entries, g_strdup(key), entry);
+
+	job = g_new0(AvatarJob, 1);
+	job->key = key;
+	job->image = g_strdup(image);
+	job->path = path;
+	job->size = size;
+	job->mtime = entry->mtime;
+
+	g_thread_pool_push(pool, job, NULL);
+
+	return g_strdup(image);
+}
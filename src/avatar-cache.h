@@ -0,0 +1,62 @@
+/*
+ * avatar-cache.h
+ *
+ * Copyright © 2017 Antergos Developers <dev@antergos.com>
+ *
+ * This file is part of lightdm-webkit2-greeter.
+ *
+ * lightdm-webkit2-greeter is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * lightdm-webkit2-greeter is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * The following additional terms are in effect as per Section 7 of the license:
+ *
+ * The preservation of all legal notices and author attributions in
+ * the material or in the Appropriate Legal Notices displayed
+ * by works containing it is required.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with lightdm-webkit2-greeter; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Avatar-sized thumbnails of the users' .face images for the web extension. Thumbnails
+ * are scaled on a small thread pool and cached on disk next to the last-user file, so
+ * a user list never has to decode a full size camera photo more than once.
+ */
+
+#ifndef AVATAR_CACHE_H
+#define AVATAR_CACHE_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+#define AVATAR_CACHE_MIN_SIZE 16
+#define AVATAR_CACHE_MAX_SIZE 1024
+
+
+/*
+ * Called on the main thread when the thumbnail of `image` at `size` has replaced the
+ * original that avatar_cache_lookup() handed out.
+ */
+typedef void (*AvatarCacheReadyFunc) (const gchar *image,
+									  gint         size,
+									  const gchar *thumbnail,
+									  gpointer     user_data);
+
+
+void
+avatar_cache_init(const gchar *directory, AvatarCacheReadyFunc ready, gpointer user_data);
+
+gchar *
+avatar_cache_lookup(const gchar *image, gint size);
+
+G_END_DECLS
+
+#endif /* AVATAR_CACHE_H */
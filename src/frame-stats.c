@@ -0,0 +1,249 @@
+/*
+ * frame-stats.c
+ *
+ * Copyright © 2017 Antergos Developers <dev@antergos.com>
+ *
+ * This file is part of lightdm-webkit2-greeter.
+ *
+ * lightdm-webkit2-greeter is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * lightdm-webkit2-greeter is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * The following additional terms are in effect as per Section 7 of the license:
+ *
+ * The preservation of all legal notices and author attributions in
+ * the material or in the Appropriate Legal Notices displayed
+ * by works containing it is required.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with lightdm-webkit2-greeter; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* A frame is counted when the window's frame clock finished painting and the web view drew
+ * in it. Consecutive frames less than a few refreshes apart (see get_animation_gap()) belong
+ * to the same animation and their interval is recorded; a longer gap starts a new one, since
+ * the web view simply had nothing to draw. That keeps typing and the caret blinking out of
+ * the numbers. Longer stalls show up in the theme's event loop lag instead. Frames are
+ * dropped when an interval spans more than one refresh.
+ */
+
+#include "frame-stats.h"
+#include "metrics-text.h"
+#include "sample-window.h"
+
+
+/* Microseconds */
+#define DEFAULT_REFRESH_INTERVAL 16667
+#define ANIMATION_GAP_MIN        100000
+
+/* Frames further apart than this many refreshes (or ANIMATION_GAP_MIN if that is longer, so
+ * long frames still count on fast displays) aren't part of the same animation
+ */
+#define ANIMATION_GAP_REFRESHES 6
+
+
+static struct {
+	gboolean started;
+	gboolean web_view_drawn;
+
+	/* Frame time of the last frame the web view drew in, 0 before the first one */
+	gint64 last_frame;
+	gint64 refresh_interval;
+	gboolean in_animation;
+
+	/* Milliseconds */
+	SampleWindow samples;
+
+	guint64 frames;
+	guint64 animations;
+	guint64 long_frames;
+	guint64 dropped_frames;
+	guint64 intervals;
+	gdouble sum;
+	gdouble max;
+} stats;
+
+
+static void
+add_interval(gint64 interval) {
+	gdouble milliseconds = interval / 1000.0;
+	gint64 refreshes;
+
+	sample_window_add(&stats.samples, milliseconds);
+
+	stats.intervals++;
+	stats.sum += milliseconds;
+	stats.max = MAX(stats.max, milliseconds);
+
+	if (milliseconds > FRAME_STATS_LONG_FRAME) {
+		stats.long_frames++;
+	}
+
+	/* Rounded, frame times jitter by a fraction of a refresh */
+	refreshes = (interval + stats.refresh_interval / 2) / stats.refresh_interval;
+
+	if (refreshes > 1) {
+		stats.dropped_frames += refreshes - 1;
+	}
+}
+
+
+static gint64
+get_animation_gap(void) {
+	return MAX(ANIMATION_GAP_REFRESHES * stats.refresh_interval, ANIMATION_GAP_MIN);
+}
+
+
+static gboolean
+web_view_draw_cb(GtkWidget *widget, cairo_t *cr, gpointer user_data) {
+	stats.web_view_drawn = TRUE;
+
+	return FALSE;
+}
+
+
+static void
+after_paint_cb(GdkFrameClock *frame_clock, gpointer user_data) {
+	gint64 frame_time, refresh_interval = 0;
+
+	if (! stats.web_view_drawn) {
+		return;
+	}
+
+	stats.web_view_drawn = FALSE;
+	stats.frames++;
+
+	frame_time = gdk_frame_clock_get_frame_time(frame_clock);
+	gdk_frame_clock_get_refresh_info(frame_clock, frame_time, &refresh_interval, NULL);
+	stats.refresh_interval = (refresh_interval > 0) ? refresh_interval : DEFAULT_REFRESH_INTERVAL;
+
+	if (0 != stats.last_frame && frame_time - stats.last_frame < get_animation_gap()) {
+		if (! stats.in_animation) {
+			stats.in_animation = TRUE;
+			stats.animations++;
+		}
+
+		add_interval(MAX(0, frame_time - stats.last_frame));
+
+	} else {
+		stats.in_animation = FALSE;
+	}
+
+	stats.last_frame = frame_time;
+}
+
+
+/*
+ * Starts counting the frames `web_view` draws in. `window` must be realized.
+ */
+void
+frame_stats_start(GtkWidget *window, GtkWidget *web_view) {
+	GdkFrameClock *frame_clock = gtk_widget_get_frame_clock(window);
+
+	if (stats.started || NULL == frame_clock) {
+		return;
+	}
+
+	stats.started = TRUE;
+	stats.refresh_interval = DEFAULT_REFRESH_INTERVAL;
+
+	g_signal_connect_after(web_view, "draw", G_CALLBACK(web_view_draw_cb), NULL);
+	g_signal_connect(frame_clock, "after-paint", G_CALLBACK(after_paint_cb), NULL);
+}
+
+
+/*
+ * Fills `summary`. Interval fields are 0 until the web view has animated.
+ */
+void
+frame_stats_get_summary(FrameStatsSummary *summary) {
+	static const gdouble quantiles[] = {0.5, 0.95, 0.99};
+	gdouble values[G_N_ELEMENTS(quantiles)] = {0, 0, 0};
+
+	sample_window_get_quantiles(&stats.samples, quantiles, values, G_N_ELEMENTS(quantiles));
+
+	summary->frames = stats.frames;
+	summary->animations = stats.animations;
+	summary->long_frames = stats.long_frames;
+	summary->dropped_frames = stats.dropped_frames;
+	summary->refresh_interval = stats.refresh_interval / 1000.0;
+	summary->mean_interval = (0 != stats.intervals) ? stats.sum / stats.intervals : 0;
+	summary->p50_interval = values[0];
+	summary->p95_interval = values[1];
+	summary->p99_interval = values[2];
+	summary->max_interval = stats.max;
+}
+
+
+/*
+ * Returns a one line summary for the log. Free it with g_free().
+ */
+gchar *
+frame_stats_to_string(void) {
+	FrameStatsSummary summary;
+
+	if (0 == stats.intervals) {
+		return g_strdup_printf("Frame pacing: %" G_GUINT64_FORMAT " frames, no animations yet", stats.frames);
+	}
+
+	frame_stats_get_summary(&summary);
+
+	return g_strdup_printf(
+		"Frame pacing: %" G_GUINT64_FORMAT " frames in %" G_GUINT64_FORMAT " animations, "
+		"interval p50 %.1f ms, p95 %.1f ms, p99 %.1f ms, max %.1f ms (refresh %.1f ms), "
+		"%" G_GUINT64_FORMAT " long frames, %" G_GUINT64_FORMAT " dropped frames",
+		summary.frames, summary.animations,
+		summary.p50_interval, summary.p95_interval, summary.p99_interval, summary.max_interval,
+		summary.refresh_interval, summary.long_frames, summary.dropped_frames
+	);
+}
+
+
+/*
+ * Appends the frame counters and intervals to the metrics socket's text, if frames are
+ * being counted.
+ */
+void
+frame_stats_append_metrics(GString *text) {
+	static const gdouble quantiles[] = {0.5, 0.95, 0.99};
+	gdouble values[G_N_ELEMENTS(quantiles)];
+	guint i;
+
+	if (! stats.started) {
+		return;
+	}
+
+	metrics_text_append_family(text, "greeter_web_view_frames_total", "counter", "Frames the web view drew in.");
+	metrics_text_append_value(text, "greeter_web_view_frames_total", NULL, (gdouble) stats.frames);
+
+	metrics_text_append_family(text, "greeter_long_frames_total", "counter", "Frame intervals during animations longer than 50 ms.");
+	metrics_text_append_value(text, "greeter_long_frames_total", NULL, (gdouble) stats.long_frames);
+
+	metrics_text_append_family(text, "greeter_dropped_frames_total", "counter", "Display refreshes missed during animations.");
+	metrics_text_append_value(text, "greeter_dropped_frames_total", NULL, (gdouble) stats.dropped_frames);
+
+	metrics_text_append_family(
+		text,
+		"greeter_frame_interval_seconds",
+		"summary",
+		"Time between consecutive frames of the web view during animations."
+	);
+
+	if (sample_window_get_quantiles(&stats.samples, quantiles, values, G_N_ELEMENTS(quantiles))) {
+		for (i = 0; i < G_N_ELEMENTS(quantiles); i++) {
+			gchar *labels = g_strdup_printf("quantile=\"%g\"", quantiles[i]);
+
+			metrics_text_append_value(text, "greeter_frame_interval_seconds", labels, values[i] / 1000.0);
+			g_free(labels);
+		}
+	}
+
+	metrics_text_append_value(text, "greeter_frame_interval_seconds_sum", NULL, stats.sum / 1000.0);
+	metrics_text_append_value(text, "greeter_frame_interval_seconds_count", NULL, (gdouble) stats.intervals);
+}
@@ -0,0 +1,73 @@
+/*
+ * frame-stats.h
+ *
+ * Copyright © 2017 Antergos Developers <dev@antergos.com>
+ *
+ * This file is part of lightdm-webkit2-greeter.
+ *
+ * lightdm-webkit2-greeter is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * lightdm-webkit2-greeter is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * The following additional terms are in effect as per Section 7 of the license:
+ *
+ * The preservation of all legal notices and author attributions in
+ * the material or in the Appropriate Legal Notices displayed
+ * by works containing it is required.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with lightdm-webkit2-greeter; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Frame pacing of the web view in the UI process, collected in debug mode. Only frames in
+ * which the web view drew are counted, so an idle theme costs nothing but also reports
+ * nothing.
+ */
+
+#ifndef FRAME_STATS_H
+#define FRAME_STATS_H
+
+#include <gtk/gtk.h>
+
+G_BEGIN_DECLS
+
+/* Intervals longer than this are jank */
+#define FRAME_STATS_LONG_FRAME 50
+
+typedef struct {
+	guint64 frames;
+	guint64 animations;
+	guint64 long_frames;
+	guint64 dropped_frames;
+
+	/* Milliseconds, intervals are taken over the most recent frames of animations */
+	gdouble refresh_interval;
+	gdouble mean_interval;
+	gdouble p50_interval;
+	gdouble p95_interval;
+	gdouble p99_interval;
+	gdouble max_interval;
+} FrameStatsSummary;
+
+
+void
+frame_stats_start(GtkWidget *window, GtkWidget *web_view);
+
+void
+frame_stats_get_summary(FrameStatsSummary *summary);
+
+gchar *
+frame_stats_to_string(void);
+
+void
+frame_stats_append_metrics(GString *text);
+
+G_END_DECLS
+
+#endif /* FRAME_STATS_H */
@@ -0,0 +1,741 @@
+/*
+ * greeter-backend.c
+ *
+ * Copyright © 2017 Antergos Developers <dev@antergos.com>
+ *
+ * This file is part of lightdm-webkit2-greeter.
+ *
+ * lightdm-webkit2-greeter is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * lightdm-webkit2-greeter is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * The following additional terms are in effect as per Section 7 of the license:
+ *
+ * The preservation of all legal notices and author attributions in
+ * the material or in the Appropriate Legal Notices displayed
+ * by works containing it is required.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with lightdm-webkit2-greeter; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <glib/gstdio.h>
+#include <gio/gio.h>
+
+#include "config.h"
+#include "greeter-backend.h"
+
+/* Work-around CLion bug */
+#ifndef CONFIG_DIR
+#include "../build/src/config.h"
+#endif
+
+
+#define MOCK_SECTION           "mock_backend"
+#define MOCK_DEFAULT_USERS     10
+#define MOCK_DEFAULT_SESSIONS  3
+#define MOCK_DEFAULT_LAYOUTS   10
+#define MOCK_DEFAULT_LANGUAGES 10
+#define MOCK_DEFAULT_DELAY     100   /* Milliseconds */
+#define MOCK_DEFAULT_PROMPT    "secret:Password: "
+
+
+/* A user, session, layout or language of the mock backend. It is a GObject so that the
+ * extension can ref it like the liblightdm objects it stands in for.
+ */
+typedef struct {
+	GObject parent_instance;
+
+	gchar *key;
+	gchar *name;
+	gchar *description;
+	gchar *home_directory;
+	gchar *session;
+	gchar *language;
+	gchar *layout;
+} GreeterBackendItem;
+
+typedef struct {
+	GObjectClass parent_class;
+} GreeterBackendItemClass;
+
+G_DEFINE_TYPE(GreeterBackendItem, greeter_backend_item, G_TYPE_OBJECT)
+
+#define ITEM(object) ((GreeterBackendItem *) (object))
+
+
+static struct {
+	gboolean enabled;
+	LightDMGreeter *greeter;
+
+	GList *users,
+		  *sessions,
+		  *languages,
+		  *layouts;
+
+	GreeterBackendItem *layout;
+
+	/* The scripted conversation, each step is "question|secret|info|error:text" */
+	gchar **steps;
+	gchar *password;
+	guint delay;
+
+	/* The conversation in progress */
+	gchar *user;
+	guint next_step;
+	guint step_id;
+	gboolean need_user;
+	gboolean waiting_for_secret;
+	gboolean waiting_for_response;
+	gboolean in_authentication;
+	gboolean is_authenticated;
+	gboolean accepted;
+} mock;
+
+
+static void
+greeter_backend_item_finalize(GObject *object) {
+	GreeterBackendItem *item = ITEM(object);
+
+	g_free(item->key);
+	g_free(item->name);
+	g_free(item->description);
+	g_free(item->home_directory);
+	g_free(item->session);
+	g_free(item->language);
+	g_free(item->layout);
+
+	G_OBJECT_CLASS(greeter_backend_item_parent_class)->finalize(object);
+}
+
+
+static void
+greeter_backend_item_class_init(GreeterBackendItemClass *klass) {
+	G_OBJECT_CLASS(klass)->finalize = greeter_backend_item_finalize;
+}
+
+
+static void
+greeter_backend_item_init(GreeterBackendItem *item) {
+}
+
+
+static GreeterBackendItem *
+item_new(gchar *key, gchar *name, gchar *description) {
+	GreeterBackendItem *item = g_object_new(greeter_backend_item_get_type(), NULL);
+
+	item->key = key;
+	item->name = name;
+	item->description = description;
+
+	return item;
+}
+
+
+static gint
+get_count(GKeyFile *keyfile, const gchar *key, gint fallback) {
+	GError *err = NULL;
+	gint count = g_key_file_get_integer(keyfile, MOCK_SECTION, key, &err);
+
+	if (NULL != err) {
+		g_error_free(err);
+		return fallback;
+	}
+
+	return CLAMP(count, 0, 1000000);
+}
+
+
+static void
+create_items(GKeyFile *keyfile) {
+	gint i, n_users, n_sessions, n_layouts, n_languages;
+
+	n_users = get_count(keyfile, "users", MOCK_DEFAULT_USERS);
+	n_sessions = MAX(1, get_count(keyfile, "sessions", MOCK_DEFAULT_SESSIONS));
+	n_layouts = MAX(1, get_count(keyfile, "layouts", MOCK_DEFAULT_LAYOUTS));
+	n_languages = MAX(1, get_count(keyfile, "languages", MOCK_DEFAULT_LANGUAGES));
+
+	/* Prepending and reversing keeps building 10k+ users linear */
+	for (i = 0; i < n_users; i++) {
+		GreeterBackendItem *user = item_new(
+			g_strdup_printf("user%d", i),
+			g_strdup_printf("Mock User %d", i),
+			NULL
+		);
+
+		user->home_directory = g_strdup_printf("/home/user%d", i);
+		user->session = g_strdup_printf("mock-session-%d", i % n_sessions);
+		user->language = g_strdup_printf("l%d_XX.UTF-8", i % n_languages);
+		user->layout = g_strdup_printf("l%d", i % n_layouts);
+
+		mock.users = g_list_prepend(mock.users, user);
+	}
+
+	for (i = 0; i < n_sessions; i++) {
+		mock.sessions = g_list_prepend(mock.sessions, item_new(
+			g_strdup_printf("mock-session-%d", i),
+			g_strdup_printf("Mock Session %d", i),
+			g_strdup_printf("Made-up session %d", i)
+		));
+	}
+
+	for (i = 0; i < n_layouts; i++) {
+		mock.layouts = g_list_prepend(mock.layouts, item_new(
+			g_strdup_printf("l%d", i),
+			g_strdup_printf("l%d", i),
+			g_strdup_printf("Mock Layout %d", i)
+		));
+	}
+
+	for (i = 0; i < n_languages; i++) {
+		mock.languages = g_list_prepend(mock.languages, item_new(
+			g_strdup_printf("l%d_XX.UTF-8", i),
+			g_strdup_printf("Mock Language %d", i),
+			g_strdup_printf("Mock Territory %d", i)
+		));
+	}
+
+	mock.users = g_list_reverse(mock.users);
+	mock.sessions = g_list_reverse(mock.sessions);
+	mock.layouts = g_list_reverse(mock.layouts);
+	mock.languages = g_list_reverse(mock.languages);
+	mock.layout = mock.layouts->data;
+}
+
+
+/*
+ * Switches to the mock backend if `mock_backend` is enabled in the config file.
+ */
+void
+greeter_backend_init(GKeyFile *keyfile, LightDMGreeter *greeter) {
+	GError *err = NULL;
+
+	mock.enabled = g_key_file_get_boolean(keyfile, "greeter", "mock_backend", &err);
+
+	if (NULL != err) {
+		g_error_free(err);
+		mock.enabled = FALSE;
+	}
+
+	if (! mock.enabled) {
+		return;
+	}
+
+	mock.greeter = greeter;
+	mock.steps = g_key_file_get_string_list(keyfile, MOCK_SECTION, "prompts", NULL, NULL);
+	mock.password = g_key_file_get_string(keyfile, MOCK_SECTION, "password", NULL);
+	mock.delay = (guint) get_count(keyfile, "delay", MOCK_DEFAULT_DELAY);
+
+	if (NULL == mock.steps) {
+		mock.steps = g_strsplit(MOCK_DEFAULT_PROMPT, ";", -1);
+	}
+
+	create_items(keyfile);
+
+	g_message(
+		"Using the mock backend: %u users, %u sessions, %u layouts, %u languages",
+		g_list_length(mock.users),
+		g_list_length(mock.sessions),
+		g_list_length(mock.layouts),
+		g_list_length(mock.languages)
+	);
+}
+
+
+gboolean
+greeter_backend_is_mock(void) {
+	return mock.enabled;
+}
+
+
+/*
+ * There is no daemon to connect to with the mock backend.
+ */
+gboolean
+greeter_backend_connect(LightDMGreeter *greeter, GError **error) {
+	if (mock.enabled) {
+		return TRUE;
+	}
+
+	/* TODO: This function was deprecated in lightdm 1.11.x.
+	 * New function is lightdm_greeter_connect_to_daemon_sync
+	 * Wait until it makes it into Debian Stable before making the change.
+	 */
+	return lightdm_greeter_connect_sync(greeter, error);
+}
+
+
+/* ---->>> Lists <<<---- */
+
+GList *
+greeter_backend_get_users(void) {
+	return mock.enabled ? mock.users : lightdm_user_list_get_users(lightdm_user_list_get_instance());
+}
+
+
+GList *
+greeter_backend_get_sessions(void) {
+	return mock.enabled ? mock.sessions : lightdm_get_sessions();
+}
+
+
+GList *
+greeter_backend_get_languages(void) {
+	return mock.enabled ? mock.languages : lightdm_get_languages();
+}
+
+
+LightDMLanguage *
+greeter_backend_get_language(void) {
+	return mock.enabled ? mock.languages->data : lightdm_get_language();
+}
+
+
+GList *
+greeter_backend_get_layouts(void) {
+	return mock.enabled ? mock.layouts : lightdm_get_layouts();
+}
+
+
+LightDMLayout *
+greeter_backend_get_layout(void) {
+	return mock.enabled ? (LightDMLayout *) mock.layout : lightdm_get_layout();
+}
+
+
+/*
+ * Takes the reference the caller holds on `layout`, like lightdm_set_layout().
+ */
+void
+greeter_backend_set_layout(LightDMLayout *layout) {
+	if (! mock.enabled) {
+		lightdm_set_layout(layout);
+		return;
+	}
+
+	mock.layout = ITEM(layout);
+	g_object_unref(layout);
+}
+
+
+/* ---->>> Objects <<<---- */
+
+const gchar *
+greeter_backend_user_get_name(LightDMUser *user) {
+	return mock.enabled ? ITEM(user)->key : lightdm_user_get_name(user);
+}
+
+const gchar *
+greeter_backend_user_get_real_name(LightDMUser *user) {
+	return mock.enabled ? ITEM(user)->name : lightdm_user_get_real_name(user);
+}
+
+const gchar *
+greeter_backend_user_get_display_name(LightDMUser *user) {
+	return mock.enabled ? ITEM(user)->name : lightdm_user_get_display_name(user);
+}
+
+const gchar *
+greeter_backend_user_get_home_directory(LightDMUser *user) {
+	return mock.enabled ? ITEM(user)->home_directory : lightdm_user_get_home_directory(user);
+}
+
+const gchar *
+greeter_backend_user_get_image(LightDMUser *user) {
+	/* Themes fall back to their default avatar */
+	return mock.enabled ? NULL : lightdm_user_get_image(user);
+}
+
+const gchar *
+greeter_backend_user_get_language(LightDMUser *user) {
+	return mock.enabled ? ITEM(user)->language : lightdm_user_get_language(user);
+}
+
+const gchar *
+greeter_backend_user_get_layout(LightDMUser *user) {
+	return mock.enabled ? ITEM(user)->layout : lightdm_user_get_layout(user);
+}
+
+const gchar *
+greeter_backend_user_get_session(LightDMUser *user) {
+	return mock.enabled ? ITEM(user)->session : lightdm_user_get_session(user);
+}
+
+gboolean
+greeter_backend_user_get_logged_in(LightDMUser *user) {
+	return mock.enabled ? FALSE : lightdm_user_get_logged_in(user);
+}
+
+const gchar *
+greeter_backend_language_get_code(LightDMLanguage *language) {
+	return mock.enabled ? ITEM(language)->key : lightdm_language_get_code(language);
+}
+
+const gchar *
+greeter_backend_language_get_name(LightDMLanguage *language) {
+	return mock.enabled ? ITEM(language)->name : lightdm_language_get_name(language);
+}
+
+const gchar *
+greeter_backend_language_get_territory(LightDMLanguage *language) {
+	return mock.enabled ? ITEM(language)->description : lightdm_language_get_territory(language);
+}
+
+const gchar *
+greeter_backend_layout_get_name(LightDMLayout *layout) {
+	return mock.enabled ? ITEM(layout)->key : lightdm_layout_get_name(layout);
+}
+
+const gchar *
+greeter_backend_layout_get_short_description(LightDMLayout *layout) {
+	return mock.enabled ? ITEM(layout)->name : lightdm_layout_get_short_description(layout);
+}
+
+const gchar *
+greeter_backend_layout_get_description(LightDMLayout *layout) {
+	return mock.enabled ? ITEM(layout)->description : lightdm_layout_get_description(layout);
+}
+
+const gchar *
+greeter_backend_session_get_key(LightDMSession *session) {
+	return mock.enabled ? ITEM(session)->key : lightdm_session_get_key(session);
+}
+
+const gchar *
+greeter_backend_session_get_name(LightDMSession *session) {
+	return mock.enabled ? ITEM(session)->name : lightdm_session_get_name(session);
+}
+
+const gchar *
+greeter_backend_session_get_comment(LightDMSession *session) {
+	return mock.enabled ? ITEM(session)->description : lightdm_session_get_comment(session);
+}
+
+
+/* ---->>> Scripted conversation <<<---- */
+
+static void schedule_step(void);
+
+
+static gboolean
+run_step_cb(gpointer user_data) {
+	const gchar *step, *text;
+
+	mock.step_id = 0;
+
+	if (mock.need_user) {
+		mock.waiting_for_response = TRUE;
+		g_signal_emit_by_name(mock.greeter, "show-prompt", "login:", LIGHTDM_PROMPT_TYPE_QUESTION);
+
+		return G_SOURCE_REMOVE;
+	}
+
+	step = mock.steps[mock.next_step];
+
+	if (NULL == step) {
+		mock.in_authentication = FALSE;
+		mock.is_authenticated = mock.accepted;
+		g_signal_emit_by_name(mock.greeter, "authentication-complete");
+
+		return G_SOURCE_REMOVE;
+	}
+
+	mock.next_step++;
+	text = strchr(step, ':');
+	text = (NULL != text) ? text + 1 : step;
+
+	if (g_str_has_prefix(step, "info:") || g_str_has_prefix(step, "error:")) {
+		LightDMMessageType type = g_str_has_prefix(step, "info:")
+			? LIGHTDM_MESSAGE_TYPE_INFO
+			: LIGHTDM_MESSAGE_TYPE_ERROR;
+
+		g_signal_emit_by_name(mock.greeter, "show-message", text, type);
+		schedule_step();
+
+	} else {
+		mock.waiting_for_secret = ! g_str_has_prefix(step, "question:");
+		mock.waiting_for_response = TRUE;
+
+		g_signal_emit_by_name(
+			mock.greeter,
+			"show-prompt",
+			text,
+			mock.waiting_for_secret ? LIGHTDM_PROMPT_TYPE_SECRET : LIGHTDM_PROMPT_TYPE_QUESTION
+		);
+	}
+
+	return G_SOURCE_REMOVE;
+}
+
+
+/*
+ * PAM takes its time, so does the mock. Steps run from the main loop like the daemon's
+ * replies would.
+ */
+static void
+schedule_step(void) {
+	mock.step_id = g_timeout_add(mock.delay, run_step_cb, NULL);
+}
+
+
+static void
+reset_conversation(void) {
+	if (0 != mock.step_id) {
+		g_source_remove(mock.step_id);
+		mock.step_id = 0;
+	}
+
+	g_free(mock.user);
+	mock.user = NULL;
+	mock.next_step = 0;
+	mock.need_user = FALSE;
+	mock.waiting_for_secret = FALSE;
+	mock.waiting_for_response = FALSE;
+	mock.in_authentication = FALSE;
+	mock.is_authenticated = FALSE;
+	mock.accepted = TRUE;
+}
+
+
+static void
+start_conversation(const gchar *user, gboolean guest) {
+	reset_conversation();
+
+	mock.user = g_strdup(user);
+	mock.need_user = (! guest && (NULL == user || '\0' == *user));
+	mock.in_authentication = TRUE;
+
+	if (guest) {
+		/* Guests don't get asked anything */
+		mock.next_step = g_strv_length(mock.steps);
+	}
+
+	schedule_step();
+}
+
+
+/* ---->>> Greeter <<<---- */
+
+const gchar *
+greeter_backend_get_default_session_hint(LightDMGreeter *greeter) {
+	if (mock.enabled) {
+		return ITEM(mock.sessions->data)->key;
+	}
+
+	return lightdm_greeter_get_default_session_hint(greeter);
+}
+
+
+gboolean
+greeter_backend_get_in_authentication(LightDMGreeter *greeter) {
+	return mock.enabled ? mock.in_authentication : lightdm_greeter_get_in_authentication(greeter);
+}
+
+
+gboolean
+greeter_backend_get_is_authenticated(LightDMGreeter *greeter) {
+	return mock.enabled ? mock.is_authenticated : lightdm_greeter_get_is_authenticated(greeter);
+}
+
+
+const gchar *
+greeter_backend_get_authentication_user(LightDMGreeter *greeter) {
+	return mock.enabled ? mock.user : lightdm_greeter_get_authentication_user(greeter);
+}
+
+
+gboolean
+greeter_backend_authenticate(LightDMGreeter *greeter, const gchar *user, GError **error) {
+	if (mock.enabled) {
+		start_conversation(user, FALSE);
+		return TRUE;
+	}
+
+#ifdef HAS_LIGHTDM_1_19_2
+	return lightdm_greeter_authenticate(greeter, user, error);
+#else
+	lightdm_greeter_authenticate(greeter, user);
+	return TRUE;
+#endif
+}
+
+
+gboolean
+greeter_backend_authenticate_as_guest(LightDMGreeter *greeter, GError **error) {
+	if (mock.enabled) {
+		start_conversation("guest", TRUE);
+		return TRUE;
+	}
+
+#ifdef HAS_LIGHTDM_1_19_2
+	return lightdm_greeter_authenticate_as_guest(greeter, error);
+#else
+	lightdm_greeter_authenticate_as_guest(greeter);
+	return TRUE;
+#endif
+}
+
+
+gboolean
+greeter_backend_respond(LightDMGreeter *greeter, const gchar *response, GError **error) {
+	if (mock.enabled) {
+		if (! mock.waiting_for_response) {
+			g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_FAILED, "Not waiting for a response");
+			return FALSE;
+		}
+
+		mock.waiting_for_response = FALSE;
+
+		if (mock.need_user) {
+			mock.need_user = FALSE;
+			g_free(mock.user);
+			mock.user = g_strdup(response);
+
+		} else if (mock.waiting_for_secret && NULL != mock.password && '\0' != *mock.password) {
+			mock.accepted = mock.accepted && 0 == g_strcmp0(response, mock.password);
+		}
+
+		schedule_step();
+		return TRUE;
+	}
+
+#ifdef HAS_LIGHTDM_1_19_2
+	return lightdm_greeter_respond(greeter, response, error);
+#else
+	lightdm_greeter_respond(greeter, response);
+	return TRUE;
+#endif
+}
+
+
+gboolean
+greeter_backend_cancel_authentication(LightDMGreeter *greeter, GError **error) {
+	if (mock.enabled) {
+		reset_conversation();
+		return TRUE;
+	}
+
+#ifdef HAS_LIGHTDM_1_19_2
+	return lightdm_greeter_cancel_authentication(greeter, error);
+#else
+	lightdm_greeter_cancel_authentication(greeter);
+	return TRUE;
+#endif
+}
+
+
+gboolean
+greeter_backend_set_language(LightDMGreeter *greeter, const gchar *language, GError **error) {
+	if (mock.enabled) {
+		return TRUE;
+	}
+
+#ifdef HAS_LIGHTDM_1_19_2
+	return lightdm_greeter_set_language(greeter, language, error);
+#else
+	lightdm_greeter_set_language(greeter, language);
+	return TRUE;
+#endif
+}
+
+
+/*
+ * Returns the path to the user's directory below the LightDM data directory (a directory
+ * in the cache with the mock backend) or NULL.
+ */
+gchar *
+greeter_backend_ensure_shared_data_dir(LightDMGreeter *greeter, const gchar *user, GError **error) {
+	if (mock.enabled) {
+		gchar *path = g_build_filename(
+			g_get_user_cache_dir(), "lightdm-webkit2-greeter", "mock-data", user, NULL
+		);
+
+		g_mkdir_with_parents(path, 0700);
+
+		return path;
+	}
+
+#ifdef HAS_LIGHTDM_1_19_2
+	return lightdm_greeter_ensure_shared_data_dir_sync(greeter, user, error);
+#else
+	return lightdm_greeter_ensure_shared_data_dir_sync(greeter, user);
+#endif
+}
+
+
+/*
+ * The mock backend only pretends to start the session so the theme can be tried again
+ * after a reload.
+ */
+gboolean
+greeter_backend_start_session(LightDMGreeter *greeter, const gchar *session, GError **error) {
+	if (mock.enabled) {
+		g_message(
+			"Mock backend: starting session %s for %s",
+			(NULL != session) ? session : greeter_backend_get_default_session_hint(greeter),
+			mock.user
+		);
+
+		reset_conversation();
+		return TRUE;
+	}
+
+	return lightdm_greeter_start_session_sync(greeter, session, error);
+}
+
+
+/* ---->>> Power <<<---- */
+
+gboolean
+greeter_backend_can_power_action(GreeterBackendPowerAction action) {
+	if (mock.enabled) {
+		return TRUE;
+	}
+
+	switch (action) {
+		case GREETER_BACKEND_SUSPEND:
+			return lightdm_get_can_suspend();
+		case GREETER_BACKEND_HIBERNATE:
+			return lightdm_get_can_hibernate();
+		case GREETER_BACKEND_RESTART:
+			return lightdm_get_can_restart();
+		case GREETER_BACKEND_SHUTDOWN:
+			return lightdm_get_can_shutdown();
+	}
+
+	return FALSE;
+}
+
+
+/*
+ * The mock backend must never power off the machine a theme is being developed on.
+ */
+gboolean
+greeter_backend_power_action(GreeterBackendPowerAction action) {
+	static const gchar *names[] = {"suspend", "hibernate", "restart", "shutdown"};
+
+	if (mock.enabled) {
+		g_message("Mock backend: ignoring %s", names[action]);
+		return TRUE;
+	}
+
+	switch (action) {
+		case GREETER_BACKEND_SUSPEND:
+			return lightdm_suspend(NULL);
+		case GREETER_BACKEND_HIBERNATE:
+			return lightdm_hibernate(NULL);
+		case GREETER_BACKEND_RESTART:
+			return lightdm_restart(NULL);
+		case GREETER_BACKEND_SHUTDOWN:
+			return lightdm_shutdown(NULL);
+	}
+
+	return FALSE;
+}
@@ -0,0 +1,158 @@
+/*
+ * greeter-backend.h
+ *
+ * Copyright © 2017 Antergos Developers <dev@antergos.com>
+ *
+ * This file is part of lightdm-webkit2-greeter.
+ *
+ * lightdm-webkit2-greeter is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * lightdm-webkit2-greeter is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * The following additional terms are in effect as per Section 7 of the license:
+ *
+ * The preservation of all legal notices and author attributions in
+ * the material or in the Appropriate Legal Notices displayed
+ * by works containing it is required.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with lightdm-webkit2-greeter; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Everything the web extension asks liblightdm goes through here so that the mock
+ * backend (`mock_backend` in the config file) can stand in for the daemon. The mock
+ * serves made-up users, sessions, layouts and languages from the [mock_backend] section
+ * and plays a scripted PAM conversation through the greeter's usual signals, which lets
+ * themes be developed and load tested on any desktop.
+ *
+ * The wrappers also hide the liblightdm 1.19.2 API change: they always take a GError.
+ */
+
+#ifndef GREETER_BACKEND_H
+#define GREETER_BACKEND_H
+
+#include <glib.h>
+#include <lightdm.h>
+
+G_BEGIN_DECLS
+
+typedef enum {
+	GREETER_BACKEND_SUSPEND,
+	GREETER_BACKEND_HIBERNATE,
+	GREETER_BACKEND_RESTART,
+	GREETER_BACKEND_SHUTDOWN,
+} GreeterBackendPowerAction;
+
+
+void
+greeter_backend_init(GKeyFile *keyfile, LightDMGreeter *greeter);
+
+gboolean
+greeter_backend_is_mock(void);
+
+gboolean
+greeter_backend_connect(LightDMGreeter *greeter, GError **error);
+
+
+/* ---->>> Lists <<<---- */
+
+GList *
+greeter_backend_get_users(void);
+
+GList *
+greeter_backend_get_sessions(void);
+
+GList *
+greeter_backend_get_languages(void);
+
+LightDMLanguage *
+greeter_backend_get_language(void);
+
+GList *
+greeter_backend_get_layouts(void);
+
+LightDMLayout *
+greeter_backend_get_layout(void);
+
+void
+greeter_backend_set_layout(LightDMLayout *layout);
+
+
+/* ---->>> Objects <<<---- */
+
+const gchar *greeter_backend_user_get_name(LightDMUser *user);
+const gchar *greeter_backend_user_get_real_name(LightDMUser *user);
+const gchar *greeter_backend_user_get_display_name(LightDMUser *user);
+const gchar *greeter_backend_user_get_home_directory(LightDMUser *user);
+const gchar *greeter_backend_user_get_image(LightDMUser *user);
+const gchar *greeter_backend_user_get_language(LightDMUser *user);
+const gchar *greeter_backend_user_get_layout(LightDMUser *user);
+const gchar *greeter_backend_user_get_session(LightDMUser *user);
+gboolean greeter_backend_user_get_logged_in(LightDMUser *user);
+
+const gchar *greeter_backend_language_get_code(LightDMLanguage *language);
+const gchar *greeter_backend_language_get_name(LightDMLanguage *language);
+const gchar *greeter_backend_language_get_territory(LightDMLanguage *language);
+
+const gchar *greeter_backend_layout_get_name(LightDMLayout *layout);
+const gchar *greeter_backend_layout_get_short_description(LightDMLayout *layout);
+const gchar *greeter_backend_layout_get_description(LightDMLayout *layout);
+
+const gchar *greeter_backend_session_get_key(LightDMSession *session);
+const gchar *greeter_backend_session_get_name(LightDMSession *session);
+const gchar *greeter_backend_session_get_comment(LightDMSession *session);
+
+
+/* ---->>> Greeter <<<---- */
+
+const gchar *
+greeter_backend_get_default_session_hint(LightDMGreeter *greeter);
+
+gboolean
+greeter_backend_get_in_authentication(LightDMGreeter *greeter);
+
+gboolean
+greeter_backend_get_is_authenticated(LightDMGreeter *greeter);
+
+const gchar *
+greeter_backend_get_authentication_user(LightDMGreeter *greeter);
+
+gboolean
+greeter_backend_authenticate(LightDMGreeter *greeter, const gchar *user, GError **error);
+
+gboolean
+greeter_backend_authenticate_as_guest(LightDMGreeter *greeter, GError **error);
+
+gboolean
+greeter_backend_respond(LightDMGreeter *greeter, const gchar *response, GError **error);
+
+gboolean
+greeter_backend_cancel_authentication(LightDMGreeter *greeter, GError **error);
+
+gboolean
+greeter_backend_set_language(LightDMGreeter *greeter, const gchar *language, GError **error);
+
+gchar *
+greeter_backend_ensure_shared_data_dir(LightDMGreeter *greeter, const gchar *user, GError **error);
+
+gboolean
+greeter_backend_start_session(LightDMGreeter *greeter, const gchar *session, GError **error);
+
+
+/* ---->>> Power <<<---- */
+
+gboolean
+greeter_backend_can_power_action(GreeterBackendPowerAction action);
+
+gboolean
+greeter_backend_power_action(GreeterBackendPowerAction action);
+
+G_END_DECLS
+
+#endif /* GREETER_BACKEND_H */
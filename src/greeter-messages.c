@@ -0,0 +1,152 @@
+/*
+ * greeter-messages.c
+ *
+ * Copyright © 2017 Antergos Developers <dev@antergos.com>
+ *
+ * This file is part of lightdm-webkit2-greeter.
+ *
+ * lightdm-webkit2-greeter is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * lightdm-webkit2-greeter is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * The following additional terms are in effect as per Section 7 of the license:
+ *
+ * The preservation of all legal notices and author attributions in
+ * the material or in the Appropriate Legal Notices displayed
+ * by works containing it is required.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with lightdm-webkit2-greeter; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "greeter-messages.h"
+
+
+#define SERIALIZED_SEPARATOR "::"
+
+
+/*
+ * Creates a dispatch table from a NULL-terminated array of handlers. The handlers
+ * must outlive the table.
+ */
+GHashTable *
+greeter_message_table_new(const GreeterMessageHandler *handlers) {
+	GHashTable *table = g_hash_table_new(g_str_hash, g_str_equal);
+
+	for (; NULL != handlers->name; handlers++) {
+		g_hash_table_insert(table, (gpointer) handlers->name, (gpointer) handlers);
+	}
+
+	return table;
+}
+
+
+/*
+ * Calls the handler registered for `name` after checking the payload's type.
+ *
+ * Returns TRUE if the message was handled.
+ */
+gboolean
+greeter_message_dispatch(GHashTable  *table,
+						 const gchar *name,
+						 GVariant    *parameters,
+						 gpointer     user_data) {
+
+	const GreeterMessageHandler *handler = g_hash_table_lookup(table, name);
+
+	if (NULL == handler) {
+		g_warning("Unknown greeter message: %s", name);
+		return FALSE;
+	}
+
+	if (NULL == parameters || ! g_variant_is_of_type(parameters, G_VARIANT_TYPE(handler->type))) {
+		g_warning(
+			"Greeter message %s has the wrong payload type: %s (expected %s)",
+			name,
+			(NULL != parameters) ? g_variant_get_type_string(parameters) : "none",
+			handler->type
+		);
+		return FALSE;
+	}
+
+	handler->handler(parameters, user_data);
+
+	return TRUE;
+}
+
+
+/*
+ * Serializes a message for transports that can only carry strings.
+ */
+gchar *
+greeter_message_serialize(const gchar *name, GVariant *parameters) {
+	gchar *text, *result;
+
+	text = g_variant_print(parameters, FALSE);
+	result = g_strconcat(name, SERIALIZED_SEPARATOR, text, NULL);
+	g_free(text);
+
+	return result;
+}
+
+
+/*
+ * Dispatches a message created by greeter_message_serialize().
+ *
+ * Returns TRUE if the message was handled.
+ */
+gboolean
+greeter_message_dispatch_serialized(GHashTable *table, const gchar *message, gpointer user_data) {
+	const GreeterMessageHandler *handler;
+	const gchar *separator;
+	GVariant *parameters;
+	gchar *name;
+	gboolean result;
+	GError *err = NULL;
+
+	separator = strstr(message, SERIALIZED_SEPARATOR);
+
+	if (NULL == separator) {
+		g_warning("Malformed greeter message: %s", message);
+		return FALSE;
+	}
+
+	name = g_strndup(message, separator - message);
+	handler = g_hash_table_lookup(table, name);
+
+	if (NULL == handler) {
+		g_warning("Unknown greeter message: %s", name);
+		g_free(name);
+		return FALSE;
+	}
+
+	parameters = g_variant_parse(
+		G_VARIANT_TYPE(handler->type),
+		separator + strlen(SERIALIZED_SEPARATOR),
+		NULL,
+		NULL,
+		&err
+	);
+
+	if (NULL != err) {
+		g_warning("Malformed payload for greeter message %s: %s", name, err->message);
+		g_error_free(err);
+		g_free(name);
+		return FALSE;
+	}
+
+	result = greeter_message_dispatch(table, name, g_variant_ref_sink(parameters), user_data);
+
+	g_variant_unref(parameters);
+	g_free(name);
+
+	return result;
+}
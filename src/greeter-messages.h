@@ -0,0 +1,141 @@
+/*
+ * greeter-messages.h
+ *
+ * Copyright © 2017 Antergos Developers <dev@antergos.com>
+ *
+ * This file is part of lightdm-webkit2-greeter.
+ *
+ * lightdm-webkit2-greeter is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * lightdm-webkit2-greeter is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * The following additional terms are in effect as per Section 7 of the license:
+ *
+ * The preservation of all legal notices and author attributions in
+ * the material or in the Appropriate Legal Notices displayed
+ * by works containing it is required.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with lightdm-webkit2-greeter; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Messages exchanged between the UI process (greeter.c) and the web extension
+ * (webkit2-extension.c). Every message has a name and a GVariant payload whose type is
+ * fixed per message. Each process registers a table of the messages it handles.
+ *
+ * With WebKitGTK 2.28+ messages travel as WebKitUserMessage in both directions. Older
+ * versions only have the GreeterBridge script message handler, which carries messages
+ * from the web process to the UI process serialized as "Name::<GVariant text>".
+ */
+
+#ifndef GREETER_MESSAGES_H
+#define GREETER_MESSAGES_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* ---->>> Web Process -> UI Process <<<---- */
+
+/* () The greeter was started as a lock screen */
+#define GREETER_MESSAGE_LOCK_HINT           "LockHint"
+#define GREETER_MESSAGE_LOCK_HINT_TYPE      "()"
+
+/* (x) Theme heartbeat carrying its event loop lag in milliseconds */
+#define GREETER_MESSAGE_HEARTBEAT           "Heartbeat"
+#define GREETER_MESSAGE_HEARTBEAT_TYPE      "(x)"
+
+/* () A session is about to start, the theme will stop sending heartbeats */
+#define GREETER_MESSAGE_SESSION_STARTING       "SessionStarting"
+#define GREETER_MESSAGE_SESSION_STARTING_TYPE  "()"
+
+/* () The daemon accepted start_session(), the greeter is about to be stopped */
+#define GREETER_MESSAGE_SESSION_STARTED        "SessionStarted"
+#define GREETER_MESSAGE_SESSION_STARTED_TYPE   "()"
+
+/* () start_session() failed, or the mock backend only pretended: the theme stays, expect
+ * its heartbeats again
+ */
+#define GREETER_MESSAGE_SESSION_NOT_STARTED       "SessionNotStarted"
+#define GREETER_MESSAGE_SESSION_NOT_STARTED_TYPE  "()"
+
+/* (ssssii) kind, message, source, stack, line, column of an uncaught theme error */
+#define GREETER_MESSAGE_THEME_ERROR         "ThemeError"
+#define GREETER_MESSAGE_THEME_ERROR_TYPE    "(ssssii)"
+
+/* (s) Reply to MetricsRequest: the web process's metrics in the Prometheus text format */
+#define GREETER_MESSAGE_METRICS             "Metrics"
+#define GREETER_MESSAGE_METRICS_TYPE        "(s)"
+
+/* () The theme has loaded, its fonts are ready and the frame after that was drawn */
+#define GREETER_MESSAGE_THEME_READY         "ThemeReady"
+#define GREETER_MESSAGE_THEME_READY_TYPE    "()"
+
+/* (xtttt) Reply to BenchmarkRequest: JS heap bytes (-1 if unknown), DOM nodes, requests,
+ * bytes read and resident bytes of the web process
+ */
+#define GREETER_MESSAGE_BENCHMARK           "Benchmark"
+#define GREETER_MESSAGE_BENCHMARK_TYPE      "(xtttt)"
+
+/* ---->>> UI Process -> Web Process <<<---- */
+
+/* () The config file changed, reload it */
+#define GREETER_MESSAGE_CONFIG_RELOAD       "ConfigReload"
+#define GREETER_MESSAGE_CONFIG_RELOAD_TYPE  "()"
+
+/* (iiii) x, y, width, height of the monitor the greeter is shown on */
+#define GREETER_MESSAGE_MONITOR_GEOMETRY       "MonitorGeometry"
+#define GREETER_MESSAGE_MONITOR_GEOMETRY_TYPE  "(iiii)"
+
+/* (b) Whether the screensaver has blanked the display */
+#define GREETER_MESSAGE_DISPLAY_BLANKED        "DisplayBlanked"
+#define GREETER_MESSAGE_DISPLAY_BLANKED_TYPE   "(b)"
+
+/* () Someone is reading the metrics socket, reply with Metrics (WebKitGTK 2.28+ only) */
+#define GREETER_MESSAGE_METRICS_REQUEST        "MetricsRequest"
+#define GREETER_MESSAGE_METRICS_REQUEST_TYPE   "()"
+
+/* () --benchmark-theme is done, reply with Benchmark (WebKitGTK 2.28+ only) */
+#define GREETER_MESSAGE_BENCHMARK_REQUEST      "BenchmarkRequest"
+#define GREETER_MESSAGE_BENCHMARK_REQUEST_TYPE "()"
+
+/* (ttttdddddd) Frame pacing of the web view in debug mode: frames, animations, long frames,
+ * dropped frames and the refresh, mean, p50, p95, p99 and max intervals in milliseconds
+ */
+#define GREETER_MESSAGE_FRAME_STATS            "FrameStats"
+#define GREETER_MESSAGE_FRAME_STATS_TYPE       "(ttttdddddd)"
+
+
+typedef void (*GreeterMessageFunc) (GVariant *parameters, gpointer user_data);
+
+typedef struct {
+	const gchar        *name;
+	const gchar        *type;
+	GreeterMessageFunc  handler;
+} GreeterMessageHandler;
+
+
+GHashTable *
+greeter_message_table_new(const GreeterMessageHandler *handlers);
+
+gboolean
+greeter_message_dispatch(GHashTable  *table,
+						 const gchar *name,
+						 GVariant    *parameters,
+						 gpointer     user_data);
+
+gboolean
+greeter_message_dispatch_serialized(GHashTable *table, const gchar *message, gpointer user_data);
+
+gchar *
+greeter_message_serialize(const gchar *name, GVariant *parameters);
+
+G_END_DECLS
+
+#endif /* GREETER_MESSAGES_H */
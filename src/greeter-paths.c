@@ -0,0 +1,81 @@
+/*
+ * greeter-paths.c
+ *
+ * Copyright © 2017 Antergos Developers <dev@antergos.com>
+ *
+ * This file is part of lightdm-webkit2-greeter.
+ *
+ * lightdm-webkit2-greeter is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * lightdm-webkit2-greeter is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * The following additional terms are in effect as per Section 7 of the license:
+ *
+ * The preservation of all legal notices and author attributions in
+ * the material or in the Appropriate Legal Notices displayed
+ * by works containing it is required.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with lightdm-webkit2-greeter; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include "greeter-paths.h"
+
+/* Work-around CLion bug */
+#ifndef CONFIG_DIR
+#include "../build/src/config.h"
+#endif
+
+
+static const gchar *
+get_path_from_env(const gchar *variable, const gchar *fallback) {
+	const gchar *path = g_getenv(variable);
+
+	return (NULL != path && '\0' != *path) ? path : fallback;
+}
+
+
+const gchar *
+greeter_paths_get_config_file(void) {
+	return get_path_from_env(GREETER_CONFIG_FILE_ENV, CONFIG_DIR "/lightdm-webkit2-greeter.conf");
+}
+
+
+/*
+ * The web extension runs in the process that handles passwords, so only benchmark builds
+ * let the environment choose which one is loaded.
+ */
+const gchar *
+greeter_paths_get_webext_dir(void) {
+	#ifdef HAS_BENCHMARKS
+	return get_path_from_env(GREETER_WEBEXT_DIR_ENV, WEBEXT_DIR);
+	#else
+	return WEBEXT_DIR;
+	#endif
+}
+
+
+/*
+ * Returns where the UI process serves its metrics (see metrics-server.c). There is one
+ * socket per seat. Free the result with g_free().
+ */
+gchar *
+greeter_paths_get_metrics_socket(void) {
+	const gchar *seat = get_path_from_env("XDG_SEAT", "seat0");
+	gchar *name, *result;
+
+	name = g_strdup_printf("metrics-%s.sock", seat);
+	g_strdelimit(name, "/", '_');
+
+	result = g_build_filename(g_get_user_runtime_dir(), "lightdm-webkit2-greeter", name, NULL);
+	g_free(name);
+
+	return result;
+}
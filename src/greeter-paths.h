@@ -0,0 +1,55 @@
+/*
+ * greeter-paths.h
+ *
+ * Copyright © 2017 Antergos Developers <dev@antergos.com>
+ *
+ * This file is part of lightdm-webkit2-greeter.
+ *
+ * lightdm-webkit2-greeter is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * lightdm-webkit2-greeter is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * The following additional terms are in effect as per Section 7 of the license:
+ *
+ * The preservation of all legal notices and author attributions in
+ * the material or in the Appropriate Legal Notices displayed
+ * by works containing it is required.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with lightdm-webkit2-greeter; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Locations the greeter is installed to (or serves from). They can be overridden through
+ * the environment so that benchmarks/e2e can run an uninstalled build against a fixture
+ * config. The web extension directory only in builds with enable-benchmarks.
+ */
+
+#ifndef GREETER_PATHS_H
+#define GREETER_PATHS_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+#define GREETER_CONFIG_FILE_ENV  "LIGHTDM_WEBKIT2_GREETER_CONFIG"
+#define GREETER_WEBEXT_DIR_ENV   "LIGHTDM_WEBKIT2_GREETER_WEBEXT_DIR"
+
+
+const gchar *
+greeter_paths_get_config_file(void);
+
+const gchar *
+greeter_paths_get_webext_dir(void);
+
+gchar *
+greeter_paths_get_metrics_socket(void);
+
+G_END_DECLS
+
+#endif /* GREETER_PATHS_H */
@@ -0,0 +1,62 @@
+/*
+ * greeter-trace.h
+ *
+ * Copyright © 2017 Antergos Developers <dev@antergos.com>
+ *
+ * This file is part of lightdm-webkit2-greeter.
+ *
+ * lightdm-webkit2-greeter is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * lightdm-webkit2-greeter is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * The following additional terms are in effect as per Section 7 of the license:
+ *
+ * The preservation of all legal notices and author attributions in
+ * the material or in the Appropriate Legal Notices displayed
+ * by works containing it is required.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with lightdm-webkit2-greeter; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Static tracepoints (USDT) for perf, bpftrace and sysprof. They are only compiled in
+ * with `-Denable-tracing=true` and expand to nothing otherwise. All of them belong to the
+ * "greeter" provider:
+ *
+ *   startup_phase(name)                   UI process reached a startup milestone
+ *   bridge_call_entry(name)               A theme called into the web extension...
+ *   bridge_call_return(name)              ...and got its answer
+ *   lightdm_signal_entry(name)            A LightDM signal handler started...
+ *   lightdm_signal_return(name)           ...and finished
+ *   request_filter_entry(uri)             web_page_send_request_cb() started...
+ *   request_filter_return(uri, blocked)   ...and decided
+ *
+ * eg. `bpftrace -e 'usdt:/usr/lib/lightdm-webkit2-greeter/liblightdm-webkit2-greeter-webext.so:greeter:bridge_call_entry { @[str(arg0)] = count(); }'`
+ */
+
+#ifndef GREETER_TRACE_H
+#define GREETER_TRACE_H
+
+#ifdef HAS_TRACING
+
+#include <sys/sdt.h>
+
+#define GREETER_TRACE(probe)                DTRACE_PROBE(greeter, probe)
+#define GREETER_TRACE1(probe, arg1)         DTRACE_PROBE1(greeter, probe, arg1)
+#define GREETER_TRACE2(probe, arg1, arg2)   DTRACE_PROBE2(greeter, probe, arg1, arg2)
+
+#else
+
+#define GREETER_TRACE(probe)
+#define GREETER_TRACE1(probe, arg1)
+#define GREETER_TRACE2(probe, arg1, arg2)
+
+#endif /* HAS_TRACING */
+
+#endif /* GREETER_TRACE_H */
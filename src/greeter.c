@@ -33,10 +33,12 @@
  */
 
 #include <stdlib.h>
+#include <unistd.h>
 #include <glib.h>
 #include <gtk/gtk.h>
 #include <gdk/gdkx.h>
 #include <glib/gprintf.h>
+#include <glib/gstdio.h>
 #include <glib-unix.h>
 #include <webkit2/webkit2.h>
 #include <JavaScriptCore/JavaScript.h>
@@ -45,6 +47,16 @@
 
 #include "config.h"
 #include "greeter-resources.h"
+#include "greeter-messages.h"
+#include "process-stats.h"
+#include "latency-histogram.h"
+#include "greeter-paths.h"
+#include "metrics-server.h"
+#include "metrics-text.h"
+#include "greeter-trace.h"
+#include "theme-benchmark.h"
+#include "input-latency.h"
+#include "frame-stats.h"
 
 /* Work-around CLion bug */
 #ifndef CONFIG_DIR
@@ -52,6 +64,14 @@
 #include "../build/src/greeter-resources.h"
 #endif
 
+#ifdef HAS_XSS
+#include <X11/extensions/scrnsaver.h>
+#endif
+
+#ifdef HAS_DPMS
+#include <X11/extensions/dpms.h>
+#endif
+
 
 static GtkWidget *web_view;
 static GtkWidget *window;
@@ -69,12 +89,113 @@ static int
 
 static gint config_timeout;
 
-static gboolean debug_mode;
+/* Display blanking and low-power mode */
+#define DPMS_CHECK_INTERVAL 10   /* Seconds */
+
+static gboolean
+	display_blanked,
+	screensaver_active,
+	dpms_off,
+	low_power_mode;
+
+static gint64 unblanked_at;
+static WakeupCounter wakeup_counter;
+
+#ifdef HAS_XSS
+static int screensaver_event_base;
+#endif
+
+#ifdef HAS_DPMS
+static gboolean dpms_capable;
+static guint dpms_check_id;
+
+static gboolean dpms_check_cb(gpointer user_data);
+#endif
+
+static gboolean
+	debug_mode,
+	detect_theme_errors;
+
+/* Theme heartbeat (see ThemeHeartbeat.js) */
+#define HEARTBEAT_CHECK_INTERVAL   5     /* Seconds */
+#define HEARTBEAT_DEAD_AFTER       30    /* Seconds */
+#define HEARTBEAT_STALL_THRESHOLD  250   /* Milliseconds */
+
+static LatencyHistogram stall_histogram = {"Theme event loop lag"};
+
+static gint64 last_heartbeat;
+static guint heartbeat_watchdog_id;
+static gboolean theme_recovery_offered;
+static gboolean heartbeat_exited;
+static guint64 theme_stalls;
+static guint64 theme_errors;
+
+/* Monotonic time the daemon accepted the session or 0 */
+static gint64 session_started_at;
+
+/* Startup phases for the metrics socket, monotonic times or 0 until reached */
+typedef enum {
+	STARTUP_PHASE_GTK_READY,
+	STARTUP_PHASE_WEB_VIEW_CREATED,
+	STARTUP_PHASE_LOAD_COMMITTED,
+	STARTUP_PHASE_FIRST_PAINT,
+	STARTUP_PHASE_LOAD_FINISHED,
+	STARTUP_PHASE_THEME_READY,
+	STARTUP_PHASE_FIRST_HEARTBEAT,
+	STARTUP_PHASE_COUNT,
+} StartupPhase;
+
+static const gchar *startup_phase_names[STARTUP_PHASE_COUNT] = {
+	"gtk_ready",
+	"web_view_created",
+	"load_committed",
+	"first_paint",
+	"load_finished",
+	"theme_ready",
+	"first_heartbeat",
+};
+
+static gint64 started_at;
+static gint64 startup_phases[STARTUP_PHASE_COUNT];
+
+static gboolean metrics_socket;
+
+/* Input-to-paint latency of key presses (see input-latency.h) */
+static gboolean input_latency;
+
+/* Frame pacing of the web view in debug mode (see frame-stats.h) */
+#define FRAME_STATS_PUBLISH_INTERVAL 1    /* Seconds */
+#define FRAME_STATS_LOG_INTERVAL     30   /* Seconds */
+
+static guint64 frame_stats_published;
+static guint frame_stats_ticks;
+
+/* --benchmark-theme (see theme-benchmark.h) */
+#define BENCHMARK_TIMEOUT 60   /* Seconds */
+
+static gchar *benchmark_theme;
+static gint benchmark_iterations = 1;
+static gchar *benchmark_config;
+static gboolean benchmark_finishing;
+static gboolean benchmark_failed;
+
+static const GOptionEntry option_entries[] = {
+	{
+		"benchmark-theme", 0, 0, G_OPTION_ARG_STRING, &benchmark_theme,
+		"Load THEME with the mock backend, print how long it took and what it cost, then exit", "THEME"
+	},
+	{
+		"iterations", 0, 0, G_OPTION_ARG_INT, &benchmark_iterations,
+		"Benchmark the theme N times, each in a new greeter process, and print a summary", "N"
+	},
+	{NULL}};
+
+static GHashTable *ui_message_handlers_table;
 
 
 static void
 initialize_web_extensions_cb(WebKitWebContext *context, gpointer user_data) {
-	webkit_web_context_set_web_extensions_directory(context, WEBEXT_DIR);
+	webkit_web_context_set_web_extensions_directory(context, greeter_paths_get_webext_dir());
 }
 
 
@@ -131,6 +252,13 @@ show_theme_recovery_modal() {
 		*button,
 		*button_box;
 
+	if (theme_recovery_offered) {
+		/* The dialog is already being shown */
+		return;
+	}
+
+	theme_recovery_offered = TRUE;
+
 	dialog = gtk_dialog_new_with_buttons(
 		_("Greeter Theme Error Detected"),
 		GTK_WINDOW(window),
@@ -157,6 +285,8 @@ show_theme_recovery_modal() {
 
 	gint response = gtk_dialog_run(GTK_DIALOG(dialog));
 
+	theme_recovery_offered = FALSE;
+
 	if (GTK_RESPONSE_REJECT == response) {
 		gtk_widget_destroy(dialog);
 		return;
@@ -182,10 +312,367 @@ show_theme_recovery_modal() {
 }
 
 
+static void
+startup_phase_reached(StartupPhase phase) {
+	if (0 == startup_phases[phase]) {
+		startup_phases[phase] = g_get_monotonic_time();
+		GREETER_TRACE1(startup_phase, startup_phase_names[phase]);
+	}
+}
+
+
+static void
+log_stall_histogram(void) {
+	gchar *histogram = latency_histogram_to_string(&stall_histogram);
+
+	g_message("%s", histogram);
+	g_free(histogram);
+}
+
+
+/**
+ * Offers the recovery dialog if the theme has stopped sending heartbeats.
+ */
+static gboolean
+heartbeat_watchdog_cb(gpointer user_data) {
+	gint64 silent_for = (g_get_monotonic_time() - last_heartbeat) / G_USEC_PER_SEC;
+
+	if (display_blanked) {
+		/* The theme pauses its heartbeat (and may be throttled) while blanked */
+		last_heartbeat = g_get_monotonic_time();
+		return G_SOURCE_CONTINUE;
+	}
+
+	if (silent_for < HEARTBEAT_DEAD_AFTER || theme_recovery_offered) {
+		return G_SOURCE_CONTINUE;
+	}
+
+	g_warning("[ERROR] :: Theme has not responded for %" G_GINT64_FORMAT " seconds.", silent_for);
+
+	show_theme_recovery_modal();
+
+	/* A new theme may have been loaded. Give it a full timeout before checking again. */
+	last_heartbeat = g_get_monotonic_time();
+
+	return G_SOURCE_CONTINUE;
+}
+
+
+/**
+ * Starts expecting heartbeats from the theme, the first one within HEARTBEAT_DEAD_AFTER
+ * seconds. Armed when the theme's load is committed so that a theme that hangs before
+ * its first heartbeat is caught too.
+ */
+static void
+start_heartbeat_watchdog(void) {
+	last_heartbeat = g_get_monotonic_time();
+
+	if (0 == heartbeat_watchdog_id) {
+		heartbeat_watchdog_id = g_timeout_add_seconds(
+			HEARTBEAT_CHECK_INTERVAL,
+			(GSourceFunc) heartbeat_watchdog_cb,
+			NULL
+		);
+	}
+}
+
+
+static void
+stop_heartbeat_watchdog(void) {
+	if (0 == heartbeat_watchdog_id) {
+		return;
+	}
+
+	g_source_remove(heartbeat_watchdog_id);
+	heartbeat_watchdog_id = 0;
+
+	if (debug_mode) {
+		log_stall_histogram();
+	}
+}
+
+
+/**
+ * Records a heartbeat from the theme. Heartbeats carry how late (in milliseconds) the
+ * theme's heartbeat timer fired, which is how long its main thread was busy.
+ */
+static void
+heartbeat_handler(GVariant *parameters, gpointer user_data) {
+	gint64 lag;
+
+	if (heartbeat_exited) {
+		return;
+	}
+
+	g_variant_get(parameters, "(x)", &lag);
+	last_heartbeat = g_get_monotonic_time();
+
+	startup_phase_reached(STARTUP_PHASE_FIRST_HEARTBEAT);
+	latency_histogram_add(&stall_histogram, lag);
+
+	if (lag >= HEARTBEAT_STALL_THRESHOLD) {
+		theme_stalls++;
+		g_warning("Theme main thread stalled for %" G_GINT64_FORMAT " ms", lag);
+	}
+
+}
+
+
+static void
+session_starting_handler(GVariant *parameters, gpointer user_data) {
+	/* The theme will go away, stop expecting heartbeats from it. */
+	heartbeat_exited = TRUE;
+	stop_heartbeat_watchdog();
+
+	if (input_latency) {
+		gchar *summary = input_latency_to_string();
+
+		g_message("%s", summary);
+		g_free(summary);
+	}
+
+	if (debug_mode) {
+		gchar *summary = frame_stats_to_string();
+
+		g_message("%s", summary);
+		g_free(summary);
+	}
+}
+
+
+/**
+ * start_session() failed or the mock backend only pretended. The theme is still there,
+ * keep watching it.
+ */
+static void
+session_not_started_handler(GVariant *parameters, gpointer user_data) {
+	heartbeat_exited = FALSE;
+	start_heartbeat_watchdog();
+}
+
+
+/**
+ * Stops rendering the theme and unpins our memory (see mlockall() in main), which the
+ * session wants more than we do. The window stays up (black) so the screen doesn't flash
+ * while the session starts.
+ *
+ * The web process is left alone: it holds our connection to the daemon, which should
+ * see the greeter go away only when it stops us (see quit_cb()).
+ */
+static gboolean
+release_web_view_cb(gpointer user_data) {
+	gtk_widget_hide(web_view);
+	munlockall();
+
+	return G_SOURCE_REMOVE;
+}
+
+
+/**
+ * The session is starting and LightDM will stop us shortly. This runs inside the web
+ * view's own signal emission, so the web view is let go of from an idle callback.
+ */
+static void
+session_started_handler(GVariant *parameters, gpointer user_data) {
+	session_started_at = g_get_monotonic_time();
+
+	g_idle_add(release_web_view_cb, NULL);
+}
+
+
+/**
+ * Handles an uncaught error or unhandled promise rejection reported by ThemeErrorReporter.js.
+ */
+static void
+theme_error_handler(GVariant *parameters, gpointer user_data) {
+	const gchar *kind, *message, *source, *stack;
+	gint line, column;
+
+	g_variant_get(parameters, "(&s&s&s&sii)", &kind, &message, &source, &stack, &line, &column);
+	theme_errors++;
+
+	g_warning(
+		"[ERROR] :: Theme %s: %s (%s:%d:%d)%s%s",
+		kind, message, source, line, column,
+		('\0' != *stack) ? "\n" : "",
+		stack
+	);
+
+	if (detect_theme_errors) {
+		show_theme_recovery_modal();
+	}
+}
+
+
+static gdouble
+startup_phase_ms(StartupPhase phase) {
+	return (gdouble) (startup_phases[phase] - started_at) / 1000;
+}
+
+
+/**
+ * Prints the results of --benchmark-theme and quits. `web_stats` is the web process's
+ * share (GREETER_MESSAGE_BENCHMARK_TYPE) or NULL.
+ */
+static void
+benchmark_finish(GVariant *web_stats) {
+	gint64 js_heap;
+	guint64 dom_nodes, requests, bytes_read, web_rss;
+
+	theme_benchmark_report(THEME_BENCHMARK_FIRST_PAINT, startup_phase_ms(STARTUP_PHASE_FIRST_PAINT));
+	theme_benchmark_report(THEME_BENCHMARK_THEME_READY, startup_phase_ms(STARTUP_PHASE_THEME_READY));
+
+	if (NULL != web_stats) {
+		g_variant_get(web_stats, "(xtttt)", &js_heap, &dom_nodes, &requests, &bytes_read, &web_rss);
+
+		theme_benchmark_report(THEME_BENCHMARK_JS_HEAP, js_heap);
+		theme_benchmark_report(THEME_BENCHMARK_DOM_NODES, dom_nodes);
+		theme_benchmark_report(THEME_BENCHMARK_REQUESTS, requests);
+		theme_benchmark_report(THEME_BENCHMARK_BYTES_READ, bytes_read);
+		theme_benchmark_report(THEME_BENCHMARK_WEB_RSS, web_rss);
+	}
+
+	gtk_main_quit();
+}
+
+
+#ifdef HAS_WEBKITGTK_2_28
+static void
+benchmark_web_stats_received_cb(GObject *object, GAsyncResult *result, gpointer user_data) {
+	WebKitUserMessage *reply;
+	GVariant *parameters = NULL;
+	GError *err = NULL;
+
+	reply = webkit_web_view_send_message_to_page_finish(WEBKIT_WEB_VIEW(object), result, &err);
+
+	if (NULL == reply) {
+		g_warning("No benchmark results from the web process: %s", err->message);
+		g_error_free(err);
+
+	} else {
+		parameters = webkit_user_message_get_parameters(reply);
+
+		if (NULL != parameters && ! g_variant_is_of_type(parameters, G_VARIANT_TYPE(GREETER_MESSAGE_BENCHMARK_TYPE))) {
+			parameters = NULL;
+		}
+	}
+
+	benchmark_finish(parameters);
+	g_clear_object(&reply);
+}
+#endif
+
+
+/**
+ * Once the benchmarked theme has painted and is ready, the web process is asked for its
+ * share of the results (WebKitGTK 2.28+).
+ */
+static void
+benchmark_maybe_finish(void) {
+	if (NULL == benchmark_theme
+			|| benchmark_finishing
+			|| 0 == startup_phases[STARTUP_PHASE_FIRST_PAINT]
+			|| 0 == startup_phases[STARTUP_PHASE_THEME_READY]) {
+		return;
+	}
+
+	benchmark_finishing = TRUE;
+
+	#ifdef HAS_WEBKITGTK_2_28
+	webkit_web_view_send_message_to_page(
+		WEBKIT_WEB_VIEW(web_view),
+		webkit_user_message_new(GREETER_MESSAGE_BENCHMARK_REQUEST, g_variant_new("()")),
+		NULL,
+		benchmark_web_stats_received_cb,
+		NULL
+	);
+	#else
+	benchmark_finish(NULL);
+	#endif
+}
+
+
+static gboolean
+benchmark_timeout_cb(gpointer user_data) {
+	g_printerr("Theme %s was not ready after %d seconds\n", benchmark_theme, BENCHMARK_TIMEOUT);
+	benchmark_failed = TRUE;
+	gtk_main_quit();
+
+	return G_SOURCE_REMOVE;
+}
+
+
+static void
+theme_ready_handler(GVariant *parameters, gpointer user_data) {
+	startup_phase_reached(STARTUP_PHASE_THEME_READY);
+	benchmark_maybe_finish();
+}
+
+
+static void
+lock_hint_handler(GVariant *parameters, gpointer user_data) {
+	lock_hint_enabled_handler();
+}
+
+
+static const GreeterMessageHandler ui_message_handlers[] = {
+	{GREETER_MESSAGE_HEARTBEAT,           GREETER_MESSAGE_HEARTBEAT_TYPE,           heartbeat_handler},
+	{GREETER_MESSAGE_LOCK_HINT,           GREETER_MESSAGE_LOCK_HINT_TYPE,           lock_hint_handler},
+	{GREETER_MESSAGE_SESSION_NOT_STARTED, GREETER_MESSAGE_SESSION_NOT_STARTED_TYPE, session_not_started_handler},
+	{GREETER_MESSAGE_SESSION_STARTED,     GREETER_MESSAGE_SESSION_STARTED_TYPE,     session_started_handler},
+	{GREETER_MESSAGE_SESSION_STARTING,    GREETER_MESSAGE_SESSION_STARTING_TYPE,    session_starting_handler},
+	{GREETER_MESSAGE_THEME_ERROR,         GREETER_MESSAGE_THEME_ERROR_TYPE,         theme_error_handler},
+	{GREETER_MESSAGE_THEME_READY,         GREETER_MESSAGE_THEME_READY_TYPE,         theme_ready_handler},
+	{NULL,                                NULL,                                     NULL}};
+
+
+/**
+ * Sends a message to the web extension. A floating `parameters` reference is consumed.
+ */
+static void
+send_message_to_web_process(const gchar *name, GVariant *parameters) {
+	#ifdef HAS_WEBKITGTK_2_28
+	webkit_web_view_send_message_to_page(
+		WEBKIT_WEB_VIEW(web_view),
+		webkit_user_message_new(name, parameters),
+		NULL,
+		NULL,
+		NULL
+	);
+	#else
+	/* Only webkit2gtk 2.28+ can send messages to the web process, main() warned about it. */
+	g_debug("Dropping message to web process: %s", name);
+	g_variant_unref(g_variant_ref_sink(parameters));
+	#endif
+}
+
+
+#ifdef HAS_WEBKITGTK_2_28
+/**
+ * User message received callback.
+ *
+ * Receives typed messages from our web extension process and dispatches them.
+ */
+static gboolean
+user_message_received_cb(WebKitWebView *view,
+						 WebKitUserMessage *message,
+						 gpointer user_data) {
+
+	return greeter_message_dispatch(
+		ui_message_handlers_table,
+		webkit_user_message_get_name(message),
+		webkit_user_message_get_parameters(message),
+		NULL
+	);
+}
+#endif
+
+
 /**
  * Message received callback.
  *
- * Receives messages from our web extension process and calls appropriate handlers.
+ * Receives serialized messages from our web extension process (webkit2gtk < 2.28)
+ * and dispatches them.
  *
  * @param manager   The user content manager instance that was created in #main.
  * @param message   The message sent from web extension process.
@@ -205,34 +692,464 @@ message_received_cb(WebKitUserContentManager *manager,
 	context = webkit_javascript_result_get_global_context(message);
 	message_val = webkit_javascript_result_get_value(message);
 
-	if (JSValueIsString(context, message_val)) {
-		js_str_val = JSValueToStringCopy(context, message_val, NULL);
-		message_str_length = JSStringGetMaximumUTF8CStringSize(js_str_val);
-		message_str = (gchar *)g_malloc (message_str_length);
-		JSStringGetUTF8CString(js_str_val, message_str, message_str_length);
-		JSStringRelease(js_str_val);
+	if (! JSValueIsString(context, message_val)) {
+		g_warning("UI PROCESS - message_received_cb(): unexpected message type");
+		return;
+	}
+
+	js_str_val = JSValueToStringCopy(context, message_val, NULL);
+	message_str_length = JSStringGetMaximumUTF8CStringSize(js_str_val);
+	message_str = (gchar *)g_malloc (message_str_length);
+	JSStringGetUTF8CString(js_str_val, message_str, message_str_length);
+	JSStringRelease(js_str_val);
+
+	greeter_message_dispatch_serialized(ui_message_handlers_table, message_str, NULL);
+
+	g_free(message_str);
+}
+
+
+/*
+ * The first frame drawn once the theme's load was committed, ie: the first one that can
+ * show the theme instead of the background color.
+ */
+static gboolean
+first_paint_cb(GtkWidget *widget, cairo_t *cr, gpointer user_data) {
+	if (0 != startup_phases[STARTUP_PHASE_LOAD_COMMITTED]) {
+		startup_phase_reached(STARTUP_PHASE_FIRST_PAINT);
+		g_signal_handlers_disconnect_by_func(widget, first_paint_cb, user_data);
+		benchmark_maybe_finish();
+	}
+
+	return FALSE;
+}
+
+
+static void
+load_changed_cb(WebKitWebView *view, WebKitLoadEvent load_event, gpointer user_data) {
+	if (WEBKIT_LOAD_COMMITTED == load_event) {
+		startup_phase_reached(STARTUP_PHASE_LOAD_COMMITTED);
+
+		if (! heartbeat_exited) {
+			start_heartbeat_watchdog();
+		}
+
+	} else if (WEBKIT_LOAD_FINISHED == load_event) {
+		startup_phase_reached(STARTUP_PHASE_LOAD_FINISHED);
+	}
+}
+
+
+/**
+ * Appends the UI process's share of the metrics socket to `text`.
+ */
+static void
+append_ui_metrics(GString *text) {
+	gchar *labels;
+	guint i;
+
+	metrics_text_append_family(
+		text,
+		"greeter_startup_phase_seconds",
+		"gauge",
+		"Seconds from the start of the UI process until each startup phase was reached."
+	);
+
+	for (i = 0; i < STARTUP_PHASE_COUNT; i++) {
+		if (0 == startup_phases[i]) {
+			continue;
+		}
+
+		labels = g_strdup_printf("phase=\"%s\"", startup_phase_names[i]);
+		metrics_text_append_value(
+			text,
+			"greeter_startup_phase_seconds",
+			labels,
+			(gdouble) (startup_phases[i] - started_at) / G_USEC_PER_SEC
+		);
+		g_free(labels);
+	}
+
+	metrics_text_append_family(text, "greeter_ui_process_resident_bytes", "gauge", "Resident set size of the UI process.");
+	metrics_text_append_value(text, "greeter_ui_process_resident_bytes", NULL, process_stats_get_resident_bytes());
+
+	metrics_text_append_family(text, "greeter_display_blanked", "gauge", "Whether the display is blanked.");
+	metrics_text_append_value(text, "greeter_display_blanked", NULL, display_blanked);
+
+	metrics_text_append_family(text, "greeter_theme_errors_total", "counter", "Uncaught theme errors and unhandled rejections.");
+	metrics_text_append_value(text, "greeter_theme_errors_total", NULL, theme_errors);
+
+	metrics_text_append_family(text, "greeter_theme_stalls_total", "counter", "Theme main thread stalls reported by its heartbeat.");
+	metrics_text_append_value(text, "greeter_theme_stalls_total", NULL, theme_stalls);
+
+	metrics_text_append_family(
+		text,
+		"greeter_theme_event_loop_lag_seconds",
+		"histogram",
+		"How late the theme's heartbeat timer fired."
+	);
+	metrics_text_append_histogram(text, "greeter_theme_event_loop_lag_seconds", NULL, &stall_histogram);
+
+	input_latency_append_metrics(text);
+	frame_stats_append_metrics(text);
+}
+
+
+#ifdef HAS_WEBKITGTK_2_28
+static void
+web_metrics_received_cb(GObject *object, GAsyncResult *result, gpointer user_data) {
+	MetricsRequest *request = user_data;
+	WebKitUserMessage *reply;
+	GVariant *parameters;
+	const gchar *web_metrics;
+	GError *err = NULL;
+
+	reply = webkit_web_view_send_message_to_page_finish(WEBKIT_WEB_VIEW(object), result, &err);
+
+	if (NULL == reply) {
+		g_debug("No metrics from the web process: %s", err->message);
+		g_error_free(err);
 
 	} else {
-		message_str = "";
-		printf("Error running javascript: unexpected return value");
+		parameters = webkit_user_message_get_parameters(reply);
+
+		if (NULL != parameters && g_variant_is_of_type(parameters, G_VARIANT_TYPE(GREETER_MESSAGE_METRICS_TYPE))) {
+			g_variant_get(parameters, "(&s)", &web_metrics);
+			g_string_append(metrics_request_get_text(request), web_metrics);
+		}
+
+		g_object_unref(reply);
 	}
 
-	if (0 == g_strcmp0(message_str, "JavaScriptException")) {
-		show_theme_recovery_modal();
+	metrics_request_finish(request);
+}
+#endif
+
 
-	} else if (0 == g_strcmp0(message_str, "LockHint")) {
-		lock_hint_enabled_handler();
+/**
+ * Someone connected to the metrics socket. Only now are the metrics gathered, the web
+ * process is asked for its share (WebKitGTK 2.28+).
+ */
+static void
+collect_metrics_cb(MetricsRequest *request) {
+	append_ui_metrics(metrics_request_get_text(request));
+
+	#ifdef HAS_WEBKITGTK_2_28
+	webkit_web_view_send_message_to_page(
+		WEBKIT_WEB_VIEW(web_view),
+		webkit_user_message_new(GREETER_MESSAGE_METRICS_REQUEST, g_variant_new("()")),
+		NULL,
+		web_metrics_received_cb,
+		request
+	);
+	#else
+	metrics_request_finish(request);
+	#endif
+}
+
+
+/**
+ * Keeps the window on the primary monitor and tells the theme when its geometry changes.
+ */
+static void
+monitors_changed_cb(GdkScreen *screen, gpointer user_data) {
+	GdkRectangle geometry;
+
+	#ifdef HAS_GTK_3_22
+		GdkMonitor *monitor = gdk_display_get_primary_monitor(default_display);
+
+		if (NULL == monitor) {
+			monitor = gdk_display_get_monitor(default_display, 0);
+		}
+
+		gdk_monitor_get_geometry(monitor, &geometry);
+	#else
+		gdk_screen_get_monitor_geometry(screen, gdk_screen_get_primary_monitor(screen), &geometry);
+	#endif
+
+	gtk_window_resize(GTK_WINDOW(window), geometry.width, geometry.height);
+	gtk_window_move(GTK_WINDOW(window), geometry.x, geometry.y);
 
+	send_message_to_web_process(
+		GREETER_MESSAGE_MONITOR_GEOMETRY,
+		g_variant_new("(iiii)", geometry.x, geometry.y, geometry.width, geometry.height)
+	);
+}
+
+
+/**
+ * Hands the frame pacing to the web extension (__GreeterBridge.frame_stats()) whenever the
+ * web view drew since the last time. It is logged after every FRAME_STATS_LOG_INTERVAL
+ * such seconds, so an idle theme doesn't fill the log.
+ */
+static gboolean
+frame_stats_cb(gpointer user_data) {
+	FrameStatsSummary summary;
+
+	frame_stats_get_summary(&summary);
+
+	if (summary.frames == frame_stats_published) {
+		return G_SOURCE_CONTINUE;
+	}
+
+	send_message_to_web_process(
+		GREETER_MESSAGE_FRAME_STATS,
+		g_variant_new(
+			GREETER_MESSAGE_FRAME_STATS_TYPE,
+			summary.frames,
+			summary.animations,
+			summary.long_frames,
+			summary.dropped_frames,
+			summary.refresh_interval,
+			summary.mean_interval,
+			summary.p50_interval,
+			summary.p95_interval,
+			summary.p99_interval,
+			summary.max_interval
+		)
+	);
+
+	frame_stats_published = summary.frames;
+	frame_stats_ticks += FRAME_STATS_PUBLISH_INTERVAL;
+
+	if (frame_stats_ticks >= FRAME_STATS_LOG_INTERVAL) {
+		gchar *text = frame_stats_to_string();
+
+		g_message("%s", text);
+		g_free(text);
+		frame_stats_ticks = 0;
+	}
+
+	return G_SOURCE_CONTINUE;
+}
+
+
+static void
+wake_frame_painted_cb(GdkFrameClock *frame_clock, gpointer user_data) {
+	gdouble latency = (g_get_monotonic_time() - unblanked_at) / 1000.0;
+
+	g_signal_handlers_disconnect_by_func(frame_clock, wake_frame_painted_cb, user_data);
+
+	if (debug_mode) {
+		g_message("Low-power mode: wake-to-frame latency %.1f ms", latency);
 	} else {
-		printf("UI PROCESS - message_received_cb(): no match!");
+		g_debug("Low-power mode: wake-to-frame latency %.1f ms", latency);
 	}
+}
 
-	g_free(message_str);
+
+/**
+ * Stops rendering the theme while nobody can see it. A hidden web view makes WebKit
+ * treat the page as hidden: requestAnimationFrame() stops, CSS animations are paused
+ * and DOM timers are throttled.
+ */
+static void
+enter_low_power_mode(void) {
+	gtk_widget_hide(web_view);
+}
+
+
+static void
+leave_low_power_mode(void) {
+	GdkFrameClock *frame_clock = gtk_widget_get_frame_clock(window);
+
+	if (0 != session_started_at) {
+		/* Stays hidden, see release_web_view_cb() */
+		return;
+	}
+
+	unblanked_at = g_get_monotonic_time();
+
+	gtk_widget_show(web_view);
+	gtk_widget_grab_focus(GTK_WIDGET(web_view));
+
+	if (NULL != frame_clock) {
+		g_signal_connect(frame_clock, "after-paint", G_CALLBACK(wake_frame_painted_cb), NULL);
+	}
+}
+
+
+/*
+ * DPMS is only polled while finding it off would change something: in low-power mode
+ * and while the display isn't known to be blanked already.
+ */
+static void
+update_dpms_polling(void) {
+	#ifdef HAS_DPMS
+	gboolean poll = dpms_capable && low_power_mode && ! display_blanked;
+
+	if (poll && 0 == dpms_check_id) {
+		dpms_check_id = g_timeout_add_seconds(DPMS_CHECK_INTERVAL, (GSourceFunc) dpms_check_cb, NULL);
+
+	} else if (! poll && 0 != dpms_check_id) {
+		g_source_remove(dpms_check_id);
+		dpms_check_id = 0;
+	}
+	#endif
+}
+
+
+static void
+set_display_blanked(gboolean blanked) {
+	if (blanked == display_blanked) {
+		return;
+	}
+
+	if (debug_mode) {
+		g_message(
+			"UI process: %.1f wakeups/minute while %s (low-power mode %s)",
+			wakeup_counter_per_minute(&wakeup_counter),
+			display_blanked ? "blanked" : "unblanked",
+			low_power_mode ? "on" : "off"
+		);
+	}
+
+	wakeup_counter_start(&wakeup_counter);
+	display_blanked = blanked;
+	g_debug("Display %s", blanked ? "blanked" : "unblanked");
+
+	send_message_to_web_process(GREETER_MESSAGE_DISPLAY_BLANKED, g_variant_new("(b)", blanked));
+	update_dpms_polling();
+
+	if (! low_power_mode) {
+		return;
+	}
+
+	if (blanked) {
+		enter_low_power_mode();
+	} else {
+		leave_low_power_mode();
+	}
+}
+
+
+static void
+update_display_blanked(void) {
+	set_display_blanked(screensaver_active || dpms_off);
+}
+
+
+#ifdef HAS_XSS
+static GdkFilterReturn
+screensaver_event_filter(GdkXEvent *xevent, GdkEvent *event, gpointer user_data) {
+	XScreenSaverNotifyEvent *notify = (XScreenSaverNotifyEvent *) xevent;
+
+	if (screensaver_event_base + ScreenSaverNotify == notify->type) {
+		screensaver_active = (ScreenSaverOff != notify->state);
+		update_display_blanked();
+	}
+
+	return GDK_FILTER_CONTINUE;
+}
+#endif
+
+
+#ifdef HAS_DPMS
+/**
+ * DPMS has no events, so its state is polled (see update_dpms_polling()). Waking up is
+ * handled by window_input_cb() so that it doesn't have to wait for the next poll.
+ */
+static gboolean
+dpms_check_cb(gpointer user_data) {
+	Display *display = gdk_x11_display_get_xdisplay(default_display);
+	CARD16 power_level;
+	BOOL enabled;
+
+	if (DPMSInfo(display, &power_level, &enabled)) {
+		dpms_off = enabled && DPMSModeOn != power_level;
+		update_display_blanked();
+	}
+
+	/* Blanking stopped the polling */
+	return (0 != dpms_check_id) ? G_SOURCE_CONTINUE : G_SOURCE_REMOVE;
+}
+#endif
+
+
+static gboolean
+window_input_cb(GtkWidget *widget, GdkEvent *event, gpointer user_data) {
+	if (! dpms_off) {
+		return FALSE;
+	}
+
+	switch (event->type) {
+		case GDK_KEY_PRESS:
+		case GDK_BUTTON_PRESS:
+		case GDK_MOTION_NOTIFY:
+			dpms_off = FALSE;
+			update_display_blanked();
+			break;
+		default:
+			break;
+	}
+
+	return FALSE;
+}
+
+
+/**
+ * Tracks whether the X screensaver or DPMS has blanked the display so the web extension
+ * can stop waking the theme up for things nobody can see.
+ */
+static void
+watch_screensaver(void) {
+	#if defined(HAS_XSS) || defined(HAS_DPMS)
+	Display *display = gdk_x11_display_get_xdisplay(default_display);
+	int error_base;
+	#endif
+
+	#ifdef HAS_DPMS
+	int event_base;
+	#endif
+
+	#ifdef HAS_XSS
+	if (XScreenSaverQueryExtension(display, &screensaver_event_base, &error_base)) {
+		XScreenSaverSelectInput(display, DefaultRootWindow(display), ScreenSaverNotifyMask);
+		gdk_window_add_filter(NULL, screensaver_event_filter, NULL);
+	} else {
+		g_debug("MIT-SCREEN-SAVER extension not available, not watching the screensaver.");
+	}
+	#endif
+
+	#ifdef HAS_DPMS
+	if (DPMSQueryExtension(display, &event_base, &error_base) && DPMSCapable(display)) {
+		dpms_capable = TRUE;
+		update_dpms_polling();
+	} else {
+		g_debug("DPMS not available, not watching the display's power level.");
+	}
+	#endif
+
+	g_signal_connect(window, "event", G_CALLBACK(window_input_cb), NULL);
+	wakeup_counter_start(&wakeup_counter);
+}
+
+
+/**
+ * Asks the web extension (and through it the theme) to reload the config file.
+ */
+static gboolean
+config_reload_cb(gpointer user_data) {
+	send_message_to_web_process(GREETER_MESSAGE_CONFIG_RELOAD, g_variant_new("()"));
+
+	return G_SOURCE_CONTINUE;
 }
 
 
 static void
 quit_cb(void) {
+	stop_heartbeat_watchdog();
+	metrics_server_stop();
+
+	if (0 != session_started_at) {
+		/* Nothing left worth tearing down, the session wants the display */
+		g_message(
+			"Exiting %" G_GINT64_FORMAT " ms after the session started",
+			(g_get_monotonic_time() - session_started_at) / 1000
+		);
+		_exit(EXIT_SUCCESS);
+	}
+
 	gtk_widget_destroy(window);
 	gtk_main_quit();
 }
@@ -336,6 +1253,7 @@ main(int argc, char **argv) {
 	GdkWindow *root_window;
 	GdkRectangle geometry;
 	GKeyFile *keyfile;
+	GOptionContext *options;
 	gchar *theme;
 	GError *err = NULL;
 	GdkRGBA bg_color;
@@ -343,6 +1261,27 @@ main(int argc, char **argv) {
 	GtkCssProvider *css_provider;
 	WebKitCookieManager *cookie_manager;
 
+	started_at = g_get_monotonic_time();
+	GREETER_TRACE1(startup_phase, "main");
+
+	options = g_option_context_new(NULL);
+	g_option_context_add_main_entries(options, option_entries, GETTEXT_PACKAGE);
+	g_option_context_add_group(options, gtk_get_option_group(FALSE));
+
+	if (! g_option_context_parse(options, &argc, &argv, &err)) {
+		g_printerr("%s\n", err->message);
+		return EXIT_FAILURE;
+	}
+
+	g_option_context_free(options);
+
+	if (NULL != benchmark_theme && benchmark_iterations > 1) {
+		/* Every iteration is a greeter process of its own, nothing to set up here */
+		return theme_benchmark_run_iterations(argv[0], benchmark_theme, benchmark_iterations)
+			? EXIT_SUCCESS
+			: EXIT_FAILURE;
+	}
+
 	/* Prevent memory from being swapped out, since we see unencrypted passwords. */
 	mlockall (MCL_CURRENT | MCL_FUTURE);
 
@@ -360,6 +1299,7 @@ main(int argc, char **argv) {
 	textdomain(GETTEXT_PACKAGE);
 
 	gtk_init(&argc, &argv);
+	startup_phase_reached(STARTUP_PHASE_GTK_READY);
 
 	g_unix_signal_add(SIGTERM, (GSourceFunc) quit_cb, NULL);
 	g_unix_signal_add(SIGINT, (GSourceFunc) quit_cb, NULL);
@@ -370,11 +1310,23 @@ main(int argc, char **argv) {
 
 	g_key_file_load_from_file(
 		keyfile,
-		CONFIG_DIR "/lightdm-webkit2-greeter.conf",
+		greeter_paths_get_config_file(),
 		G_KEY_FILE_NONE,
 		NULL
 	);
 
+	if (NULL != benchmark_theme) {
+		benchmark_config = theme_benchmark_write_config(keyfile, benchmark_theme, &err);
+
+		if (NULL == benchmark_config) {
+			g_printerr("Unable to write the benchmark's config file: %s\n", err->message);
+			return EXIT_FAILURE;
+		}
+
+		/* The web extension reads the config file itself */
+		g_setenv(GREETER_CONFIG_FILE_ENV, benchmark_config, TRUE);
+	}
+
 	/* TODO: Handle config values and fallbacks some other way, this is garbage! */
 	theme = g_key_file_get_string(keyfile, "greeter", "webkit_theme", &err);
 
@@ -403,10 +1355,39 @@ main(int argc, char **argv) {
 
 	debug_mode = g_key_file_get_boolean(keyfile, "greeter", "debug_mode", NULL);
 
+	detect_theme_errors = g_key_file_get_boolean(keyfile, "greeter", "detect_theme_errors", &err);
+
+	if ( NULL != err) {
+		g_clear_error(&err);
+		detect_theme_errors = TRUE;
+	}
+
+	low_power_mode = g_key_file_get_boolean(keyfile, "greeter", "low_power_mode", &err);
+
+	if ( NULL != err) {
+		g_clear_error(&err);
+		low_power_mode = TRUE;
+	}
+
+	metrics_socket = g_key_file_get_boolean(keyfile, "greeter", "metrics_socket", NULL);
+	input_latency = g_key_file_get_boolean(keyfile, "greeter", "input_latency", NULL);
+
 	if ( NULL != err) {
 		g_clear_error(&err);
 		debug_mode = FALSE;
 	}
+
+	#ifndef HAS_WEBKITGTK_2_28
+	/* See send_message_to_web_process() */
+	g_warning(
+		"WebKitGTK %u.%u can't send messages to the web extension (2.28 can). Config reloads, "
+		"stopping the clock while the display is blanked, monitor changes and the web process's "
+		"metrics and benchmark results are unavailable, metrics_socket is disabled.",
+		webkit_get_major_version(),
+		webkit_get_minor_version()
+	);
+	metrics_socket = FALSE;
+	#endif
 	/* END Greeter Config File */
 
 	/* Set default cursor */
@@ -420,6 +1401,7 @@ main(int argc, char **argv) {
 	screen = gtk_window_get_screen(GTK_WINDOW(window));
 
 	gtk_window_set_decorated(GTK_WINDOW(window), FALSE);
+	gtk_widget_add_events(window, GDK_KEY_PRESS_MASK | GDK_BUTTON_PRESS_MASK | GDK_POINTER_MOTION_MASK);
 
 	#ifdef HAS_GTK_3_22
 		GdkMonitor *monitor = gdk_display_get_primary_monitor(default_display);
@@ -460,6 +1442,7 @@ main(int argc, char **argv) {
 	webkit_cookie_manager_set_accept_policy(cookie_manager, WEBKIT_COOKIE_POLICY_ACCEPT_ALWAYS);
 
 	/* Register and connect handler of any messages we send from our web extension process. */
+	ui_message_handlers_table = greeter_message_table_new(ui_message_handlers);
 	manager = webkit_user_content_manager_new();
 	g_signal_connect(manager, "script-message-received::GreeterBridge", G_CALLBACK(message_received_cb), NULL);
 	webkit_user_content_manager_register_script_message_handler(manager, "GreeterBridge");
@@ -468,6 +1451,9 @@ main(int argc, char **argv) {
 
 	/* Create the web_view */
 	web_view = webkit_web_view_new_with_user_content_manager(manager);
+	startup_phase_reached(STARTUP_PHASE_WEB_VIEW_CREATED);
+	g_signal_connect(WEBKIT_WEB_VIEW(web_view), "load-changed", G_CALLBACK(load_changed_cb), NULL);
+	g_signal_connect_after(web_view, "draw", G_CALLBACK(first_paint_cb), NULL);
 
 	/* Set the web_view's settings. */
 	create_new_webkit_settings_object();
@@ -479,11 +1465,34 @@ main(int argc, char **argv) {
 	gdk_rgba_parse(&bg_color, "#000000");
 	webkit_web_view_set_background_color(WEBKIT_WEB_VIEW(web_view), gdk_rgba_copy(&bg_color));
 
+	#ifdef HAS_WEBKITGTK_2_28
+	g_signal_connect(WEBKIT_WEB_VIEW(web_view), "user-message-received", G_CALLBACK(user_message_received_cb), NULL);
+	#endif
+
+	g_signal_connect(screen, "monitors-changed", G_CALLBACK(monitors_changed_cb), NULL);
+	g_unix_signal_add(SIGUSR1, (GSourceFunc) config_reload_cb, NULL);
+	watch_screensaver();
+
 	/* Maybe disable the context (right-click) menu. */
 	g_signal_connect(WEBKIT_WEB_VIEW(web_view), "context-menu", G_CALLBACK(context_menu_cb), NULL);
 
-	/* Register callback to check if theme loaded successfully */
-	g_timeout_add_seconds(10, (GSourceFunc) maybe_show_theme_fallback_dialog, NULL);
+	if (metrics_socket) {
+		gchar *path = greeter_paths_get_metrics_socket();
+
+		if (! metrics_server_start(path, collect_metrics_cb, &err)) {
+			g_warning("Unable to serve metrics on %s: %s", path, err->message);
+			g_clear_error(&err);
+		}
+
+		g_free(path);
+	}
+
+	if (NULL != benchmark_theme) {
+		g_timeout_add_seconds(BENCHMARK_TIMEOUT, benchmark_timeout_cb, NULL);
+	} else {
+		/* Register callback to check if theme loaded successfully */
+		g_timeout_add_seconds(10, (GSourceFunc) maybe_show_theme_fallback_dialog, NULL);
+	}
 
 	/* There's no turning back now, let's go! */
 	gtk_container_add(GTK_CONTAINER(window), web_view);
@@ -494,9 +1503,23 @@ main(int argc, char **argv) {
 	gtk_widget_set_can_focus(GTK_WIDGET(web_view), TRUE);
 	gtk_widget_grab_focus(GTK_WIDGET(web_view));
 
+	if (input_latency) {
+		input_latency_start(window, web_view);
+	}
+
+	if (debug_mode) {
+		frame_stats_start(window, web_view);
+		g_timeout_add_seconds(FRAME_STATS_PUBLISH_INTERVAL, frame_stats_cb, NULL);
+	}
+
 	g_debug("Entering Gtk loop...");
 	gtk_main();
 	g_debug("Exited Gtk loop.");
 
-	return 0;
+	if (NULL != benchmark_config) {
+		g_unlink(benchmark_config);
+		g_free(benchmark_config);
+	}
+
+	return benchmark_failed ? EXIT_FAILURE : 0;
 }
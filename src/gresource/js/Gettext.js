@@ -0,0 +1,165 @@
+/*
+ * Gettext.js
+ *
+ * Copyright © 2017 Antergos Developers <dev@antergos.com>
+ *
+ * This file is part of lightdm-webkit2-greeter.
+ *
+ * lightdm-webkit2-greeter is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * lightdm-webkit2-greeter is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * The following additional terms are in effect as per Section 7 of the license:
+ *
+ * The preservation of all legal notices and author attributions in
+ * the material or in the Appropriate Legal Notices displayed
+ * by works containing it is required.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with lightdm-webkit2-greeter; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * Translates strings for greeter themes. The translations for the active language are
+ * exported from the greeter the first time a string is translated, after which lookups
+ * happen entirely in JavaScript. The greeter will automatically create an instance when
+ * it starts. The instance can be accessed using the global variable:
+ * [`gettext`](#dl-window-gettext).
+ *
+ * @memberOf LightDM
+ */
+class Gettext {
+
+	constructor() {
+		this.reset();
+
+		window.addEventListener( 'greeter-language-changed', () => this.reset() );
+	}
+
+	/**
+	 * Translate a string.
+	 *
+	 * @arg {string} msgid The string to translate.
+	 *
+	 * @returns {string} The translated string or `msgid` if there is no translation.
+	 */
+	gettext( msgid ) {
+		let translation = this._lookup( msgid );
+
+		if ( null === translation ) {
+			return msgid;
+		}
+
+		return Array.isArray( translation ) ? translation[0] : translation;
+	}
+
+	/**
+	 * Load translations for the active language. Themes don't need to call this; it happens
+	 * automatically. It's only useful to limit the export to the strings a theme uses.
+	 *
+	 * @arg {string[]|null} msgids The strings to load or {@link null} to load all of them.
+	 */
+	load( msgids = null ) {
+		let catalog = __Gettext.export_catalog( msgids );
+
+		if ( null === catalog ) {
+			return;
+		}
+
+		if ( null === this._messages || null === msgids ) {
+			// No prototype, so msgids like "constructor" aren't mistaken for translations
+			this._messages = Object.create( null );
+		}
+
+		Object.assign( this._messages, catalog.messages );
+
+		this._complete = catalog.complete;
+		this._nplurals = catalog.nplurals;
+
+		try {
+			this._plural = new Function( 'n', `return +(${catalog.plural});` );
+		} catch( err ) {
+			this._plural = n => +(1 !== n);
+		}
+	}
+
+	/**
+	 * Translate a string that has a plural form.
+	 *
+	 * @arg {string} msgid        The singular form of the string to translate.
+	 * @arg {string} msgid_plural The plural form of the string to translate.
+	 * @arg {number} n            The number used to pick the plural form.
+	 *
+	 * @returns {string} The translated string.
+	 */
+	ngettext( msgid, msgid_plural, n ) {
+		let translation = this._lookup( msgid ),
+			index;
+
+		if ( ! Array.isArray( translation ) ) {
+			return ( 1 === n ) ? msgid : msgid_plural;
+		}
+
+		index = this._plural( n );
+
+		if ( index < 0 || index >= translation.length ) {
+			index = 0;
+		}
+
+		return translation[index];
+	}
+
+	/**
+	 * Forget loaded translations. They will be reloaded for the active language the next
+	 * time a string is translated.
+	 */
+	reset() {
+		this._messages = null;
+		this._complete = false;
+		this._nplurals = 2;
+		this._plural = n => +(1 !== n);
+	}
+
+	_lookup( msgid ) {
+		if ( null === this._messages ) {
+			this.load();
+		}
+
+		if ( null !== this._messages && msgid in this._messages ) {
+			return this._messages[msgid];
+		}
+
+		if ( ! this._complete ) {
+			// Only part of the catalog was exported; fetch this one string too.
+			this.load( [msgid] );
+
+			if ( null === this._messages ) {
+				return null;
+			}
+
+			if ( msgid in this._messages ) {
+				return this._messages[msgid];
+			}
+
+			this._messages[msgid] = null;
+		}
+
+		return null;
+	}
+}
+
+
+/**
+ * Gettext Instance - translate strings into the active language.
+ * @name gettext
+ * @type {LightDM.Gettext}
+ * @memberOf window
+ */
+window.gettext = new Gettext();
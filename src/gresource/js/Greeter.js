@@ -154,7 +154,8 @@ class Greeter {
 	get language() {}
 
 	/**
-	 * A list of languages to present to the user.
+	 * A list of languages to present to the user. It is built while the greeter starts, every
+	 * read returns a new array of the same (frozen) language objects.
 	 * @type {LightDM.Language[]}
 	 * @readonly
 	 */
@@ -210,7 +211,8 @@ class Greeter {
 	get select_user_hint() {}
 
 	/**
-	 * List of available sessions.
+	 * List of available sessions. Every read returns a new array of the same (frozen) session
+	 * objects until a session is installed or removed.
 	 * @type {LightDM.Session[]}
 	 * @readonly
 	 */
@@ -246,6 +248,19 @@ class Greeter {
 	 */
 	cancel_autologin() {}
 
+	/**
+	 * Let the greeter know that the user is likely about to log in as `username` (eg. their
+	 * entry in the user list has focus). When `speculative_authentication` is enabled in the
+	 * config file, the greeter starts that user's PAM conversation in the background so the
+	 * first prompt is ready by the time {@link LightDM.Greeter#authenticate} is called for them.
+	 *
+	 * Only call this when the user chose the entry (keyboard focus or a click), never on hover.
+	 * Every call starts a real PAM conversation and cancels the previous one, which may mean
+	 * network round trips and may count as a failed attempt with pam_faillock or pam_tally.
+	 * @arg {String} username
+	 */
+	focus_user( username ) {}
+
 	/**
 	 * Get the value of a hint.
 	 * @arg {string} name The name of the hint to get.
@@ -302,27 +317,7 @@ class Greeter {
 }
 
 
-const __lightdm = new Promise( (resolve, reject) => {
-	let waiting = 0;
-
-	const check_window_prop = () => {
-		if ( waiting > 15000 ) {
-			return reject( 'Timeout Reached!');
-		}
-
-		setTimeout( () => {
-			waiting += 1;
-
-			if ( '__LightDMGreeter' in window ) {
-				return resolve( window.__LightDMGreeter );
-			}
-
-			check_window_prop();
-		}, 0 );
-	};
-
-	check_window_prop();
-});
+const __lightdm = __greeter_ready.then( () => window.__LightDMGreeter );
 
 
 /**
@@ -339,7 +334,8 @@ __lightdm.then( result => {
 
 
 /**
- * Moment.js instance - Loaded and instantiated automatically by the greeter.
+ * Moment.js instance - Loaded automatically by the greeter the first time it is accessed.
+ * It is no longer part of the injected bundle, so themes that don't use it don't pay for it.
  * @name moment
  * @type {object}
  * @version 2.17.0
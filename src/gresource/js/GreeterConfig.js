@@ -30,12 +30,12 @@ let _branding = null,
 	_greeter = null;
 
 
-function set_values( defaults, target_obj, method ) {
+function set_values( defaults, target_obj, method, section = 'greeter' ) {
 	let keys = Object.keys(defaults);
 
 	keys.forEach( prop => {
 		try {
-			target_obj[prop] = method( 'greeter', prop );
+			target_obj[prop] = method( section, prop );
 		} catch(err) {
 			target_obj[prop] = defaults[prop];
 		}
@@ -52,10 +52,20 @@ function set_values( defaults, target_obj, method ) {
  * @memberOf LightDM
  */
 class GreeterConfig  {
+
+	constructor() {
+		// The greeter asks us to forget cached values when its config file is reloaded.
+		window.addEventListener( 'greeter-config-reload', () => {
+			_branding = null;
+			_greeter = null;
+		} );
+	}
 	/**
 	 * Holds keys/values from the `branding` section of the config file.
 	 *
 	 * @type {object} branding
+	 * @prop {number} background_interval Seconds between images of background slideshows,
+	 *                                    `0` to not change them. See {@link LightDM.Slideshow}.
 	 * @prop {string} background_images Path to directory that contains background images
 	 *                                  for use in greeter themes.
 	 * @prop {string} logo              Path to distro logo image for use in greeter themes.
@@ -70,11 +80,13 @@ class GreeterConfig  {
 					'background_images': '/usr/share/backgrounds',
 					'logo': `${theme_dir}/img/antergos-logo-user.png`,
 					'user_image': `${theme_dir}/img/antergos.png`
-			};
+			},
+				numbers = {'background_interval': 0};
 
 			_branding = {};
 
-			set_values( props, _branding, this.get_str );
+			set_values( props, _branding, this.get_str, 'branding' );
+			set_values( numbers, _branding, this.get_num, 'branding' );
 		}
 
 		return _branding;
@@ -84,11 +96,17 @@ class GreeterConfig  {
 	 * Holds keys/values from the `greeter` section of the config file.
 	 *
 	 * @type {object}  greeter
+	 * @prop {number}  clock_tick_interval Seconds between `greeter-clock-tick` events.
 	 * @prop {boolean} debug_mode          Greeter theme debug mode.
 	 * @prop {boolean} detect_theme_errors Provide an option to load a fallback theme when theme
 	 *                                     errors are detected.
+	 * @prop {boolean} input_latency       Log the input-to-paint latency of key presses.
+	 * @prop {boolean} low_power_mode      Stop rendering the theme while the display is blanked.
+	 * @prop {boolean} metrics_socket      Serve Prometheus metrics on a Unix socket.
+	 * @prop {boolean} mock_backend        Serve made-up users and sessions instead of LightDM's.
 	 * @prop {number}  screensaver_timeout Blank the screen after this many seconds of inactivity.
 	 * @prop {boolean} secure_mode         Don't allow themes to make remote http requests.
+	 * @prop {boolean} speculative_authentication Start the likely user's PAM conversation early.
 	 * @prop {string}  time_format         A moment.js format string to be used by the greeter to
 	 *                                     generate localized time for display.
 	 * @prop {string}  time_language       Language to use when displaying the time or `auto`
@@ -98,9 +116,13 @@ class GreeterConfig  {
 	 */
 	get greeter() {
 		if ( null === _greeter ) {
-			let bools = {'debug_mode': false, 'secure_mode': true, 'detect_theme_errors': true},
+			let bools = {
+					'debug_mode': false, 'secure_mode': true, 'detect_theme_errors': true,
+					'low_power_mode': true, 'speculative_authentication': false, 'mock_backend': false,
+					'metrics_socket': false, 'input_latency': false,
+				},
 				strings = {'time_format': 'LT', 'time_language': 'auto', 'webkit_theme': 'antergos'},
-				numbers = {'screensaver_timeout': 300};
+				numbers = {'screensaver_timeout': 300, 'clock_tick_interval': 60};
 
 			_greeter = {};
 
@@ -157,27 +179,7 @@ class GreeterConfig  {
 }
 
 
-const __greeter_config = new Promise( (resolve, reject) => {
-	let waiting = 0;
-
-	const check_window_prop = () => {
-		if ( waiting > 15000 ) {
-			return reject( 'Timeout Reached!');
-		}
-
-		setTimeout( () => {
-			waiting += 1;
-
-			if ( '__GreeterConfig' in window ) {
-				return resolve( (() => new GreeterConfig())() );
-			}
-
-			check_window_prop();
-		}, 0 );
-	};
-
-	check_window_prop();
-});
+const __greeter_config = __greeter_ready.then( () => new GreeterConfig() );
 
 
 /**
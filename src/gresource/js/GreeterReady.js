@@ -0,0 +1,46 @@
+/*
+ * GreeterReady.js
+ *
+ * Copyright © 2017 Antergos Developers <dev@antergos.com>
+ *
+ * This file is part of lightdm-webkit2-greeter.
+ *
+ * lightdm-webkit2-greeter is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * lightdm-webkit2-greeter is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * The following additional terms are in effect as per Section 7 of the license:
+ *
+ * The preservation of all legal notices and author attributions in
+ * the material or in the Appropriate Legal Notices displayed
+ * by works containing it is required.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with lightdm-webkit2-greeter; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+/**
+ * Resolves once the web extension has published all of its objects (`__LightDMGreeter`,
+ * `__GreeterConfig`, `__ThemeUtils`, etc) on `window`. They are published together in
+ * the extension's window-object-cleared handler, which normally runs before the bundle,
+ * so this is usually resolved immediately. Otherwise the extension fires `GreeterReady`
+ * when it is done.
+ *
+ * @private
+ * @type {Promise}
+ */
+const __greeter_ready = new Promise( resolve => {
+	if ( '__GreeterReady' in window ) {
+		return resolve();
+	}
+
+	window.addEventListener( 'GreeterReady', () => resolve(), { once: true } );
+} );
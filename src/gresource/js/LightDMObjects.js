@@ -207,14 +207,27 @@ class User {
 	}
 
 	/**
-	 * The image for the user.
-	 * @type {string}
+	 * The image for the user, as a 256px thumbnail. See {@link LightDM.User#get_image}.
+	 * @type {string|null}
 	 * @readonly
 	 */
 	get image() {
 		return this._image;
 	}
 
+	/**
+	 * Get the user's image as a thumbnail whose shorter side is `size` pixels (16 to 1024).
+	 * Thumbnails are made in the background and cached, until one is ready this returns
+	 * the original image and {@link event:greeter-user-image-ready} fires when it is.
+	 *
+	 * @arg {number} size The size the image is displayed at, in device pixels.
+	 *
+	 * @returns {string|null} Path of the image or `null` if the user has none.
+	 */
+	get_image( size ) {
+		return this._image;
+	}
+
 	/**
 	 * The home_directory for the user.
 	 * @type {string}
@@ -271,3 +284,16 @@ class User {
 		return this._real_name;
 	}
 }
+
+
+/**
+ * Fired on the `window` object when the thumbnail of a user image that was returned at
+ * full size by {@link LightDM.User#image} or {@link LightDM.User#get_image} is ready.
+ *
+ * @event greeter-user-image-ready
+ * @type {CustomEvent}
+ * @prop {object} detail
+ * @prop {string} detail.image     The original image that was returned.
+ * @prop {number} detail.size      The requested size.
+ * @prop {string} detail.thumbnail The thumbnail to show instead.
+ */
@@ -0,0 +1,101 @@
+/*
+ * ThemeErrorReporter.js
+ *
+ * Copyright © 2017 Antergos Developers <dev@antergos.com>
+ *
+ * This file is part of lightdm-webkit2-greeter.
+ *
+ * lightdm-webkit2-greeter is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * lightdm-webkit2-greeter is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * The following additional terms are in effect as per Section 7 of the license:
+ *
+ * The preservation of all legal notices and author attributions in
+ * the material or in the Appropriate Legal Notices displayed
+ * by works containing it is required.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with lightdm-webkit2-greeter; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * Reports uncaught errors and unhandled promise rejections in the theme to the greeter
+ * so that it can log them and offer to load a fallback theme. Reports are deduplicated
+ * and rate limited so that an error thrown from an animation loop can't flood the greeter.
+ *
+ * @private
+ */
+class ThemeErrorReporter {
+
+	constructor( max_per_second = 5 ) {
+		this._max_per_second = max_per_second;
+		this._window_start = 0;
+		this._sent_in_window = 0;
+		this._seen = new Set();
+
+		window.addEventListener( 'error', event => this._on_error( event ) );
+		window.addEventListener( 'unhandledrejection', event => this._on_rejection( event ) );
+	}
+
+	_on_error( event ) {
+		this._report( {
+			kind: 'error',
+			message: String( event.message ),
+			source: event.filename || '',
+			line: event.lineno || 0,
+			column: event.colno || 0,
+			stack: ( event.error && event.error.stack ) ? String( event.error.stack ) : '',
+		} );
+	}
+
+	_on_rejection( event ) {
+		let reason = event.reason;
+
+		this._report( {
+			kind: 'unhandledrejection',
+			message: ( reason && reason.message ) ? String( reason.message ) : String( reason ),
+			source: ( reason && reason.sourceURL ) ? String( reason.sourceURL ) : '',
+			line: ( reason && reason.line ) ? reason.line : 0,
+			column: ( reason && reason.column ) ? reason.column : 0,
+			stack: ( reason && reason.stack ) ? String( reason.stack ) : '',
+		} );
+	}
+
+	_report( error ) {
+		let key = `${error.kind}:${error.message}:${error.source}:${error.line}:${error.column}`,
+			now = performance.now();
+
+		if ( this._seen.has( key ) ) {
+			return;
+		}
+
+		if ( now - this._window_start >= 1000 ) {
+			this._window_start = now;
+			this._sent_in_window = 0;
+		}
+
+		if ( this._sent_in_window >= this._max_per_second ) {
+			return;
+		}
+
+		this._seen.add( key );
+		this._sent_in_window += 1;
+
+		__GreeterBridge.report_error(
+			error.kind, error.message, error.source, error.stack, error.line, error.column
+		);
+	}
+}
+
+
+if ( '__GreeterBridge' in window ) {
+	window.__theme_error_reporter = new ThemeErrorReporter();
+}
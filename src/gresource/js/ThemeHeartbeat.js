@@ -0,0 +1,113 @@
+/*
+ * ThemeHeartbeat.js
+ *
+ * Copyright © 2017 Antergos Developers <dev@antergos.com>
+ *
+ * This file is part of lightdm-webkit2-greeter.
+ *
+ * lightdm-webkit2-greeter is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * lightdm-webkit2-greeter is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * The following additional terms are in effect as per Section 7 of the license:
+ *
+ * The preservation of all legal notices and author attributions in
+ * the material or in the Appropriate Legal Notices displayed
+ * by works containing it is required.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with lightdm-webkit2-greeter; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * Periodically tells the greeter that the theme's main thread is alive, along with how
+ * late the heartbeat timer fired (the event loop lag). The greeter uses this to detect
+ * stalls and themes that have stopped responding.
+ *
+ * Every beat wakes both processes up, so they are rare. The greeter gives up on a theme
+ * only after 30 seconds of silence.
+ *
+ * @private
+ */
+class ThemeHeartbeat {
+
+	constructor( interval = 10000 ) {
+		this._interval = interval;
+		this._expected = 0;
+		this._timer = null;
+
+		this.start();
+	}
+
+	start() {
+		if ( null !== this._timer || ! this._can_post() ) {
+			return;
+		}
+
+		this._schedule();
+	}
+
+	stop() {
+		clearTimeout( this._timer );
+		this._timer = null;
+	}
+
+	_can_post() {
+		return '__GreeterBridge' in window;
+	}
+
+	_schedule() {
+		this._expected = performance.now() + this._interval;
+		this._timer = setTimeout( () => this._beat(), this._interval );
+	}
+
+	_beat() {
+		let lag = Math.max( 0, Math.round( performance.now() - this._expected ) );
+
+		__GreeterBridge.heartbeat( lag );
+
+		this._schedule();
+	}
+}
+
+
+window.__theme_heartbeat = new ThemeHeartbeat();
+
+
+/**
+ * Tells the greeter that the theme is ready once it has loaded, its fonts are ready and
+ * the frame after that was drawn. `lightdm-webkit2-greeter --benchmark-theme` waits for it.
+ *
+ * @private
+ */
+function __report_theme_ready() {
+	let fonts_ready = ( 'fonts' in document ) ? document.fonts.ready : Promise.resolve();
+
+	fonts_ready.then( () => requestAnimationFrame( () => {
+		if ( '__GreeterBridge' in window ) {
+			__GreeterBridge.theme_ready();
+		}
+	} ) );
+}
+
+if ( 'complete' === document.readyState ) {
+	__report_theme_ready();
+} else {
+	window.addEventListener( 'load', __report_theme_ready, { once: true } );
+}
+
+// Nobody is watching while the screen is blanked, the greeter doesn't expect heartbeats then
+window.addEventListener( 'greeter-display-blanked', event => {
+	if ( event.detail.blanked ) {
+		window.__theme_heartbeat.stop();
+	} else {
+		window.__theme_heartbeat.start();
+	}
+} );
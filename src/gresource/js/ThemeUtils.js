@@ -29,14 +29,347 @@ if ( 'undefined' === typeof window.navigator.languages ) {
 	window.navigator.languages = [ window.navigator.language ];
 }
 
-moment.locale( window.navigator.languages );
-
-let localized_invalid_date = moment('today', '!@#'),
-	time_language = null,
+let time_language = null,
 	time_format = null,
 	allowed_dirs = null;
 
 
+/*
+ * moment.js (with all of its locales) is by far the largest part of the bundle, yet most
+ * themes only use it for the clock, which is now formatted natively. It is loaded from
+ * the themes' _vendor directory the first time a theme touches `window.moment`.
+ */
+Object.defineProperty( window, 'moment', {
+	configurable: true,
+	enumerable: true,
+
+	get() {
+		// Evaluating moment.js replaces this accessor with the real thing
+		delete window.moment;
+
+		try {
+			__ThemeUtils.load_moment();
+			window.moment.locale( window.navigator.languages );
+
+		} catch( err ) {
+			console.log( `[ERROR] Unable to load moment.js: ${err}` );
+		}
+
+		return window.moment;
+	},
+
+	set( value ) {
+		Object.defineProperty( window, 'moment', { value, configurable: true, enumerable: true, writable: true } );
+	},
+} );
+
+
+
+/**
+ * Returns a URL for `image`, which may be an absolute path, a URL or a CSS `url()`.
+ */
+function slideshow_image_url( image ) {
+	let css_url = image.match( /^url\(\s*['"]?(.*?)['"]?\s*\)$/ );
+
+	if ( null !== css_url ) {
+		image = css_url[1];
+	}
+
+	if ( image.startsWith( '/' ) ) {
+		return 'file://' + image.split( '/' ).map( encodeURIComponent ).join( '/' );
+	}
+
+	return image;
+}
+
+
+/**
+ * Cross-fades between background images on an element. Each image is fetched and decoded
+ * with `HTMLImageElement.decode()` while the current one is on screen, so changing images
+ * never decodes on the main thread mid-frame, and the fade only animates the opacity of
+ * two layers the compositor can handle on its own. The slideshow pauses while the display
+ * is blanked (see {@link event:greeter-display-blanked}) or the page is hidden.
+ *
+ * Create instances with {@link window.theme_utils.slideshow()}.
+ *
+ * @memberOf LightDM
+ */
+class Slideshow {
+	constructor( element, images, options = {} ) {
+		/**
+		 * The images to cycle through: absolute paths, URLs or CSS `url()`s.
+		 * @type {string[]}
+		 */
+		this.images = images.slice();
+
+		/**
+		 * Seconds between images, `0` to only change them with {@link LightDM.Slideshow#show}.
+		 * @type {number}
+		 */
+		this.interval = ( 'interval' in options ) ? options.interval : greeter_config.branding.background_interval;
+
+		/**
+		 * Milliseconds each cross-fade takes.
+		 * @type {number}
+		 */
+		this.fade = ( 'fade' in options ) ? options.fade : 1000;
+
+		/**
+		 * Whether to pick the next image at random instead of in order.
+		 * @type {boolean}
+		 */
+		this.shuffle = !! options.shuffle;
+
+		this._element = element;
+		this._layers = [ this._make_layer(), this._make_layer() ];
+		this._front = 0;
+		this._index = -1;
+		this._current = null;
+		this._preloaded = null;
+		this._generation = 0;
+		this._presenting = false;
+		this._running = false;
+		this._blanked = false;
+		this._timer = null;
+		this._due = 0;
+		this._remaining = null;
+
+		if ( 'static' === window.getComputedStyle( element ).position ) {
+			element.style.position = 'relative';
+		}
+
+		// Keeps the layers above the element's own background but below its content
+		element.style.isolation = 'isolate';
+
+		this._blanked_handler = event => {
+			this._blanked = event.detail.blanked;
+			this._update_timer();
+		};
+		this._visibility_handler = () => this._update_timer();
+
+		window.addEventListener( 'greeter-display-blanked', this._blanked_handler );
+		document.addEventListener( 'visibilitychange', this._visibility_handler );
+	}
+
+	/**
+	 * Starts changing images every {@link LightDM.Slideshow#interval} seconds, beginning
+	 * with the next one unless nothing has been shown yet.
+	 */
+	start() {
+		this._running = true;
+
+		if ( this._presenting ) {
+			// It schedules the next image once it's on screen
+			return;
+		}
+
+		if ( null === this._current ) {
+			this.next();
+		} else {
+			this._schedule();
+		}
+	}
+
+	/**
+	 * Stops changing images. The current one stays on screen.
+	 */
+	stop() {
+		this._running = false;
+		this._remaining = null;
+		clearTimeout( this._timer );
+		this._timer = null;
+	}
+
+	/**
+	 * Cross-fades to the next image once it has been decoded.
+	 *
+	 * @returns {Promise} Resolves when the fade starts.
+	 */
+	next() {
+		if ( ! this.images.length ) {
+			return Promise.resolve();
+		}
+
+		return this._present( this._preloaded || this._preload() );
+	}
+
+	/**
+	 * Cross-fades to `image` once it has been decoded. It doesn't need to be one of
+	 * {@link LightDM.Slideshow#images}.
+	 *
+	 * @arg {string} image Absolute path, URL or CSS `url()`.
+	 *
+	 * @returns {Promise} Resolves when the fade starts.
+	 */
+	show( image ) {
+		this._index = this.images.indexOf( image );
+		this._preloaded = null;
+
+		return this._present( this._load( image ) );
+	}
+
+	/**
+	 * Stops the slideshow and removes its layers from the element.
+	 */
+	destroy() {
+		this.stop();
+		this._generation++;
+		this._presenting = false;
+
+		window.removeEventListener( 'greeter-display-blanked', this._blanked_handler );
+		document.removeEventListener( 'visibilitychange', this._visibility_handler );
+
+		this._layers.forEach( layer => layer.remove() );
+		this._current = this._preloaded = null;
+	}
+
+	_make_layer() {
+		let layer = document.createElement( 'div' );
+
+		Object.assign( layer.style, {
+			position: 'absolute',
+			top: '0',
+			right: '0',
+			bottom: '0',
+			left: '0',
+			zIndex: '-1',
+			pointerEvents: 'none',
+			backgroundSize: 'cover',
+			backgroundPosition: 'center',
+			backgroundRepeat: 'no-repeat',
+			opacity: '0',
+			transition: `opacity ${this.fade}ms ease-in-out`,
+			willChange: 'opacity',
+		} );
+
+		this._element.insertBefore( layer, this._element.firstChild );
+
+		return layer;
+	}
+
+	_load( image ) {
+		let img = new Image(),
+			decoded;
+
+		img.src = slideshow_image_url( image );
+
+		if ( 'function' === typeof img.decode ) {
+			decoded = img.decode();
+		} else {
+			decoded = new Promise( ( resolve, reject ) => {
+				img.onload = resolve;
+				img.onerror = reject;
+			} );
+		}
+
+		return decoded.then( () => img );
+	}
+
+	_preload() {
+		let count = this.images.length;
+
+		if ( this.shuffle && count > 1 ) {
+			// Any image but the current one
+			this._index = ( Math.max( this._index, 0 ) + 1 + Math.floor( Math.random() * ( count - 1 ) ) ) % count;
+		} else {
+			this._index = ( this._index + 1 ) % count;
+		}
+
+		this._preloaded = this._load( this.images[ this._index ] );
+		// Failures are reported when it's presented
+		this._preloaded.catch( () => {} );
+
+		return this._preloaded;
+	}
+
+	_present( loaded ) {
+		let generation = ++this._generation;
+
+		clearTimeout( this._timer );
+		this._timer = null;
+		this._remaining = null;
+		this._presenting = true;
+
+		return loaded.then( img => {
+			if ( generation !== this._generation ) {
+				return;
+			}
+
+			let front = this._layers[ this._front ],
+				back = this._layers[ 1 - this._front ];
+
+			back.style.backgroundImage = `url("${img.src}")`;
+
+			// Give the layer a frame to pick up the already decoded image before fading it in
+			window.requestAnimationFrame( () => {
+				back.style.opacity = '1';
+				front.style.opacity = '0';
+			} );
+
+			this._front = 1 - this._front;
+			// Holding on to it keeps the decoded image in WebKit's memory cache
+			this._current = img;
+
+		} ).catch( err => {
+			console.log( `[ERROR] theme_utils.slideshow(): ${err}` );
+
+		} ).then( () => {
+			if ( generation !== this._generation ) {
+				return;
+			}
+
+			this._presenting = false;
+			this._preloaded = null;
+
+			if ( this.images.length > 1 ) {
+				this._preload();
+			}
+
+			this._schedule();
+		} );
+	}
+
+	_paused() {
+		return this._blanked || document.hidden;
+	}
+
+	_schedule( delay = this.interval * 1000 ) {
+		clearTimeout( this._timer );
+		this._timer = null;
+
+		if ( ! this._running || this.interval <= 0 || this.images.length < 2 ) {
+			return;
+		}
+
+		if ( this._paused() ) {
+			this._remaining = delay;
+			return;
+		}
+
+		this._due = Date.now() + delay;
+		this._timer = setTimeout( () => {
+			this._timer = null;
+			this.next();
+		}, delay );
+	}
+
+	_update_timer() {
+		if ( this._paused() ) {
+			if ( null !== this._timer ) {
+				clearTimeout( this._timer );
+				this._timer = null;
+				this._remaining = Math.max( 0, this._due - Date.now() );
+			}
+
+		} else if ( null !== this._remaining ) {
+			let delay = this._remaining;
+
+			this._remaining = null;
+			this._schedule( delay );
+		}
+	}
+}
+
 
 /**
  * Provides various utility methods for use in greeter themes. The greeter will automatically
@@ -158,6 +491,24 @@ class ThemeUtils {
 		return this.txt2html( text );
 	}
 
+	/**
+	 * Escape HTML entities in each string of an array. This is much faster than calling
+	 * {@link window.theme_utils.esc_html()} in a loop.
+	 *
+	 * @param {string[]} texts The strings to be escaped.
+	 *
+	 * @returns {string[]}
+	 */
+	esc_html_bulk( texts ) {
+		try {
+			return __ThemeUtils.txt2html_bulk( texts );
+
+		} catch( err ) {
+			console.log( `[ERROR] theme_utils.esc_html_bulk(): ${err}` );
+			return texts;
+		}
+	}
+
 
 	/**
 	 * Get the current time in a localized format. Time format and language are auto-detected
@@ -176,24 +527,55 @@ class ThemeUtils {
 				manual_language = ( '' !== config.time_language && 'auto' !== config.time_language ),
 				manual_time_format = ( '' !== config.time_format && 'auto' !== config.time_format );
 
-			time_language =  manual_language ? config.time_language : window.navigator.language;
+			time_language =  manual_language ? config.time_language : 'auto';
 			time_format = manual_time_format ? config.time_format : 'LT';
+		}
 
-			if ( manual_language ) {
-				moment.locale( time_language );
-			}
+		let local_time = __ThemeUtils.localized_time( time_format, time_language );
+
+		if ( null === local_time ) {
+			// Not something we can format natively (or unknown locale), let moment.js handle it
+			local_time = this._get_moment_localized_time();
 		}
 
-		let local_time = moment().format( time_format );
+		return local_time;
+	}
 
-		if ( local_time === localized_invalid_date ) {
-			local_time = moment().format( 'LT' );
+
+	_get_moment_localized_time() {
+		let language = ( 'auto' === time_language ) ? window.navigator.languages : time_language,
+			local_time = moment().locale( language ).format( time_format );
+
+		if ( local_time === moment( 'today', '!@#' ).locale( language ).format( time_format ) ) {
+			local_time = moment().locale( language ).format( 'LT' );
 		}
 
 		return local_time;
 	}
 
 
+	/**
+	 * Creates a background slideshow on `element`. See {@link LightDM.Slideshow}.
+	 *
+	 * @arg {Element|string} element The element (or a selector for it) to show images on.
+	 * @arg {string[]}       images  Absolute paths, URLs or CSS `url()`s of the images.
+	 * @arg {object}         [options]
+	 * @arg {number}         [options.interval] Seconds between images. Defaults to the
+	 *                                          `background_interval` config option.
+	 * @arg {number}         [options.fade=1000] Milliseconds each cross-fade takes.
+	 * @arg {boolean}        [options.shuffle=false] Pick images at random instead of in order.
+	 *
+	 * @returns {LightDM.Slideshow} The slideshow, call `start()` to start it.
+	 */
+	slideshow( element, images, options = {} ) {
+		if ( 'string' === typeof element ) {
+			element = document.querySelector( element );
+		}
+
+		return new Slideshow( element, images || [], options );
+	}
+
+
 	/**
 	 * Use {@link window.theme_utils.esc_html()} instead.
 	 *
@@ -211,27 +593,39 @@ class ThemeUtils {
 }
 
 
-const __theme_utils = new Promise( (resolve, reject) => {
-	let waiting = 0;
-
-	const check_window_prop = () => {
-		if ( waiting > 15000 ) {
-			return reject( 'Timeout Reached!');
-		}
+/**
+ * Fired on the `window` object when the displayed time changes: on minute boundaries by
+ * default, or every `clock_tick_interval` seconds when that is set in the config file.
+ * It is not fired while the screensaver has blanked the display. Themes should use it
+ * instead of polling {@link window.theme_utils.get_current_localized_time()} with
+ * `setInterval()` so the greeter doesn't wake up for nothing.
+ *
+ * @event greeter-clock-tick
+ * @type {CustomEvent}
+ * @prop {object} detail
+ * @prop {string} detail.time      The current localized time (see `time_format`).
+ * @prop {number} detail.timestamp Milliseconds since the epoch.
+ */
+window.addEventListener( 'greeter-clock-tick', event => {
+	if ( null === event.detail.time && 'theme_utils' in window ) {
+		// The extension couldn't format it natively
+		event.detail.time = window.theme_utils.get_current_localized_time();
+	}
+} );
 
-		setTimeout( () => {
-			waiting += 1;
 
-			if ( '__ThemeUtils' in window ) {
-				return resolve( (() => new ThemeUtils())() );
-			}
+/**
+ * Fired on the `window` object when the screensaver or DPMS blanks the display and again
+ * when it comes back. Themes should pause slideshows, animations and timers while blanked.
+ *
+ * @event greeter-display-blanked
+ * @type {CustomEvent}
+ * @prop {object}  detail
+ * @prop {boolean} detail.blanked Whether the display is blanked.
+ */
 
-			check_window_prop();
-		}, 0 );
-	};
 
-	check_window_prop();
-});
+const __theme_utils = __greeter_ready.then( () => new ThemeUtils() );
 
 
 /**
@@ -0,0 +1,230 @@
+/*
+ * input-latency.c
+ *
+ * Copyright © 2017 Antergos Developers <dev@antergos.com>
+ *
+ * This file is part of lightdm-webkit2-greeter.
+ *
+ * lightdm-webkit2-greeter is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * lightdm-webkit2-greeter is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * The following additional terms are in effect as per Section 7 of the license:
+ *
+ * The preservation of all legal notices and author attributions in
+ * the material or in the Appropriate Legal Notices displayed
+ * by works containing it is required.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with lightdm-webkit2-greeter; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* A key press is timestamped when GTK dispatches it to the web view (main() forces core
+ * device events, so that is when the UI process receives it). Its latency ends when the
+ * first frame in which the web view drew afterwards was presented, or painted if the
+ * compositor doesn't report presentation times. Percentiles are taken over the most
+ * recent SAMPLE_WINDOW_SIZE key presses.
+ */
+
+#include <string.h>
+
+#include "input-latency.h"
+#include "metrics-text.h"
+#include "sample-window.h"
+
+/* Key presses that can wait for the same frame, any more are dropped */
+#define MAX_PENDING_KEYS 32
+
+/* Log the percentiles after this many key presses */
+#define LOG_EVERY 50
+
+
+static struct {
+	gboolean started;
+
+	/* Key presses the web view hasn't drawn since */
+	gint64 pending[MAX_PENDING_KEYS];
+	guint n_pending;
+	gboolean web_view_drawn;
+
+	/* The frame that showed them, until its timings are complete */
+	gint64 frame_counter;
+	gint64 frame_painted_at;
+	gint64 frame_keys[MAX_PENDING_KEYS];
+	guint n_frame_keys;
+
+	/* Milliseconds */
+	SampleWindow samples;
+
+	guint64 count;
+	gdouble sum;
+} latency;
+
+
+static void
+add_sample(gdouble milliseconds) {
+	sample_window_add(&latency.samples, milliseconds);
+
+	latency.count++;
+	latency.sum += milliseconds;
+
+	if (0 == latency.count % LOG_EVERY) {
+		gchar *summary = input_latency_to_string();
+
+		g_message("%s", summary);
+		g_free(summary);
+	}
+}
+
+
+/*
+ * Turns the key presses shown by the recorded frame into samples once GTK knows when the
+ * frame was presented, or right away if `force` is set or the timings are gone.
+ */
+static void
+resolve_frame(GdkFrameClock *frame_clock, gboolean force) {
+	GdkFrameTimings *timings;
+	gint64 shown_at, presented_at = 0;
+	guint i;
+
+	if (0 == latency.n_frame_keys) {
+		return;
+	}
+
+	timings = gdk_frame_clock_get_timings(frame_clock, latency.frame_counter);
+
+	if (NULL != timings && gdk_frame_timings_get_complete(timings)) {
+		presented_at = gdk_frame_timings_get_presentation_time(timings);
+
+	} else if (NULL != timings && ! force) {
+		return;
+	}
+
+	shown_at = (0 != presented_at) ? presented_at : latency.frame_painted_at;
+
+	for (i = 0; i < latency.n_frame_keys; i++) {
+		add_sample(MAX(0, shown_at - latency.frame_keys[i]) / 1000.0);
+	}
+
+	latency.n_frame_keys = 0;
+}
+
+
+static gboolean
+key_press_cb(GtkWidget *widget, GdkEventKey *event, gpointer user_data) {
+	/* Nothing about `event` is kept, only when it arrived */
+	if (latency.n_pending < MAX_PENDING_KEYS) {
+		latency.pending[latency.n_pending++] = g_get_monotonic_time();
+	}
+
+	return GDK_EVENT_PROPAGATE;
+}
+
+
+static gboolean
+web_view_draw_cb(GtkWidget *widget, cairo_t *cr, gpointer user_data) {
+	if (0 != latency.n_pending) {
+		latency.web_view_drawn = TRUE;
+	}
+
+	return FALSE;
+}
+
+
+static void
+after_paint_cb(GdkFrameClock *frame_clock, gpointer user_data) {
+	resolve_frame(frame_clock, FALSE);
+
+	if (! latency.web_view_drawn) {
+		return;
+	}
+
+	/* Only one frame is tracked at a time */
+	resolve_frame(frame_clock, TRUE);
+
+	memcpy(latency.frame_keys, latency.pending, sizeof(gint64) * latency.n_pending);
+	latency.n_frame_keys = latency.n_pending;
+	latency.frame_counter = gdk_frame_clock_get_frame_counter(frame_clock);
+	latency.frame_painted_at = g_get_monotonic_time();
+
+	latency.n_pending = 0;
+	latency.web_view_drawn = FALSE;
+}
+
+
+/*
+ * Starts measuring key presses sent to `web_view`. `window` must be realized.
+ */
+void
+input_latency_start(GtkWidget *window, GtkWidget *web_view) {
+	GdkFrameClock *frame_clock = gtk_widget_get_frame_clock(window);
+
+	if (latency.started || NULL == frame_clock) {
+		return;
+	}
+
+	latency.started = TRUE;
+
+	g_signal_connect(web_view, "key-press-event", G_CALLBACK(key_press_cb), NULL);
+	g_signal_connect_after(web_view, "draw", G_CALLBACK(web_view_draw_cb), NULL);
+	g_signal_connect(frame_clock, "after-paint", G_CALLBACK(after_paint_cb), NULL);
+}
+
+
+/*
+ * Returns a one line summary for the log. Free it with g_free().
+ */
+gchar *
+input_latency_to_string(void) {
+	static const gdouble quantiles[] = {0.5, 0.95, 0.99};
+	gdouble values[G_N_ELEMENTS(quantiles)];
+
+	if (! sample_window_get_quantiles(&latency.samples, quantiles, values, G_N_ELEMENTS(quantiles))) {
+		return g_strdup("Input-to-paint latency: no key presses yet");
+	}
+
+	return g_strdup_printf(
+		"Input-to-paint latency: %" G_GUINT64_FORMAT " key presses, p50 %.1f ms, p95 %.1f ms, p99 %.1f ms",
+		latency.count, values[0], values[1], values[2]
+	);
+}
+
+
+/*
+ * Appends the latency to the metrics socket's text as a summary, if it is being measured.
+ */
+void
+input_latency_append_metrics(GString *text) {
+	static const gdouble quantiles[] = {0.5, 0.95, 0.99};
+	gdouble values[G_N_ELEMENTS(quantiles)];
+	guint i;
+
+	if (! latency.started) {
+		return;
+	}
+
+	metrics_text_append_family(
+		text,
+		"greeter_input_to_paint_seconds",
+		"summary",
+		"Time from a key press reaching the UI process until the web view's next frame was shown."
+	);
+
+	if (sample_window_get_quantiles(&latency.samples, quantiles, values, G_N_ELEMENTS(quantiles))) {
+		for (i = 0; i < G_N_ELEMENTS(quantiles); i++) {
+			gchar *labels = g_strdup_printf("quantile=\"%g\"", quantiles[i]);
+
+			metrics_text_append_value(text, "greeter_input_to_paint_seconds", labels, values[i] / 1000.0);
+			g_free(labels);
+		}
+	}
+
+	metrics_text_append_value(text, "greeter_input_to_paint_seconds_sum", NULL, latency.sum / 1000.0);
+	metrics_text_append_value(text, "greeter_input_to_paint_seconds_count", NULL, (gdouble) latency.count);
+}
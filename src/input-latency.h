@@ -0,0 +1,51 @@
+/*
+ * input-latency.h
+ *
+ * Copyright © 2017 Antergos Developers <dev@antergos.com>
+ *
+ * This file is part of lightdm-webkit2-greeter.
+ *
+ * lightdm-webkit2-greeter is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * lightdm-webkit2-greeter is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * The following additional terms are in effect as per Section 7 of the license:
+ *
+ * The preservation of all legal notices and author attributions in
+ * the material or in the Appropriate Legal Notices displayed
+ * by works containing it is required.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with lightdm-webkit2-greeter; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Opt-in input-to-paint latency of key presses in the UI process (the `input_latency`
+ * config option). Only the time a key press arrived is kept, never which key it was, so
+ * it is safe to enable while people type their passwords.
+ */
+
+#ifndef INPUT_LATENCY_H
+#define INPUT_LATENCY_H
+
+#include <gtk/gtk.h>
+
+G_BEGIN_DECLS
+
+void
+input_latency_start(GtkWidget *window, GtkWidget *web_view);
+
+gchar *
+input_latency_to_string(void);
+
+void
+input_latency_append_metrics(GString *text);
+
+G_END_DECLS
+
+#endif /* INPUT_LATENCY_H */
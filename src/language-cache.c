@@ -0,0 +1,350 @@
+/*
+ * language-cache.c
+ *
+ * Copyright © 2017 Antergos Developers <dev@antergos.com>
+ *
+ * This file is part of lightdm-webkit2-greeter.
+ *
+ * lightdm-webkit2-greeter is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * lightdm-webkit2-greeter is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * The following additional terms are in effect as per Section 7 of the license:
+ *
+ * The preservation of all legal notices and author attributions in
+ * the material or in the Appropriate Legal Notices displayed
+ * by works containing it is required.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with lightdm-webkit2-greeter; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* The cache file holds one "code<TAB>name<TAB>territory" line per language and carries
+ * the mtime of the locale archive it was made from, like the avatar thumbnails do.
+ * Names come from newlocale() + nl_langinfo_l(), which unlike the setlocale() dance in
+ * liblightdm is safe to do off the main thread.
+ */
+
+#define _GNU_SOURCE
+#include <string.h>
+#include <locale.h>
+#include <langinfo.h>
+#include <utime.h>
+#include <sys/stat.h>
+#include <glib/gstdio.h>
+
+#include "language-cache.h"
+
+
+/* Where localedef puts generated locales. Systems without an archive have a directory per
+ * locale instead, which gets a new mtime when one is added or removed.
+ */
+#define LOCALE_ARCHIVE "/usr/lib/locale/locale-archive"
+#define LOCALE_DIR     "/usr/lib/locale"
+
+
+static GThread *worker = NULL;
+static GPtrArray *languages = NULL;
+
+
+static void
+cached_language_free(CachedLanguage *language) {
+	g_free(language->code);
+	g_free(language->name);
+	g_free(language->territory);
+	g_free(language);
+}
+
+
+static CachedLanguage *
+cached_language_new(const gchar *code, const gchar *name, const gchar *territory) {
+	CachedLanguage *language = g_new0(CachedLanguage, 1);
+
+	language->code = g_strdup(code);
+	language->name = g_strdup(name);
+	language->territory = (NULL != territory && '\0' != territory[0]) ? g_strdup(territory) : NULL;
+
+	return language;
+}
+
+
+/*
+ * Returns the mtime the cache is keyed on, or -1 if there are no generated locales.
+ */
+static gint64
+get_locale_archive_mtime(void) {
+	GStatBuf archive;
+
+	if (0 == g_stat(LOCALE_ARCHIVE, &archive) || 0 == g_stat(LOCALE_DIR, &archive)) {
+		return (gint64) archive.st_mtime;
+	}
+
+	return -1;
+}
+
+
+/*
+ * Names `code` the way lightdm_language_get_name() and lightdm_language_get_territory() do.
+ */
+static CachedLanguage *
+describe_language(const gchar *code) {
+	CachedLanguage *language;
+	const gchar *name = NULL, *territory = NULL;
+	gchar **tokens = NULL;
+	locale_t locale = (locale_t) 0;
+
+	#ifdef _NL_IDENTIFICATION_LANGUAGE
+	locale = newlocale(LC_IDENTIFICATION_MASK, code, (locale_t) 0);
+
+	if ((locale_t) 0 != locale) {
+		name = nl_langinfo_l(_NL_IDENTIFICATION_LANGUAGE, locale);
+
+		if (NULL != strchr(code, '_')) {
+			territory = nl_langinfo_l(_NL_IDENTIFICATION_TERRITORY, locale);
+		}
+	}
+	#endif
+
+	if (NULL == name || '\0' == name[0]) {
+		tokens = g_strsplit_set(code, "_.@", 2);
+		name = tokens[0];
+	}
+
+	/* Not a real territory */
+	if (0 == g_strcmp0(territory, "ISO")) {
+		territory = NULL;
+	}
+
+	language = cached_language_new(code, name, territory);
+
+	if ((locale_t) 0 != locale) {
+		freelocale(locale);
+	}
+
+	g_strfreev(tokens);
+
+	return language;
+}
+
+
+/*
+ * Lists the UTF-8 locales that `locale -a` knows about, like liblightdm does.
+ */
+static GPtrArray *
+list_languages(void) {
+	GPtrArray *result = g_ptr_array_new_with_free_func((GDestroyNotify) cached_language_free);
+	gchar *output = NULL, **lines;
+	gint status, i;
+
+	if (! g_spawn_command_line_sync("locale -a", &output, NULL, &status, NULL)) {
+		return result;
+	}
+
+	lines = g_strsplit_set(output, "\n\r", -1);
+
+	for (i = 0; NULL != lines[i]; i++) {
+		gchar *code = g_strstrip(lines[i]);
+
+		if ('\0' == code[0] || NULL == g_strrstr(code, ".utf8")) {
+			continue;
+		}
+
+		g_ptr_array_add(result, describe_language(code));
+	}
+
+	g_strfreev(lines);
+	g_free(output);
+
+	return result;
+}
+
+
+static GPtrArray *
+load_cache(const gchar *cache_file, gint64 mtime) {
+	GPtrArray *result;
+	GStatBuf cache;
+	gchar *contents, **lines;
+	gint i;
+
+	if (-1 == mtime || 0 != g_stat(cache_file, &cache) || (gint64) cache.st_mtime != mtime) {
+		return NULL;
+	}
+
+	if (! g_file_get_contents(cache_file, &contents, NULL, NULL)) {
+		return NULL;
+	}
+
+	result = g_ptr_array_new_with_free_func((GDestroyNotify) cached_language_free);
+	lines = g_strsplit(contents, "\n", -1);
+
+	for (i = 0; NULL != lines[i]; i++) {
+		gchar **fields = g_strsplit(lines[i], "\t", 3);
+
+		if (3 == g_strv_length(fields)) {
+			g_ptr_array_add(result, cached_language_new(fields[0], fields[1], fields[2]));
+		}
+
+		g_strfreev(fields);
+	}
+
+	g_strfreev(lines);
+	g_free(contents);
+
+	return result;
+}
+
+
+static void
+save_cache(const gchar *cache_file, gint64 mtime, GPtrArray *result) {
+	GString *contents = g_string_new(NULL);
+	gchar *dir = g_path_get_dirname(cache_file);
+	struct utimbuf times;
+	guint i;
+
+	for (i = 0; i < result->len; i++) {
+		CachedLanguage *language = g_ptr_array_index(result, i);
+
+		g_string_append_printf(
+			contents,
+			"%s\t%s\t%s\n",
+			language->code,
+			language->name,
+			(NULL != language->territory) ? language->territory : ""
+		);
+	}
+
+	times.actime = (time_t) mtime;
+	times.modtime = (time_t) mtime;
+
+	if (0 == g_mkdir_with_parents(dir, 0700)
+			&& g_file_set_contents(cache_file, contents->str, contents->len, NULL)) {
+		g_utime(cache_file, &times);
+	}
+
+	g_string_free(contents, TRUE);
+	g_free(dir);
+}
+
+
+static gpointer
+language_cache_worker(gpointer data) {
+	gchar *cache_file = data;
+	gint64 mtime = get_locale_archive_mtime();
+	gint64 started = g_get_monotonic_time();
+	GPtrArray *result = (NULL != cache_file) ? load_cache(cache_file, mtime) : NULL;
+
+	if (NULL != result) {
+		g_debug("Languages: %u from cache in %.1f ms", result->len, (g_get_monotonic_time() - started) / 1000.0);
+
+	} else {
+		result = list_languages();
+		g_debug("Languages: %u from locale -a in %.1f ms", result->len, (g_get_monotonic_time() - started) / 1000.0);
+
+		if (NULL != cache_file && -1 != mtime) {
+			save_cache(cache_file, mtime, result);
+		}
+	}
+
+	g_free(cache_file);
+
+	return result;
+}
+
+
+/*
+ * Starts building the list on a worker thread.
+ */
+void
+language_cache_init(const gchar *cache_file) {
+	if (NULL != worker || NULL != languages) {
+		return;
+	}
+
+	worker = g_thread_new("language-cache", language_cache_worker, g_strdup(cache_file));
+}
+
+
+/*
+ * Returns the list of languages, waiting for the worker if it hasn't finished yet.
+ * The array and its languages are owned by the cache.
+ */
+GPtrArray *
+language_cache_get(void) {
+	if (NULL != worker) {
+		languages = g_thread_join(worker);
+		worker = NULL;
+	}
+
+	if (NULL == languages) {
+		/* Never initialized */
+		languages = language_cache_worker(NULL);
+	}
+
+	return languages;
+}
+
+
+/*
+ * Splits `code` at the codeset and normalizes that, so "en_US.UTF-8" matches "en_US.utf8".
+ */
+static gchar *
+normalize_code(const gchar *code) {
+	const gchar *dot = strchr(code, '.');
+	GString *result;
+
+	if (NULL == dot) {
+		return g_strdup(code);
+	}
+
+	result = g_string_new_len(code, dot - code + 1);
+
+	for (dot++; '\0' != *dot; dot++) {
+		if ('-' != *dot) {
+			g_string_append_c(result, g_ascii_tolower(*dot));
+		}
+	}
+
+	return g_string_free(result, FALSE);
+}
+
+
+/*
+ * Returns the language that matches `code` (eg. $LANG) the way lightdm_get_language() does,
+ * or NULL.
+ */
+const CachedLanguage *
+language_cache_find(const gchar *code) {
+	GPtrArray *all;
+	gchar *wanted;
+	guint i;
+
+	if (NULL == code) {
+		return NULL;
+	}
+
+	all = language_cache_get();
+	wanted = normalize_code(code);
+
+	for (i = 0; i < all->len; i++) {
+		CachedLanguage *language = g_ptr_array_index(all, i);
+		gchar *candidate = normalize_code(language->code);
+		gboolean matches = (0 == g_strcmp0(wanted, candidate));
+
+		g_free(candidate);
+
+		if (matches) {
+			g_free(wanted);
+			return language;
+		}
+	}
+
+	g_free(wanted);
+
+	return NULL;
+}
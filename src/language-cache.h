@@ -0,0 +1,59 @@
+/*
+ * language-cache.h
+ *
+ * Copyright © 2017 Antergos Developers <dev@antergos.com>
+ *
+ * This file is part of lightdm-webkit2-greeter.
+ *
+ * lightdm-webkit2-greeter is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * lightdm-webkit2-greeter is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * The following additional terms are in effect as per Section 7 of the license:
+ *
+ * The preservation of all legal notices and author attributions in
+ * the material or in the Appropriate Legal Notices displayed
+ * by works containing it is required.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with lightdm-webkit2-greeter; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* The list of installed languages, built on a worker thread while the extension starts
+ * instead of the first time a theme asks for it. liblightdm runs `locale -a` and switches
+ * the process's locale for every entry, which takes a noticeable while with all locales
+ * generated, so the result is also cached on disk until the locale archive changes.
+ */
+
+#ifndef LANGUAGE_CACHE_H
+#define LANGUAGE_CACHE_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct {
+	gchar *code;
+	gchar *name;
+	gchar *territory; /* NULL for languages without one, like liblightdm */
+} CachedLanguage;
+
+
+void
+language_cache_init(const gchar *cache_file);
+
+GPtrArray *
+language_cache_get(void);
+
+const CachedLanguage *
+language_cache_find(const gchar *code);
+
+G_END_DECLS
+
+#endif /* LANGUAGE_CACHE_H */
@@ -0,0 +1,76 @@
+/*
+ * latency-histogram.c
+ *
+ * Copyright © 2017 Antergos Developers <dev@antergos.com>
+ *
+ * This file is part of lightdm-webkit2-greeter.
+ *
+ * lightdm-webkit2-greeter is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * lightdm-webkit2-greeter is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * The following additional terms are in effect as per Section 7 of the license:
+ *
+ * The preservation of all legal notices and author attributions in
+ * the material or in the Appropriate Legal Notices displayed
+ * by works containing it is required.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with lightdm-webkit2-greeter; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "latency-histogram.h"
+
+
+const gint64 latency_histogram_bounds[LATENCY_HISTOGRAM_BUCKETS] = {
+	16, 50, 100, 250, 500, 1000, 2500, 5000, 10000, G_MAXINT64
+};
+
+
+void
+latency_histogram_add(LatencyHistogram *histogram, gint64 milliseconds) {
+	guint i;
+
+	milliseconds = MAX(0, milliseconds);
+
+	for (i = 0; milliseconds > latency_histogram_bounds[i]; i++);
+
+	histogram->counts[i]++;
+	histogram->count++;
+	histogram->total += milliseconds;
+	histogram->max = MAX(histogram->max, milliseconds);
+}
+
+
+/*
+ * Returns a one line summary of `histogram` for the log. Free it with g_free().
+ */
+gchar *
+latency_histogram_to_string(const LatencyHistogram *histogram) {
+	GString *result = g_string_new(histogram->name);
+	guint i;
+
+	g_string_append_printf(
+		result,
+		": n=%u avg=%" G_GINT64_FORMAT "ms max=%" G_GINT64_FORMAT "ms |",
+		histogram->count,
+		(0 == histogram->count) ? 0 : histogram->total / histogram->count,
+		histogram->max
+	);
+
+	for (i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++) {
+		if (G_MAXINT64 == latency_histogram_bounds[i]) {
+			g_string_append_printf(result, " >%" G_GINT64_FORMAT "ms:%u", latency_histogram_bounds[i - 1], histogram->counts[i]);
+		} else {
+			g_string_append_printf(result, " <=%" G_GINT64_FORMAT "ms:%u", latency_histogram_bounds[i], histogram->counts[i]);
+		}
+	}
+
+	return g_string_free(result, FALSE);
+}
@@ -0,0 +1,61 @@
+/*
+ * latency-histogram.h
+ *
+ * Copyright © 2017 Antergos Developers <dev@antergos.com>
+ *
+ * This file is part of lightdm-webkit2-greeter.
+ *
+ * lightdm-webkit2-greeter is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * lightdm-webkit2-greeter is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * The following additional terms are in effect as per Section 7 of the license:
+ *
+ * The preservation of all legal notices and author attributions in
+ * the material or in the Appropriate Legal Notices displayed
+ * by works containing it is required.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with lightdm-webkit2-greeter; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Fixed-bucket latency histograms (milliseconds) shared by the UI process and the web
+ * extension. They only hold numbers so they are safe to log.
+ */
+
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+#define LATENCY_HISTOGRAM_BUCKETS 10
+
+/* Upper bound (inclusive) of each bucket in milliseconds, the last one is open ended */
+extern const gint64 latency_histogram_bounds[LATENCY_HISTOGRAM_BUCKETS];
+
+typedef struct {
+	const gchar *name;
+	guint        counts[LATENCY_HISTOGRAM_BUCKETS];
+	guint        count;
+	gint64       total;
+	gint64       max;
+} LatencyHistogram;
+
+
+void
+latency_histogram_add(LatencyHistogram *histogram, gint64 milliseconds);
+
+gchar *
+latency_histogram_to_string(const LatencyHistogram *histogram);
+
+G_END_DECLS
+
+#endif /* LATENCY_HISTOGRAM_H */
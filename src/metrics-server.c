@@ -0,0 +1,167 @@
+/*
+ * metrics-server.c
+ *
+ * Copyright © 2017 Antergos Developers <dev@antergos.com>
+ *
+ * This file is part of lightdm-webkit2-greeter.
+ *
+ * lightdm-webkit2-greeter is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * lightdm-webkit2-greeter is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * The following additional terms are in effect as per Section 7 of the license:
+ *
+ * The preservation of all legal notices and author attributions in
+ * the material or in the Appropriate Legal Notices displayed
+ * by works containing it is required.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with lightdm-webkit2-greeter; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib/gstdio.h>
+#include <gio/gio.h>
+#include <gio/gunixsocketaddress.h>
+
+#include "metrics-server.h"
+
+
+struct _MetricsRequest {
+	GSocketConnection *connection;
+	GString           *text;
+};
+
+static GSocketService *service;
+static gchar *socket_path;
+static MetricsCollectFunc collect_func;
+
+
+static void
+request_written_cb(GObject      *stream,
+				   GAsyncResult *result,
+				   gpointer      user_data) {
+
+	MetricsRequest *request = user_data;
+	GError *err = NULL;
+
+	if (! g_output_stream_write_all_finish(G_OUTPUT_STREAM(stream), result, NULL, &err)) {
+		g_debug("Unable to send metrics: %s", err->message);
+		g_error_free(err);
+	}
+
+	g_io_stream_close(G_IO_STREAM(request->connection), NULL, NULL);
+	g_object_unref(request->connection);
+	g_string_free(request->text, TRUE);
+	g_free(request);
+}
+
+
+static gboolean
+incoming_cb(GSocketService    *socket_service,
+			GSocketConnection *connection,
+			GObject           *source_object,
+			gpointer           user_data) {
+
+	MetricsRequest *request = g_new0(MetricsRequest, 1);
+
+	request->connection = g_object_ref(connection);
+	request->text = g_string_sized_new(8192);
+
+	collect_func(request);
+
+	return TRUE;
+}
+
+
+/*
+ * Listens on `path`, replacing a socket left behind by a previous greeter.
+ */
+gboolean
+metrics_server_start(const gchar *path, MetricsCollectFunc collect, GError **error) {
+	GSocketAddress *address;
+	gchar *directory;
+	gboolean result;
+
+	g_return_val_if_fail(NULL == service, FALSE);
+
+	directory = g_path_get_dirname(path);
+	g_mkdir_with_parents(directory, 0755);
+	g_free(directory);
+	g_unlink(path);
+
+	service = g_socket_service_new();
+	address = g_unix_socket_address_new(path);
+
+	result = g_socket_listener_add_address(
+		G_SOCKET_LISTENER(service),
+		address,
+		G_SOCKET_TYPE_STREAM,
+		G_SOCKET_PROTOCOL_DEFAULT,
+		NULL,
+		NULL,
+		error
+	);
+
+	g_object_unref(address);
+
+	if (! result) {
+		g_clear_object(&service);
+		return FALSE;
+	}
+
+	/* Monitoring agents get access through the greeter user's group */
+	g_chmod(path, 0660);
+
+	socket_path = g_strdup(path);
+	collect_func = collect;
+
+	g_signal_connect(service, "incoming", G_CALLBACK(incoming_cb), NULL);
+	g_socket_service_start(service);
+
+	return TRUE;
+}
+
+
+void
+metrics_server_stop(void) {
+	if (NULL == service) {
+		return;
+	}
+
+	g_socket_service_stop(service);
+	g_socket_listener_close(G_SOCKET_LISTENER(service));
+	g_clear_object(&service);
+
+	g_unlink(socket_path);
+	g_free(socket_path);
+	socket_path = NULL;
+}
+
+
+GString *
+metrics_request_get_text(MetricsRequest *request) {
+	return request->text;
+}
+
+
+/*
+ * Sends what was collected for `request` and closes the connection.
+ */
+void
+metrics_request_finish(MetricsRequest *request) {
+	g_output_stream_write_all_async(
+		g_io_stream_get_output_stream(G_IO_STREAM(request->connection)),
+		request->text->str,
+		request->text->len,
+		G_PRIORITY_DEFAULT,
+		NULL,
+		request_written_cb,
+		request
+	);
+}
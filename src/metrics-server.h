@@ -0,0 +1,61 @@
+/*
+ * metrics-server.h
+ *
+ * Copyright © 2017 Antergos Developers <dev@antergos.com>
+ *
+ * This file is part of lightdm-webkit2-greeter.
+ *
+ * lightdm-webkit2-greeter is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * lightdm-webkit2-greeter is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * The following additional terms are in effect as per Section 7 of the license:
+ *
+ * The preservation of all legal notices and author attributions in
+ * the material or in the Appropriate Legal Notices displayed
+ * by works containing it is required.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with lightdm-webkit2-greeter; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Read-only Unix socket in the UI process that serves the greeter's metrics in the
+ * Prometheus text format (`metrics_socket` in the config file). Every connection gets
+ * a fresh snapshot and is closed, nothing is ever read from it. Nothing is collected
+ * until someone connects.
+ */
+
+#ifndef METRICS_SERVER_H
+#define METRICS_SERVER_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _MetricsRequest MetricsRequest;
+
+/* Appends to metrics_request_get_text() and calls metrics_request_finish(), maybe later */
+typedef void (*MetricsCollectFunc) (MetricsRequest *request);
+
+
+gboolean
+metrics_server_start(const gchar *path, MetricsCollectFunc collect, GError **error);
+
+void
+metrics_server_stop(void);
+
+GString *
+metrics_request_get_text(MetricsRequest *request);
+
+void
+metrics_request_finish(MetricsRequest *request);
+
+G_END_DECLS
+
+#endif /* METRICS_SERVER_H */
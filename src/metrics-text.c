@@ -0,0 +1,105 @@
+/*
+ * metrics-text.c
+ *
+ * Copyright © 2017 Antergos Developers <dev@antergos.com>
+ *
+ * This file is part of lightdm-webkit2-greeter.
+ *
+ * lightdm-webkit2-greeter is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * lightdm-webkit2-greeter is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * The following additional terms are in effect as per Section 7 of the license:
+ *
+ * The preservation of all legal notices and author attributions in
+ * the material or in the Appropriate Legal Notices displayed
+ * by works containing it is required.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with lightdm-webkit2-greeter; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "metrics-text.h"
+
+
+/*
+ * Starts a metric family. Every sample of the family must follow before the next one
+ * is started.
+ */
+void
+metrics_text_append_family(GString     *text,
+						   const gchar *name,
+						   const gchar *type,
+						   const gchar *help) {
+
+	g_string_append_printf(text, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+
+/*
+ * Appends a sample. `labels` is either NULL or the inside of the braces, ie. `phase="load"`.
+ */
+void
+metrics_text_append_value(GString     *text,
+						  const gchar *name,
+						  const gchar *labels,
+						  gdouble      value) {
+
+	gchar number[G_ASCII_DTOSTR_BUF_SIZE];
+
+	g_ascii_formatd(number, sizeof(number), "%.15g", value);
+
+	if (NULL == labels || '\0' == *labels) {
+		g_string_append_printf(text, "%s %s\n", name, number);
+	} else {
+		g_string_append_printf(text, "%s{%s} %s\n", name, labels, number);
+	}
+}
+
+
+/*
+ * Appends the samples of a histogram family, converted to seconds. The buckets of a
+ * LatencyHistogram are not cumulative, Prometheus' are.
+ */
+void
+metrics_text_append_histogram(GString                *text,
+							  const gchar            *name,
+							  const gchar            *labels,
+							  const LatencyHistogram *histogram) {
+
+	gchar *sample_name, *bucket_labels, bound[G_ASCII_DTOSTR_BUF_SIZE];
+	const gchar *separator = (NULL != labels && '\0' != *labels) ? "," : "";
+	guint i, cumulative = 0;
+
+	sample_name = g_strconcat(name, "_bucket", NULL);
+
+	for (i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++) {
+		cumulative += histogram->counts[i];
+
+		if (G_MAXINT64 == latency_histogram_bounds[i]) {
+			g_strlcpy(bound, "+Inf", sizeof(bound));
+		} else {
+			g_ascii_formatd(bound, sizeof(bound), "%.15g", latency_histogram_bounds[i] / 1000.0);
+		}
+
+		bucket_labels = g_strdup_printf("%s%sle=\"%s\"", (NULL != labels) ? labels : "", separator, bound);
+		metrics_text_append_value(text, sample_name, bucket_labels, cumulative);
+		g_free(bucket_labels);
+	}
+
+	g_free(sample_name);
+
+	sample_name = g_strconcat(name, "_sum", NULL);
+	metrics_text_append_value(text, sample_name, labels, histogram->total / 1000.0);
+	g_free(sample_name);
+
+	sample_name = g_strconcat(name, "_count", NULL);
+	metrics_text_append_value(text, sample_name, labels, histogram->count);
+	g_free(sample_name);
+}
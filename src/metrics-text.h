@@ -0,0 +1,61 @@
+/*
+ * metrics-text.h
+ *
+ * Copyright © 2017 Antergos Developers <dev@antergos.com>
+ *
+ * This file is part of lightdm-webkit2-greeter.
+ *
+ * lightdm-webkit2-greeter is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * lightdm-webkit2-greeter is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * The following additional terms are in effect as per Section 7 of the license:
+ *
+ * The preservation of all legal notices and author attributions in
+ * the material or in the Appropriate Legal Notices displayed
+ * by works containing it is required.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with lightdm-webkit2-greeter; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Prometheus text format (version 0.0.4) helpers for the metrics socket. Both processes
+ * write their own share of the metrics with these, see metrics-server.c.
+ */
+
+#ifndef METRICS_TEXT_H
+#define METRICS_TEXT_H
+
+#include <glib.h>
+
+#include "latency-histogram.h"
+
+G_BEGIN_DECLS
+
+void
+metrics_text_append_family(GString     *text,
+						   const gchar *name,
+						   const gchar *type,
+						   const gchar *help);
+
+void
+metrics_text_append_value(GString     *text,
+						  const gchar *name,
+						  const gchar *labels,
+						  gdouble      value);
+
+void
+metrics_text_append_histogram(GString                *text,
+							  const gchar            *name,
+							  const gchar            *labels,
+							  const LatencyHistogram *histogram);
+
+G_END_DECLS
+
+#endif /* METRICS_TEXT_H */
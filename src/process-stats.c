@@ -0,0 +1,127 @@
+/*
+ * process-stats.c
+ *
+ * Copyright © 2017 Antergos Developers <dev@antergos.com>
+ *
+ * This file is part of lightdm-webkit2-greeter.
+ *
+ * lightdm-webkit2-greeter is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * lightdm-webkit2-greeter is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * The following additional terms are in effect as per Section 7 of the license:
+ *
+ * The preservation of all legal notices and author attributions in
+ * the material or in the Appropriate Legal Notices displayed
+ * by works containing it is required.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with lightdm-webkit2-greeter; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+#include "process-stats.h"
+
+
+/*
+ * Returns the number of voluntary and involuntary context switches of all threads of the
+ * calling process so far, which is a good approximation of how many times it woke up.
+ * (/proc/self/status would only count the main thread.) Returns 0 if unavailable.
+ */
+guint64
+process_stats_get_context_switches(void) {
+	struct rusage usage;
+
+	if (0 != getrusage(RUSAGE_SELF, &usage)) {
+		return 0;
+	}
+
+	return (guint64) usage.ru_nvcsw + (guint64) usage.ru_nivcsw;
+}
+
+
+/*
+ * Returns the resident set size of the calling process in bytes or 0 if /proc is not
+ * available.
+ */
+guint64
+process_stats_get_resident_bytes(void) {
+	gchar *contents = NULL, **fields;
+	guint64 result = 0;
+
+	if (! g_file_get_contents("/proc/self/statm", &contents, NULL, NULL)) {
+		return 0;
+	}
+
+	fields = g_strsplit(contents, " ", 3);
+
+	if (NULL != fields[0] && NULL != fields[1]) {
+		result = g_ascii_strtoull(fields[1], NULL, 10) * (guint64) sysconf(_SC_PAGESIZE);
+	}
+
+	g_strfreev(fields);
+	g_free(contents);
+
+	return result;
+}
+
+
+/*
+ * Returns how many bytes the calling process has read with read() and friends, from files
+ * and sockets alike, or 0 if /proc is not available. Files that were mapped don't count.
+ */
+guint64
+process_stats_get_bytes_read(void) {
+	gchar *contents = NULL, **lines, **line;
+	guint64 result = 0;
+
+	if (! g_file_get_contents("/proc/self/io", &contents, NULL, NULL)) {
+		return 0;
+	}
+
+	lines = g_strsplit(contents, "\n", -1);
+
+	for (line = lines; NULL != *line; line++) {
+		if (g_str_has_prefix(*line, "rchar:")) {
+			result = g_ascii_strtoull(*line + strlen("rchar:"), NULL, 10);
+			break;
+		}
+	}
+
+	g_strfreev(lines);
+	g_free(contents);
+
+	return result;
+}
+
+
+void
+wakeup_counter_start(WakeupCounter *counter) {
+	counter->started = g_get_monotonic_time();
+	counter->wakeups = process_stats_get_context_switches();
+}
+
+
+/*
+ * Returns the average number of wakeups per minute since wakeup_counter_start().
+ */
+gdouble
+wakeup_counter_per_minute(const WakeupCounter *counter) {
+	gint64 elapsed = g_get_monotonic_time() - counter->started;
+	guint64 wakeups = process_stats_get_context_switches() - counter->wakeups;
+
+	if (elapsed <= 0) {
+		return 0;
+	}
+
+	return (gdouble) wakeups * 60 * G_USEC_PER_SEC / elapsed;
+}
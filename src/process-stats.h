@@ -0,0 +1,63 @@
+/*
+ * process-stats.h
+ *
+ * Copyright © 2017 Antergos Developers <dev@antergos.com>
+ *
+ * This file is part of lightdm-webkit2-greeter.
+ *
+ * lightdm-webkit2-greeter is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * lightdm-webkit2-greeter is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * The following additional terms are in effect as per Section 7 of the license:
+ *
+ * The preservation of all legal notices and author attributions in
+ * the material or in the Appropriate Legal Notices displayed
+ * by works containing it is required.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with lightdm-webkit2-greeter; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Cheap counters for the calling process, from /proc and getrusage(). Used to compare
+ * how often the greeter's processes wake up with and without the low-power mode, and for
+ * the metrics socket.
+ */
+
+#ifndef PROCESS_STATS_H
+#define PROCESS_STATS_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct {
+	gint64  started;   /* Monotonic time (microseconds) */
+	guint64 wakeups;   /* Context switches when started */
+} WakeupCounter;
+
+
+guint64
+process_stats_get_context_switches(void);
+
+guint64
+process_stats_get_resident_bytes(void);
+
+guint64
+process_stats_get_bytes_read(void);
+
+void
+wakeup_counter_start(WakeupCounter *counter);
+
+gdouble
+wakeup_counter_per_minute(const WakeupCounter *counter);
+
+G_END_DECLS
+
+#endif /* PROCESS_STATS_H */
@@ -0,0 +1,84 @@
+/*
+ * sample-window.c
+ *
+ * Copyright © 2017 Antergos Developers <dev@antergos.com>
+ *
+ * This file is part of lightdm-webkit2-greeter.
+ *
+ * lightdm-webkit2-greeter is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * lightdm-webkit2-greeter is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * The following additional terms are in effect as per Section 7 of the license:
+ *
+ * The preservation of all legal notices and author attributions in
+ * the material or in the Appropriate Legal Notices displayed
+ * by works containing it is required.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with lightdm-webkit2-greeter; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "sample-window.h"
+
+
+/*
+ * qsort() comparator for gdouble.
+ */
+gint
+sample_window_compare_doubles(gconstpointer a, gconstpointer b) {
+	gdouble value_a = *(const gdouble *) a, value_b = *(const gdouble *) b;
+
+	return (value_a > value_b) - (value_a < value_b);
+}
+
+
+void
+sample_window_add(SampleWindow *window, gdouble value) {
+	window->samples[window->next_sample] = value;
+	window->next_sample = (window->next_sample + 1) % SAMPLE_WINDOW_SIZE;
+	window->n_samples = MIN(window->n_samples + 1, SAMPLE_WINDOW_SIZE);
+}
+
+
+/*
+ * Sets `values` to the `quantiles` (0 to 1) of the samples in `window`, using the
+ * nearest-rank method.
+ *
+ * Returns FALSE if there are none.
+ */
+gboolean
+sample_window_get_quantiles(const SampleWindow *window,
+							const gdouble      *quantiles,
+							gdouble            *values,
+							guint               n_quantiles) {
+	gdouble *sorted;
+	guint i;
+
+	if (0 == window->n_samples) {
+		return FALSE;
+	}
+
+	sorted = g_new(gdouble, window->n_samples);
+	memcpy(sorted, window->samples, sizeof(gdouble) * window->n_samples);
+	qsort(sorted, window->n_samples, sizeof(gdouble), sample_window_compare_doubles);
+
+	for (i = 0; i < n_quantiles; i++) {
+		guint rank = (guint) (quantiles[i] * window->n_samples + 0.999999);
+
+		values[i] = sorted[CLAMP(rank, 1, window->n_samples) - 1];
+	}
+
+	g_free(sorted);
+
+	return TRUE;
+}
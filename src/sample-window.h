@@ -0,0 +1,62 @@
+/*
+ * sample-window.h
+ *
+ * Copyright © 2017 Antergos Developers <dev@antergos.com>
+ *
+ * This file is part of lightdm-webkit2-greeter.
+ *
+ * lightdm-webkit2-greeter is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * lightdm-webkit2-greeter is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * The following additional terms are in effect as per Section 7 of the license:
+ *
+ * The preservation of all legal notices and author attributions in
+ * the material or in the Appropriate Legal Notices displayed
+ * by works containing it is required.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with lightdm-webkit2-greeter; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* The most recent SAMPLE_WINDOW_SIZE values of a measurement, for percentiles that follow
+ * what is happening now rather than since startup. A zeroed SampleWindow is empty.
+ */
+
+#ifndef SAMPLE_WINDOW_H
+#define SAMPLE_WINDOW_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+#define SAMPLE_WINDOW_SIZE 1024
+
+typedef struct {
+	gdouble samples[SAMPLE_WINDOW_SIZE]; /* A ring buffer */
+	guint   n_samples;
+	guint   next_sample;
+} SampleWindow;
+
+
+void
+sample_window_add(SampleWindow *window, gdouble value);
+
+gboolean
+sample_window_get_quantiles(const SampleWindow *window,
+							const gdouble      *quantiles,
+							gdouble            *values,
+							guint               n_quantiles);
+
+gint
+sample_window_compare_doubles(gconstpointer a, gconstpointer b);
+
+G_END_DECLS
+
+#endif /* SAMPLE_WINDOW_H */
@@ -0,0 +1,355 @@
+/*
+ * session-catalog.c
+ *
+ * Copyright © 2017 Antergos Developers <dev@antergos.com>
+ *
+ * This file is part of lightdm-webkit2-greeter.
+ *
+ * lightdm-webkit2-greeter is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * lightdm-webkit2-greeter is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * The following additional terms are in effect as per Section 7 of the license:
+ *
+ * The preservation of all legal notices and author attributions in
+ * the material or in the Appropriate Legal Notices displayed
+ * by works containing it is required.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with lightdm-webkit2-greeter; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Sessions are read the way liblightdm reads them: hidden ones and those whose TryExec
+ * isn't installed are skipped, the key is the file name without ".desktop" and the list is
+ * sorted by name. When a key exists in more than one directory the first one wins.
+ *
+ * The directories are LightDM's sessions-directory. It is looked up in the same files the
+ * daemon reads, so drop-ins that liblightdm itself would miss are honoured too.
+ */
+
+#include <string.h>
+#include <glib/gi18n.h>
+#include <gio/gio.h>
+
+#include "config.h"
+#include "session-catalog.h"
+
+/* Work-around CLion bug */
+#ifndef CONFIG_DIR
+#include "../build/src/config.h"
+#endif
+
+
+#define DEFAULT_SESSIONS_DIRECTORY "/usr/share/lightdm/sessions:/usr/share/xsessions:/usr/share/wayland-sessions"
+
+/* Read by the daemon in this order before lightdm.conf, later files override earlier ones */
+static const gchar * const config_directories[] = {
+	"/usr/share/lightdm/lightdm.conf.d",
+	"/usr/local/share/lightdm/lightdm.conf.d",
+	"/etc/xdg/lightdm/lightdm.conf.d",
+	CONFIG_DIR "/lightdm.conf.d",
+	NULL
+};
+
+
+static struct {
+	gchar **directories;
+	GPtrArray *monitors;
+
+	GPtrArray *sessions; /* Sorted by name */
+	GHashTable *by_key;
+	gboolean dirty;
+	guint generation;
+} catalog;
+
+
+static void
+catalog_session_free(CatalogSession *session) {
+	g_free(session->key);
+	g_free(session->name);
+	g_free(session->comment);
+	g_free(session);
+}
+
+
+static gint
+compare_sessions(gconstpointer a, gconstpointer b) {
+	const CatalogSession *session_a = *(CatalogSession **) a, *session_b = *(CatalogSession **) b;
+
+	return g_strcmp0(session_a->name, session_b->name);
+}
+
+
+static CatalogSession *
+load_session(const gchar *path, const gchar *key) {
+	CatalogSession *session = NULL;
+	GKeyFile *keyfile = g_key_file_new();
+	gchar *domain = NULL, *name = NULL, *comment = NULL, *try_exec = NULL, *program = NULL;
+
+	if (! g_key_file_load_from_file(keyfile, path, G_KEY_FILE_NONE, NULL)
+			|| g_key_file_get_boolean(keyfile, G_KEY_FILE_DESKTOP_GROUP, G_KEY_FILE_DESKTOP_KEY_NO_DISPLAY, NULL)
+			|| g_key_file_get_boolean(keyfile, G_KEY_FILE_DESKTOP_GROUP, G_KEY_FILE_DESKTOP_KEY_HIDDEN, NULL)) {
+		goto done;
+	}
+
+	try_exec = g_key_file_get_string(keyfile, G_KEY_FILE_DESKTOP_GROUP, G_KEY_FILE_DESKTOP_KEY_TRY_EXEC, NULL);
+
+	if (NULL != try_exec && NULL == (program = g_find_program_in_path(try_exec))) {
+		goto done;
+	}
+
+	name = g_key_file_get_locale_string(keyfile, G_KEY_FILE_DESKTOP_GROUP, G_KEY_FILE_DESKTOP_KEY_NAME, NULL, NULL);
+
+	if (NULL == name) {
+		g_warning("Ignoring session without name: %s", path);
+		goto done;
+	}
+
+	comment = g_key_file_get_locale_string(keyfile, G_KEY_FILE_DESKTOP_GROUP, G_KEY_FILE_DESKTOP_KEY_COMMENT, NULL, NULL);
+	domain = g_key_file_get_string(keyfile, G_KEY_FILE_DESKTOP_GROUP, "X-GNOME-Gettext-Domain", NULL);
+
+	session = g_new0(CatalogSession, 1);
+	session->key = g_strdup(key);
+	session->name = (NULL != domain) ? g_strdup(g_dgettext(domain, name)) : g_strdup(name);
+	session->comment = (NULL != domain && NULL != comment) ? g_strdup(g_dgettext(domain, comment)) : g_strdup(comment);
+
+done:
+	g_free(program);
+	g_free(try_exec);
+	g_free(domain);
+	g_free(comment);
+	g_free(name);
+	g_key_file_free(keyfile);
+
+	return session;
+}
+
+
+static void
+load_directory(const gchar *directory) {
+	GDir *dir = g_dir_open(directory, 0, NULL);
+	const gchar *filename;
+
+	if (NULL == dir) {
+		return;
+	}
+
+	while (NULL != (filename = g_dir_read_name(dir))) {
+		CatalogSession *session;
+		gchar *key, *path;
+
+		if (! g_str_has_suffix(filename, ".desktop")) {
+			continue;
+		}
+
+		key = g_strndup(filename, strlen(filename) - strlen(".desktop"));
+
+		if (g_hash_table_contains(catalog.by_key, key)) {
+			g_free(key);
+			continue;
+		}
+
+		path = g_build_filename(directory, filename, NULL);
+		session = load_session(path, key);
+
+		if (NULL != session) {
+			g_ptr_array_add(catalog.sessions, session);
+			g_hash_table_insert(catalog.by_key, session->key, session);
+		}
+
+		g_free(path);
+		g_free(key);
+	}
+
+	g_dir_close(dir);
+}
+
+
+static void
+load_catalog(void) {
+	gint64 started = g_get_monotonic_time();
+	guint i;
+
+	g_clear_pointer(&catalog.by_key, g_hash_table_unref);
+	g_clear_pointer(&catalog.sessions, g_ptr_array_unref);
+
+	catalog.sessions = g_ptr_array_new_with_free_func((GDestroyNotify) catalog_session_free);
+	/* Keys are owned by the sessions */
+	catalog.by_key = g_hash_table_new(g_str_hash, g_str_equal);
+
+	for (i = 0; NULL != catalog.directories[i]; i++) {
+		load_directory(catalog.directories[i]);
+	}
+
+	g_ptr_array_sort(catalog.sessions, compare_sessions);
+
+	catalog.dirty = FALSE;
+	catalog.generation++;
+
+	g_debug(
+		"Sessions: loaded %u in %.2f ms",
+		catalog.sessions->len,
+		(g_get_monotonic_time() - started) / 1000.0
+	);
+}
+
+
+static void
+directory_changed_cb(GFileMonitor     *monitor,
+					 GFile            *file,
+					 GFile            *other_file,
+					 GFileMonitorEvent event_type,
+					 gpointer          user_data) {
+	if (G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT != event_type && G_FILE_MONITOR_EVENT_ATTRIBUTE_CHANGED != event_type) {
+		session_catalog_invalidate();
+	}
+}
+
+
+static gint
+compare_names(gconstpointer a, gconstpointer b) {
+	return g_strcmp0(*(const gchar **) a, *(const gchar **) b);
+}
+
+
+/*
+ * Replaces `value` with the sessions-directory set by the config file at `path`, if any.
+ */
+static void
+read_sessions_directory(const gchar *path, gchar **value) {
+	GKeyFile *config = g_key_file_new();
+	gchar *directory;
+
+	if (g_key_file_load_from_file(config, path, G_KEY_FILE_NONE, NULL)
+			&& NULL != (directory = g_key_file_get_string(config, "LightDM", "sessions-directory", NULL))) {
+		g_free(*value);
+		*value = directory;
+	}
+
+	g_key_file_free(config);
+}
+
+
+/*
+ * Returns LightDM's sessions-directory split into directories. Free it with g_strfreev().
+ */
+static gchar **
+get_configured_directories(void) {
+	gchar *value = g_strdup(DEFAULT_SESSIONS_DIRECTORY), **directories;
+	guint i, j;
+
+	for (i = 0; NULL != config_directories[i]; i++) {
+		GDir *dir = g_dir_open(config_directories[i], 0, NULL);
+		GPtrArray *names = g_ptr_array_new_with_free_func(g_free);
+		const gchar *filename;
+
+		if (NULL == dir) {
+			g_ptr_array_unref(names);
+			continue;
+		}
+
+		while (NULL != (filename = g_dir_read_name(dir))) {
+			if (g_str_has_suffix(filename, ".conf")) {
+				g_ptr_array_add(names, g_strdup(filename));
+			}
+		}
+
+		g_dir_close(dir);
+		g_ptr_array_sort(names, compare_names);
+
+		for (j = 0; j < names->len; j++) {
+			gchar *path = g_build_filename(config_directories[i], g_ptr_array_index(names, j), NULL);
+
+			read_sessions_directory(path, &value);
+			g_free(path);
+		}
+
+		g_ptr_array_unref(names);
+	}
+
+	read_sessions_directory(CONFIG_DIR "/lightdm.conf", &value);
+
+	directories = g_strsplit(value, ":", -1);
+	g_free(value);
+
+	/* Drop empty entries, eg. from a trailing ':' */
+	for (i = 0, j = 0; NULL != directories[i]; i++) {
+		if ('\0' == *directories[i]) {
+			g_free(directories[i]);
+		} else {
+			directories[j++] = directories[i];
+		}
+	}
+
+	directories[j] = NULL;
+
+	return directories;
+}
+
+
+/*
+ * Starts watching `directories` (or LightDM's sessions-directory if NULL). Nothing is
+ * parsed until the catalog is first used.
+ */
+void
+session_catalog_init(const gchar * const *directories) {
+	guint i;
+
+	if (NULL != catalog.directories) {
+		return;
+	}
+
+	catalog.directories = (NULL != directories) ? g_strdupv((gchar **) directories) : get_configured_directories();
+	catalog.monitors = g_ptr_array_new_with_free_func(g_object_unref);
+	catalog.dirty = TRUE;
+
+	for (i = 0; NULL != catalog.directories[i]; i++) {
+		GFile *file = g_file_new_for_path(catalog.directories[i]);
+		GFileMonitor *monitor = g_file_monitor_directory(file, G_FILE_MONITOR_NONE, NULL, NULL);
+
+		if (NULL != monitor) {
+			g_signal_connect(monitor, "changed", G_CALLBACK(directory_changed_cb), NULL);
+			g_ptr_array_add(catalog.monitors, monitor);
+		}
+
+		g_object_unref(file);
+	}
+}
+
+
+/*
+ * Returns the sessions sorted by name, parsing them first if this is the first call since
+ * something changed. `generation` (if not NULL) is set to a number that changes whenever
+ * the list does. The array is owned by the catalog and only valid until the next call.
+ */
+GPtrArray *
+session_catalog_get(guint *generation) {
+	if (NULL == catalog.directories) {
+		session_catalog_init(NULL);
+	}
+
+	if (catalog.dirty) {
+		load_catalog();
+	}
+
+	if (NULL != generation) {
+		*generation = catalog.generation;
+	}
+
+	return catalog.sessions;
+}
+
+
+/*
+ * Makes the next session_catalog_get() parse the session directories again.
+ */
+void
+session_catalog_invalidate(void) {
+	catalog.dirty = TRUE;
+}
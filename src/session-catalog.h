@@ -0,0 +1,58 @@
+/*
+ * session-catalog.h
+ *
+ * Copyright © 2017 Antergos Developers <dev@antergos.com>
+ *
+ * This file is part of lightdm-webkit2-greeter.
+ *
+ * lightdm-webkit2-greeter is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * lightdm-webkit2-greeter is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * The following additional terms are in effect as per Section 7 of the license:
+ *
+ * The preservation of all legal notices and author attributions in
+ * the material or in the Appropriate Legal Notices displayed
+ * by works containing it is required.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with lightdm-webkit2-greeter; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* The sessions a user can pick, parsed once from the session directories and kept until
+ * a file monitor reports a change in one of them. liblightdm hands out the same list, but
+ * the extension used to wrap every session in a new host object on each access.
+ */
+
+#ifndef SESSION_CATALOG_H
+#define SESSION_CATALOG_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct {
+	gchar *key;
+	gchar *name;
+	gchar *comment;
+} CatalogSession;
+
+
+void
+session_catalog_init(const gchar * const *directories);
+
+GPtrArray *
+session_catalog_get(guint *generation);
+
+void
+session_catalog_invalidate(void);
+
+G_END_DECLS
+
+#endif /* SESSION_CATALOG_H */
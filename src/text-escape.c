@@ -0,0 +1,305 @@
+/*
+ * text-escape.c
+ *
+ * Copyright © 2017 Antergos Developers <dev@antergos.com>
+ *
+ * This file is part of lightdm-webkit2-greeter.
+ *
+ * lightdm-webkit2-greeter is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * lightdm-webkit2-greeter is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * The following additional terms are in effect as per Section 7 of the license:
+ *
+ * The preservation of all legal notices and author attributions in
+ * the material or in the Appropriate Legal Notices displayed
+ * by works containing it is required.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with lightdm-webkit2-greeter; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Single-pass text escaping shared by theme_utils.txt2html() and the code that builds
+ * JavaScript snippets (show_prompt() etc.) in the web extension. Nearly every string we
+ * see (usernames, session names, PAM prompts) needs no escaping at all, so the input is
+ * scanned first and returned as a plain copy when there is nothing to do.
+ */
+
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "text-escape.h"
+
+
+/* UTF-8 lead byte of U+2028 LINE SEPARATOR and U+2029 PARAGRAPH SEPARATOR, both of which
+ * terminate a JavaScript string literal.
+ */
+#define UTF8_LS_PS_LEAD 0xE2
+
+
+static inline gboolean
+is_line_or_paragraph_separator(const guchar *ptr, const guchar *end) {
+	return (end - ptr) >= 3
+		&& UTF8_LS_PS_LEAD == ptr[0]
+		&& 0x80 == ptr[1]
+		&& (0xA8 == ptr[2] || 0xA9 == ptr[2]);
+}
+
+
+static inline gboolean
+byte_needs_escape(const guchar *ptr, const guchar *end, TextEscapeMode mode) {
+	guchar c = *ptr;
+
+	if (TEXT_ESCAPE_HTML == mode) {
+		return '&' == c || '"' == c || '<' == c || '>' == c || '\n' == c;
+	}
+
+	return c < 0x20 || 0x7F == c || '\\' == c || '\'' == c || '"' == c
+		|| is_line_or_paragraph_separator(ptr, end);
+}
+
+
+#ifdef __SSE2__
+/*
+ * Returns a bitmask with one bit set for every byte in the 16 byte block at `ptr` that
+ * might need escaping. Bits for UTF8_LS_PS_LEAD are only candidates and must be confirmed
+ * by the caller.
+ */
+static inline guint
+candidate_mask_sse2(const guchar *ptr, TextEscapeMode mode) {
+	__m128i block = _mm_loadu_si128((const __m128i *) ptr);
+	__m128i hits;
+
+	if (TEXT_ESCAPE_HTML == mode) {
+		hits = _mm_or_si128(
+			_mm_or_si128(
+				_mm_cmpeq_epi8(block, _mm_set1_epi8('&')),
+				_mm_cmpeq_epi8(block, _mm_set1_epi8('"'))
+			),
+			_mm_or_si128(
+				_mm_or_si128(
+					_mm_cmpeq_epi8(block, _mm_set1_epi8('<')),
+					_mm_cmpeq_epi8(block, _mm_set1_epi8('>'))
+				),
+				_mm_cmpeq_epi8(block, _mm_set1_epi8('\n'))
+			)
+		);
+
+	} else {
+		/* Unsigned `block <= 0x1F` is `max(block, 0x1F) == 0x1F` */
+		__m128i control_max = _mm_set1_epi8(0x1F);
+
+		hits = _mm_or_si128(
+			_mm_or_si128(
+				_mm_cmpeq_epi8(_mm_max_epu8(block, control_max), control_max),
+				_mm_cmpeq_epi8(block, _mm_set1_epi8(0x7F))
+			),
+			_mm_or_si128(
+				_mm_or_si128(
+					_mm_cmpeq_epi8(block, _mm_set1_epi8('\\')),
+					_mm_cmpeq_epi8(block, _mm_set1_epi8('\''))
+				),
+				_mm_or_si128(
+					_mm_cmpeq_epi8(block, _mm_set1_epi8('"')),
+					_mm_cmpeq_epi8(block, _mm_set1_epi8((gchar) UTF8_LS_PS_LEAD))
+				)
+			)
+		);
+	}
+
+	return (guint) _mm_movemask_epi8(hits);
+}
+#endif
+
+
+/*
+ * Returns the offset of the first byte in `str` that needs escaping, or `length`
+ * if there is none.
+ */
+static gsize
+find_first_escape(const guchar *str, gsize length, TextEscapeMode mode) {
+	const guchar *end = str + length;
+	gsize offset = 0;
+
+#ifdef __SSE2__
+	for (; offset + 16 <= length; offset += 16) {
+		guint mask = candidate_mask_sse2(str + offset, mode);
+
+		while (0 != mask) {
+			guint bit = (guint) __builtin_ctz(mask);
+
+			if (byte_needs_escape(str + offset + bit, end, mode)) {
+				return offset + bit;
+			}
+
+			mask &= mask - 1;
+		}
+	}
+#endif
+
+	for (; offset < length; offset++) {
+		if (byte_needs_escape(str + offset, end, mode)) {
+			return offset;
+		}
+	}
+
+	return length;
+}
+
+
+/*
+ * Appends the escaped form of the character at `ptr` to `result`.
+ *
+ * Returns the number of input bytes consumed.
+ */
+static gsize
+append_escaped(GString *result, const guchar *ptr, const guchar *end, TextEscapeMode mode) {
+	if (TEXT_ESCAPE_HTML == mode) {
+		switch (*ptr) {
+			case '&':
+				g_string_append(result, "&amp;");
+				break;
+			case '"':
+				g_string_append(result, "&quot;");
+				break;
+			case '<':
+				g_string_append(result, "&lt;");
+				break;
+			case '>':
+				g_string_append(result, "&gt;");
+				break;
+			case '\n':
+				g_string_append(result, "<br>");
+				break;
+		}
+
+		return 1;
+	}
+
+	if (is_line_or_paragraph_separator(ptr, end)) {
+		g_string_append(result, (0xA8 == ptr[2]) ? "\\u2028" : "\\u2029");
+		return 3;
+	}
+
+	switch (*ptr) {
+		case '\b':
+			g_string_append(result, "\\b");
+			break;
+		case '\f':
+			g_string_append(result, "\\f");
+			break;
+		case '\n':
+			g_string_append(result, "\\n");
+			break;
+		case '\r':
+			g_string_append(result, "\\r");
+			break;
+		case '\t':
+			g_string_append(result, "\\t");
+			break;
+		case '\v':
+			g_string_append(result, "\\v");
+			break;
+		case '\\':
+			g_string_append(result, "\\\\");
+			break;
+		case '\'':
+			g_string_append(result, "\\'");
+			break;
+		case '"':
+			g_string_append(result, "\\\"");
+			break;
+		default:
+			g_string_append_printf(result, "\\u%04x", (guint) *ptr);
+			break;
+	}
+
+	return 1;
+}
+
+
+/*
+ * Whether or not `text` contains anything that `mode` would escape.
+ */
+gboolean
+text_escape_needed(const gchar *text, gsize length, TextEscapeMode mode) {
+	return find_first_escape((const guchar *) text, length, mode) < length;
+}
+
+
+/*
+ * Escapes `text` in a single pass.
+ *
+ * Unlike g_strescape(), valid UTF-8 is passed through untouched in TEXT_ESCAPE_JS_STRING
+ * mode so that non-ASCII prompts are not mangled into octal escapes.
+ *
+ * Returns a newly allocated string or NULL if `text` is NULL.
+ */
+gchar *
+text_escape(const gchar *text, TextEscapeMode mode) {
+	const guchar *ptr, *end;
+	gsize length, offset;
+	GString *result;
+
+	if (NULL == text) {
+		return NULL;
+	}
+
+	length = strlen(text);
+	ptr = (const guchar *) text;
+	end = ptr + length;
+	offset = find_first_escape(ptr, length, mode);
+
+	if (offset == length) {
+		return g_strndup(text, length);
+	}
+
+	/* Most strings that need escaping only need a handful of substitutions */
+	result = g_string_sized_new(length + (length / 8) + 16);
+
+	while (ptr < end) {
+		g_string_append_len(result, (const gchar *) ptr, offset);
+		ptr += offset;
+
+		if (ptr == end) {
+			break;
+		}
+
+		ptr += append_escaped(result, ptr, end, mode);
+		offset = find_first_escape(ptr, end - ptr, mode);
+	}
+
+	return g_string_free(result, FALSE);
+}
+
+
+/*
+ * Escapes each string of the NULL-terminated array `texts`.
+ *
+ * Returns a newly allocated NULL-terminated array. Free it with g_strfreev().
+ */
+gchar **
+text_escape_strv(const gchar * const *texts, TextEscapeMode mode) {
+	gchar **result;
+	guint i, n_texts;
+
+	n_texts = (NULL == texts) ? 0 : g_strv_length((gchar **) texts);
+	result = g_new(gchar *, n_texts + 1);
+
+	for (i = 0; i < n_texts; i++) {
+		result[i] = text_escape(texts[i], mode);
+	}
+
+	result[n_texts] = NULL;
+
+	return result;
+}
@@ -0,0 +1,54 @@
+/*
+ * text-escape.h
+ *
+ * Copyright © 2017 Antergos Developers <dev@antergos.com>
+ *
+ * This file is part of lightdm-webkit2-greeter.
+ *
+ * lightdm-webkit2-greeter is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * lightdm-webkit2-greeter is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * The following additional terms are in effect as per Section 7 of the license:
+ *
+ * The preservation of all legal notices and author attributions in
+ * the material or in the Appropriate Legal Notices displayed
+ * by works containing it is required.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with lightdm-webkit2-greeter; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TEXT_ESCAPE_H
+#define TEXT_ESCAPE_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef enum {
+	/* & " < > become entities, newlines become <br> (theme_utils.txt2html()) */
+	TEXT_ESCAPE_HTML,
+	/* Safe for use inside a single or double quoted JavaScript string literal */
+	TEXT_ESCAPE_JS_STRING,
+} TextEscapeMode;
+
+
+gchar *
+text_escape(const gchar *text, TextEscapeMode mode);
+
+gchar **
+text_escape_strv(const gchar * const *texts, TextEscapeMode mode);
+
+gboolean
+text_escape_needed(const gchar *text, gsize length, TextEscapeMode mode);
+
+G_END_DECLS
+
+#endif /* TEXT_ESCAPE_H */
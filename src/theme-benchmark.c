@@ -0,0 +1,214 @@
+/*
+ * theme-benchmark.c
+ *
+ * Copyright © 2017 Antergos Developers <dev@antergos.com>
+ *
+ * This file is part of lightdm-webkit2-greeter.
+ *
+ * lightdm-webkit2-greeter is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * lightdm-webkit2-greeter is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * The following additional terms are in effect as per Section 7 of the license:
+ *
+ * The preservation of all legal notices and author attributions in
+ * the material or in the Appropriate Legal Notices displayed
+ * by works containing it is required.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with lightdm-webkit2-greeter; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <glib/gstdio.h>
+
+#include "theme-benchmark.h"
+#include "sample-window.h"
+
+
+/* Marks the lines the parent reads from an iteration's output. Themes write to stdout too
+ * (enable-write-console-messages-to-stdout).
+ */
+#define RESULT_PREFIX "benchmark: "
+
+
+static const gchar *metric_names[THEME_BENCHMARK_COUNT] = {
+	"first_paint_ms",
+	"theme_ready_ms",
+	"js_heap_bytes",
+	"dom_nodes",
+	"requests",
+	"bytes_read",
+	"web_rss_bytes",
+};
+
+
+/*
+ * Writes a copy of the greeter config file that selects `theme` and the mock backend
+ * to a temporary file. The web extension reads it through GREETER_CONFIG_FILE_ENV, so
+ * everything else is configured the way it is in production.
+ *
+ * Returns the path of the copy. Free it with g_free() once it has been deleted.
+ */
+gchar *
+theme_benchmark_write_config(GKeyFile *keyfile, const gchar *theme, GError **error) {
+	gchar *path = NULL;
+	gint fd;
+
+	g_key_file_set_string(keyfile, "greeter", "webkit_theme", theme);
+	g_key_file_set_boolean(keyfile, "greeter", "mock_backend", TRUE);
+	/* Not a greeter anyone is looking at */
+	g_key_file_set_boolean(keyfile, "greeter", "metrics_socket", FALSE);
+
+	fd = g_file_open_tmp("lightdm-webkit2-greeter-benchmark-XXXXXX.conf", &path, error);
+
+	if (-1 == fd) {
+		return NULL;
+	}
+
+	close(fd);
+
+	if (! g_key_file_save_to_file(keyfile, path, error)) {
+		g_unlink(path);
+		g_free(path);
+		return NULL;
+	}
+
+	return path;
+}
+
+
+/*
+ * Prints one result of the running iteration. Negative values are unknown and skipped.
+ */
+void
+theme_benchmark_report(ThemeBenchmarkMetric metric, gdouble value) {
+	gchar buffer[G_ASCII_DTOSTR_BUF_SIZE];
+
+	if (value < 0) {
+		return;
+	}
+
+	g_print(RESULT_PREFIX "%s %s\n", metric_names[metric], g_ascii_formatd(buffer, sizeof(buffer), "%.1f", value));
+}
+
+
+/*
+ * Adds the results in an iteration's output to `results`, one GArray of gdouble per metric.
+ */
+static void
+parse_iteration_output(const gchar *output, GArray **results) {
+	gchar **lines, **line, **fields;
+	gdouble value;
+	guint metric;
+
+	lines = g_strsplit(output, "\n", -1);
+
+	for (line = lines; NULL != *line; line++) {
+		if (! g_str_has_prefix(*line, RESULT_PREFIX)) {
+			continue;
+		}
+
+		fields = g_strsplit(*line + strlen(RESULT_PREFIX), " ", 2);
+
+		for (metric = 0; NULL != fields[0] && NULL != fields[1] && metric < THEME_BENCHMARK_COUNT; metric++) {
+			if (0 == g_strcmp0(fields[0], metric_names[metric])) {
+				value = g_ascii_strtod(fields[1], NULL);
+				g_array_append_val(results[metric], value);
+				break;
+			}
+		}
+
+		g_strfreev(fields);
+	}
+
+	g_strfreev(lines);
+}
+
+
+static void
+print_summary(const gchar *theme, gint iterations, GArray **results) {
+	gdouble *values;
+	guint metric, n_values;
+
+	g_print("%s: %d iterations\n", theme, iterations);
+	g_print("%-16s %14s %14s %14s\n", "metric", "median", "min", "max");
+
+	for (metric = 0; metric < THEME_BENCHMARK_COUNT; metric++) {
+		values = (gdouble *) results[metric]->data;
+		n_values = results[metric]->len;
+
+		if (0 == n_values) {
+			g_print("%-16s %14s %14s %14s\n", metric_names[metric], "n/a", "n/a", "n/a");
+			continue;
+		}
+
+		qsort(values, n_values, sizeof(gdouble), sample_window_compare_doubles);
+
+		g_print(
+			"%-16s %14.1f %14.1f %14.1f\n",
+			metric_names[metric],
+			(0 == n_values % 2) ? (values[n_values / 2 - 1] + values[n_values / 2]) / 2 : values[n_values / 2],
+			values[0],
+			values[n_values - 1]
+		);
+	}
+}
+
+
+/*
+ * Runs `program --benchmark-theme theme` `iterations` times and prints the median,
+ * minimum and maximum of each result. Fails if any iteration failed.
+ */
+gboolean
+theme_benchmark_run_iterations(const gchar *program, const gchar *theme, gint iterations) {
+	GArray *results[THEME_BENCHMARK_COUNT];
+	gchar *argv[] = {(gchar *) program, "--benchmark-theme", (gchar *) theme, NULL};
+	gchar *output;
+	gint i, status;
+	guint metric;
+	gboolean success = TRUE;
+	GError *err = NULL;
+
+	for (metric = 0; metric < THEME_BENCHMARK_COUNT; metric++) {
+		results[metric] = g_array_new(FALSE, FALSE, sizeof(gdouble));
+	}
+
+	for (i = 0; i < iterations && success; i++) {
+		output = NULL;
+
+		if (! g_spawn_sync(NULL, argv, NULL, G_SPAWN_SEARCH_PATH, NULL, NULL, &output, NULL, &status, &err)) {
+			g_printerr("Unable to run %s: %s\n", program, err->message);
+			g_clear_error(&err);
+			success = FALSE;
+
+		} else if (! g_spawn_check_exit_status(status, &err)) {
+			g_printerr("Iteration %d failed: %s\n", i + 1, err->message);
+			g_clear_error(&err);
+			success = FALSE;
+
+		} else {
+			parse_iteration_output(output, results);
+		}
+
+		g_free(output);
+	}
+
+	if (success) {
+		print_summary(theme, iterations, results);
+	}
+
+	for (metric = 0; metric < THEME_BENCHMARK_COUNT; metric++) {
+		g_array_free(results[metric], TRUE);
+	}
+
+	return success;
+}
@@ -0,0 +1,65 @@
+/*
+ * theme-benchmark.h
+ *
+ * Copyright © 2017 Antergos Developers <dev@antergos.com>
+ *
+ * This file is part of lightdm-webkit2-greeter.
+ *
+ * lightdm-webkit2-greeter is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * lightdm-webkit2-greeter is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * The following additional terms are in effect as per Section 7 of the license:
+ *
+ * The preservation of all legal notices and author attributions in
+ * the material or in the Appropriate Legal Notices displayed
+ * by works containing it is required.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with lightdm-webkit2-greeter; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* `lightdm-webkit2-greeter --benchmark-theme <name>` starts the greeter the usual way,
+ * but with the mock backend (see greeter-backend.c) and the given theme. It prints how
+ * long the theme took to paint and to become ready and what it cost, then exits. With
+ * `--iterations N` the greeter runs itself N times, so that every iteration is a cold
+ * start, and prints a summary instead.
+ */
+
+#ifndef THEME_BENCHMARK_H
+#define THEME_BENCHMARK_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef enum {
+	THEME_BENCHMARK_FIRST_PAINT,   /* Milliseconds since main() */
+	THEME_BENCHMARK_THEME_READY,   /* Milliseconds since main() */
+	THEME_BENCHMARK_JS_HEAP,       /* Bytes */
+	THEME_BENCHMARK_DOM_NODES,
+	THEME_BENCHMARK_REQUESTS,
+	THEME_BENCHMARK_BYTES_READ,    /* By the web process */
+	THEME_BENCHMARK_WEB_RSS,       /* Bytes */
+	THEME_BENCHMARK_COUNT,
+} ThemeBenchmarkMetric;
+
+
+gchar *
+theme_benchmark_write_config(GKeyFile *keyfile, const gchar *theme, GError **error);
+
+void
+theme_benchmark_report(ThemeBenchmarkMetric metric, gdouble value);
+
+gboolean
+theme_benchmark_run_iterations(const gchar *program, const gchar *theme, gint iterations);
+
+G_END_DECLS
+
+#endif /* THEME_BENCHMARK_H */
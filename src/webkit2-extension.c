@@ -39,12 +39,28 @@
 #define _GNU_SOURCE
 #include <stdlib.h>
 #include <unistd.h>
+#include <time.h>
+#include <math.h>
+#include <locale.h>
+#include <langinfo.h>
 #include <glib.h>
 #include <gtk/gtk.h>
 #include <glib/gi18n.h>
 #include <glib/gstdio.h>
+#include <gmodule.h>
 
 #include "config.h"
+#include "text-escape.h"
+#include "greeter-messages.h"
+#include "process-stats.h"
+#include "latency-histogram.h"
+#include "greeter-paths.h"
+#include "greeter-backend.h"
+#include "metrics-text.h"
+#include "greeter-trace.h"
+#include "avatar-cache.h"
+#include "language-cache.h"
+#include "session-catalog.h"
 
 #ifdef HAS_WEBKITGTK_2_16
 #include <webkitdom/webkitdom.h>
@@ -68,16 +84,27 @@
  */
 #define USER     ((LightDMUser *)     JSObjectGetPrivate (thisObject))
 #define LAYOUT   ((LightDMLayout *)   JSObjectGetPrivate (thisObject))
-#define SESSION  ((LightDMSession *)  JSObjectGetPrivate (thisObject))
 #define GREETER  ((LightDMGreeter *)  JSObjectGetPrivate (thisObject))
-#define LANGUAGE ((LightDMLanguage *) JSObjectGetPrivate (thisObject))
 
 
 /*
  * Error messages
  */
-#define EXPECTSTRING   "Expected a string"
-#define ARGNOTSUPPLIED "Argument(s) not supplied"
+#define EXPECTSTRING     "Expected a string"
+#define ARGNOTSUPPLIED   "Argument(s) not supplied"
+#define EXPECTARRAY      "Expected an array"
+#define ARRAYTOOLONG     "Array is too long"
+#define NOTAUTHENTICATED "Not authenticated"
+
+/* Longest array a bridge function copies, see get_array_length() */
+#define MAX_ARRAY_LENGTH 65536
+
+
+/* Loaded on demand, see load_moment_cb() */
+#define MOMENT_JS_PATH THEME_DIR "/_vendor/js/moment-with-locales.min.js"
+
+/* Size (pixels) of the thumbnail returned by LightDMUser.image, see avatar-cache.c */
+#define AVATAR_DEFAULT_SIZE 256
 
 G_MODULE_EXPORT void webkit_web_extension_initialize(WebKitWebExtension *extension);
 
@@ -91,17 +118,25 @@ static JSClassRef
 	lightdm_greeter_class,
 	gettext_class,
 	lightdm_user_class,
-	lightdm_language_class,
 	lightdm_layout_class,
-	lightdm_session_class,
 	greeter_config_class,
-	theme_utils_class;
+	theme_utils_class,
+	greeter_bridge_class;
 
 static gboolean
-	detect_theme_errors,
 	secure_mode,
+	debug_mode,
+	metrics_socket,
+	display_blanked,
 	SESSION_STARTING;
 
+/* Outcome of web_page_send_request_cb(), for the metrics socket and --benchmark-theme */
+static guint64
+	requests_allowed,
+	requests_blocked;
+
+static WakeupCounter wakeup_counter;
+
 static gchar
 	*background_images_dir,
 	*user_image,
@@ -109,6 +144,33 @@ static gchar
 
 static WebKitWebExtension *WEB_EXTENSION;
 
+/* Frozen JS records that are handed out until their source changes, see get_prebuilt_array() */
+typedef struct {
+	JSGlobalContextRef context;
+	GPtrArray *records;     /* Protected JSObjectRefs */
+	guint generation;
+} PrebuiltArray;
+
+typedef void (*PrebuiltArrayBuilder) (JSContextRef context, GPtrArray *records);
+
+static PrebuiltArray
+	prebuilt_languages,
+	prebuilt_sessions;
+
+static GHashTable *web_message_handlers_table;
+
+/* greeter-clock-tick, see schedule_clock_tick() */
+#define DEFAULT_CLOCK_TICK_INTERVAL 60
+
+static gchar
+	*clock_time_format,
+	*clock_time_language;
+
+static gint clock_tick_interval;
+static guint clock_tick_id;
+
+static void schedule_clock_tick(void);
+
 
 /*
  * Returns either a string or null.
@@ -202,42 +264,69 @@ arg_to_string(JSContextRef context, JSValueRef arg, JSValueRef *exception) {
 
 
 /*
- * g_strreplace
- *
- * Replace one substring with another.  NOTE:  This has the side effect
- * of freeing it's passed text.
+ * Sends a message to the UI process. A floating `parameters` reference is consumed.
  */
-static gchar *
-g_strreplace (gchar *txt, gchar *from, gchar *to) {
-	gchar **split;
-	gchar *result;
+static void
+send_message_to_ui_process(const gchar *name, GVariant *parameters) {
+	WebKitWebPage *web_page;
 
-	split = g_strsplit (txt, from, -1);
-	g_free (txt);
-	result = g_strjoinv (to, split);
-	g_strfreev (split);
-	return result;
+	g_variant_ref_sink(parameters);
+	web_page = webkit_web_extension_get_page(WEB_EXTENSION, page_id);
+
+	if (NULL == web_page) {
+		g_variant_unref(parameters);
+		return;
+	}
+
+	#ifdef HAS_WEBKITGTK_2_28
+	webkit_web_page_send_message_to_view(
+		web_page,
+		webkit_user_message_new(name, parameters),
+		NULL,
+		NULL,
+		NULL
+	);
+	#else
+	WebKitDOMDOMWindow *dom_window;
+	WebKitDOMDocument *dom_document;
+	gchar *message;
+
+	dom_document = webkit_web_page_get_dom_document(web_page);
+	dom_window = webkit_dom_document_get_default_view(dom_document);
+
+	if (dom_window) {
+		message = greeter_message_serialize(name, parameters);
+		webkit_dom_dom_window_webkit_message_handlers_post_message(dom_window, "GreeterBridge", message);
+		g_free(message);
+	}
+	#endif
+
+	g_variant_unref(parameters);
 }
 
 
 /*
- * Escapes single quote characters in a string.
- *
- * Simple escape function to make sure strings have any/all single
- * quote characters escaped.
+ * Evaluates a script in the main frame of the greeter's web page.
  */
-static char *
-escape(const gchar *text) {
-	gchar *escaped;
-	gchar *result;
+static void
+evaluate_script_in_page(const gchar *script) {
+	WebKitWebPage *web_page;
+	WebKitFrame *web_frame;
+	JSGlobalContextRef jsContext;
+	JSStringRef command;
+
+	web_page = webkit_web_extension_get_page(WEB_EXTENSION, page_id);
 
-	/* Make sure all newlines, tabs, etc. are escaped. */
-	escaped = g_strescape (text, NULL);
+	if (NULL == web_page) {
+		return;
+	}
 
-	/* Replace ' with \\' */
-	result = g_strreplace (escaped, "'", "\\'");
+	web_frame = webkit_web_page_get_main_frame(web_page);
+	jsContext = webkit_frame_get_javascript_global_context(web_frame);
+	command = JSStringCreateWithUTF8CString(script);
 
-	return result;
+	JSEvaluateScript(jsContext, command, NULL, NULL, 0, NULL);
+	JSStringRelease(command);
 }
 
 
@@ -246,7 +335,7 @@ get_user_name_cb(JSContextRef context,
 				 JSObjectRef thisObject,
 				 JSStringRef propertyName,
 				 JSValueRef *exception) {
-	return string_or_null(context, lightdm_user_get_name(USER));
+	return string_or_null(context, greeter_backend_user_get_name(USER));
 }
 
 
@@ -255,7 +344,7 @@ get_user_real_name_cb(JSContextRef context,
 					  JSObjectRef thisObject,
 					  JSStringRef propertyName,
 					  JSValueRef *exception) {
-	return string_or_null(context, lightdm_user_get_real_name(USER));
+	return string_or_null(context, greeter_backend_user_get_real_name(USER));
 }
 
 
@@ -264,7 +353,7 @@ get_user_display_name_cb(JSContextRef context,
 						 JSObjectRef thisObject,
 						 JSStringRef propertyName,
 						 JSValueRef *exception) {
-	return string_or_null(context, lightdm_user_get_display_name(USER));
+	return string_or_null(context, greeter_backend_user_get_display_name(USER));
 }
 
 
@@ -273,7 +362,46 @@ get_user_home_directory_cb(JSContextRef context,
 						   JSObjectRef thisObject,
 						   JSStringRef propertyName,
 						   JSValueRef *exception) {
-	return string_or_null(context, lightdm_user_get_home_directory(USER));
+	return string_or_null(context, greeter_backend_user_get_home_directory(USER));
+}
+
+
+/*
+ * Lets the page load `path` (an avatar or its thumbnail) unless it is already allowed.
+ */
+static void
+allow_path(const gchar *path) {
+	// Determine if we already checked this path
+	for (iter = paths; iter; iter = iter->next) {
+		if (0 == g_strcmp0(path, iter->data)) {
+			// We've already checked this path, no need to continue further.
+			return;
+		}
+	}
+
+	paths = g_slist_prepend(paths, g_strdup(path));
+}
+
+
+/*
+ * Returns the thumbnail URL of the user's image at `size` pixels. The original is returned
+ * while the thumbnail is being made and greeter-user-image-ready fires once it's done.
+ */
+static JSValueRef
+user_image_at_size(JSContextRef context, LightDMUser *user, gint size) {
+	gchar *image = avatar_cache_lookup(greeter_backend_user_get_image(user), size);
+	JSValueRef result;
+
+	if (NULL == image) {
+		// Path is not accessible.
+		return JSValueMakeNull(context);
+	}
+
+	allow_path(image);
+	result = string_or_null(context, image);
+	g_free(image);
+
+	return result;
 }
 
 
@@ -282,33 +410,30 @@ get_user_image_cb(JSContextRef context,
 				  JSObjectRef thisObject,
 				  JSStringRef propertyName,
 				  JSValueRef *exception) {
+	return user_image_at_size(context, USER, AVATAR_DEFAULT_SIZE);
+}
 
-	const gchar *image = lightdm_user_get_image(USER);
-	gchar *image_path;
-	gint  result;
 
-	// Determine if we already checked this path
-	for (iter = paths; iter; iter = iter->next) {
-		if (0 == g_strcmp0(image, iter->data)) {
-			// We've already checked this path, no need to continue further.
-			return string_or_null(context, image);
-		}
-	}
+static JSValueRef
+get_user_image_at_size_cb(JSContextRef context,
+						  JSObjectRef function,
+						  JSObjectRef thisObject,
+						  size_t argumentCount,
+						  const JSValueRef arguments[],
+						  JSValueRef *exception) {
+	gdouble size;
 
-	image_path = g_strdup(image);
-	result = g_access(image_path, R_OK);
+	if (argumentCount != 1) {
+		return mkexception(context, exception, ARGNOTSUPPLIED);
+	}
 
-	if (0 == result) {
-		// Path is accessible. Add it to our paths list.
-		paths = g_slist_prepend(paths, image_path);
+	size = JSValueToNumber(context, arguments[0], exception);
 
-		return string_or_null(context, image);
+	if (isnan(size)) {
+		return JSValueMakeNull(context);
 	}
 
-	// Path is not accessible.
-	g_free(image_path);
-
-	return JSValueMakeNull(context);
+	return user_image_at_size(context, USER, (gint) CLAMP(size, AVATAR_CACHE_MIN_SIZE, AVATAR_CACHE_MAX_SIZE));
 }
 
 
@@ -317,7 +442,7 @@ get_user_language_cb(JSContextRef context,
 					 JSObjectRef thisObject,
 					 JSStringRef propertyName,
 					 JSValueRef *exception) {
-	return string_or_null(context, lightdm_user_get_language(USER));
+	return string_or_null(context, greeter_backend_user_get_language(USER));
 }
 
 
@@ -326,7 +451,7 @@ get_user_layout_cb(JSContextRef context,
 				   JSObjectRef thisObject,
 				   JSStringRef propertyName,
 				   JSValueRef *exception) {
-	return string_or_null(context, lightdm_user_get_layout(USER));
+	return string_or_null(context, greeter_backend_user_get_layout(USER));
 }
 
 
@@ -335,7 +460,7 @@ get_user_session_cb(JSContextRef context,
 					JSObjectRef thisObject,
 					JSStringRef propertyName,
 					JSValueRef *exception) {
-	return string_or_null(context, lightdm_user_get_session(USER));
+	return string_or_null(context, greeter_backend_user_get_session(USER));
 }
 
 
@@ -344,34 +469,7 @@ get_user_logged_in_cb(JSContextRef context,
 					  JSObjectRef thisObject,
 					  JSStringRef propertyName,
 					  JSValueRef *exception) {
-	return JSValueMakeBoolean(context, lightdm_user_get_logged_in(USER));
-}
-
-
-static JSValueRef
-get_language_code_cb(JSContextRef context,
-					 JSObjectRef thisObject,
-					 JSStringRef propertyName,
-					 JSValueRef *exception) {
-	return string_or_null(context, lightdm_language_get_code(LANGUAGE));
-}
-
-
-static JSValueRef
-get_language_name_cb(JSContextRef context,
-					 JSObjectRef thisObject,
-					 JSStringRef propertyName,
-					 JSValueRef *exception) {
-	return string_or_null(context, lightdm_language_get_name(LANGUAGE));
-}
-
-
-static JSValueRef
-get_language_territory_cb(JSContextRef context,
-						  JSObjectRef thisObject,
-						  JSStringRef propertyName,
-						  JSValueRef *exception) {
-	return string_or_null(context, lightdm_language_get_territory(LANGUAGE));
+	return JSValueMakeBoolean(context, greeter_backend_user_get_logged_in(USER));
 }
 
 
@@ -380,7 +478,7 @@ get_layout_name_cb(JSContextRef context,
 				   JSObjectRef thisObject,
 				   JSStringRef propertyName,
 				   JSValueRef *exception) {
-	return string_or_null(context, lightdm_layout_get_name(LAYOUT));
+	return string_or_null(context, greeter_backend_layout_get_name(LAYOUT));
 }
 
 
@@ -389,7 +487,7 @@ get_layout_short_description_cb(JSContextRef context,
 								JSObjectRef thisObject,
 								JSStringRef propertyName,
 								JSValueRef *exception) {
-	return string_or_null(context, lightdm_layout_get_short_description(LAYOUT));
+	return string_or_null(context, greeter_backend_layout_get_short_description(LAYOUT));
 }
 
 
@@ -398,34 +496,7 @@ get_layout_description_cb(JSContextRef context,
 						  JSObjectRef thisObject,
 						  JSStringRef propertyName,
 						  JSValueRef *exception) {
-	return string_or_null(context, lightdm_layout_get_description(LAYOUT));
-}
-
-
-static JSValueRef
-get_session_key_cb(JSContextRef context,
-				   JSObjectRef thisObject,
-				   JSStringRef propertyName,
-				   JSValueRef *exception) {
-	return string_or_null(context, lightdm_session_get_key(SESSION));
-}
-
-
-static JSValueRef
-get_session_name_cb(JSContextRef context,
-					JSObjectRef thisObject,
-					JSStringRef propertyName,
-					JSValueRef *exception) {
-	return string_or_null(context, lightdm_session_get_name(SESSION));
-}
-
-
-static JSValueRef
-get_session_comment_cb(JSContextRef context,
-					   JSObjectRef thisObject,
-					   JSStringRef propertyName,
-					   JSValueRef *exception) {
-	return string_or_null(context, lightdm_session_get_comment(SESSION));
+	return string_or_null(context, greeter_backend_layout_get_description(LAYOUT));
 }
 
 
@@ -445,7 +516,7 @@ get_num_users_cb(JSContextRef context,
 				 JSValueRef *exception) {
 	return JSValueMakeNumber(
 		context,
-		g_list_length(lightdm_user_list_get_users(lightdm_user_list_get_instance()))
+		g_list_length(greeter_backend_get_users())
 	);
 }
 
@@ -461,7 +532,7 @@ get_users_cb(JSContextRef context,
 	guint i, n_users = 0;
 	JSValueRef *args;
 
-	users = lightdm_user_list_get_users(lightdm_user_list_get_instance());
+	users = greeter_backend_get_users();
 	n_users = g_list_length((GList *) users);
 	args = g_malloc(sizeof(JSValueRef) * ( n_users + 1 ));
 
@@ -482,44 +553,173 @@ get_users_cb(JSContextRef context,
 }
 
 
+/*
+ * Calls Object.freeze() on `object`. The C API has no way to make an object non-extensible.
+ */
+static void
+js_object_freeze(JSContextRef context, JSObjectRef object) {
+	JSStringRef script = JSStringCreateWithUTF8CString("Object.freeze");
+	JSValueRef freeze, argument = object;
+
+	freeze = JSEvaluateScript(context, script, NULL, NULL, 0, NULL);
+	JSStringRelease(script);
+
+	if (NULL != freeze && JSValueIsObject(context, freeze) && JSObjectIsFunction(context, (JSObjectRef) freeze)) {
+		JSObjectCallAsFunction(context, (JSObjectRef) freeze, NULL, 1, &argument, NULL);
+	}
+}
+
+
+/*
+ * Returns a frozen plain object with the properties `names` set to `values`.
+ */
+static JSObjectRef
+make_record(JSContextRef context, const gchar * const *names, const gchar * const *values, guint n_values) {
+	JSObjectRef object = JSObjectMake(context, NULL, NULL);
+	guint i;
+
+	for (i = 0; i < n_values; i++) {
+		JSStringRef name = JSStringCreateWithUTF8CString(names[i]);
+
+		JSObjectSetProperty(context, object, name, string_or_null(context, values[i]), kJSPropertyAttributeReadOnly, NULL);
+		JSStringRelease(name);
+	}
+
+	/* Records are shared by every copy of their array, see get_prebuilt_array() */
+	js_object_freeze(context, object);
+
+	return object;
+}
+
+
+/*
+ * Adds `record` to the records a PrebuiltArrayBuilder builds. It is protected right away,
+ * making the next one may run the garbage collector.
+ */
+static void
+prebuilt_array_add(JSContextRef context, GPtrArray *records, JSObjectRef record) {
+	JSValueProtect(context, record);
+	g_ptr_array_add(records, (gpointer) record);
+}
+
+
+/*
+ * Lets go of `prebuilt`'s records and the page they were made for.
+ */
+static void
+prebuilt_array_clear(PrebuiltArray *prebuilt) {
+	guint i;
+
+	if (NULL == prebuilt->context) {
+		return;
+	}
+
+	for (i = 0; i < prebuilt->records->len; i++) {
+		JSValueUnprotect(prebuilt->context, g_ptr_array_index(prebuilt->records, i));
+	}
+
+	g_ptr_array_free(prebuilt->records, TRUE);
+	JSGlobalContextRelease(prebuilt->context);
+
+	prebuilt->context = NULL;
+	prebuilt->records = NULL;
+}
+
+
+/*
+ * Returns a new array of `prebuilt`'s records, building them first if they were made for
+ * another page or an older `generation` of their source. Only the array is new, so a
+ * theme that sorts or splices it doesn't change it for anyone else.
+ */
 static JSValueRef
-get_languages_cb(JSContextRef context,
-				 JSObjectRef thisObject,
-				 JSStringRef propertyName,
-				 JSValueRef *exception) {
+get_prebuilt_array(JSContextRef context,
+				   PrebuiltArray *prebuilt,
+				   guint generation,
+				   PrebuiltArrayBuilder build,
+				   JSValueRef *exception) {
 
+	JSGlobalContextRef global_context = JSContextGetGlobalContext(context);
 	JSObjectRef array;
-	const GList *languages, *link;
-	guint i, n_languages = 0;
-	JSValueRef *args;
 
-	languages = lightdm_get_languages();
-	n_languages = g_list_length((GList *) languages);
-	args = g_malloc(sizeof(JSValueRef) * ( n_languages + 1 ));
+	if (global_context != prebuilt->context || generation != prebuilt->generation) {
+		prebuilt_array_clear(prebuilt);
+
+		prebuilt->records = g_ptr_array_new();
+		build(context, prebuilt->records);
 
-	for (i = 0, link = languages; link; i++, link = link->next) {
-		LightDMLanguage *language = link->data;
-		g_object_ref(language);
-		args[i] = JSObjectMake(context, lightdm_language_class, language);
+		prebuilt->context = JSGlobalContextRetain(global_context);
+		prebuilt->generation = generation;
 	}
 
-	array = JSObjectMakeArray(context, n_languages, args, exception);
-	g_free(args);
+	array = JSObjectMakeArray(context, prebuilt->records->len, (const JSValueRef *) prebuilt->records->pdata, exception);
 
-	if (array == NULL) {
-		return JSValueMakeNull(context);
-	} else {
-		return array;
+	return (NULL != array) ? array : JSValueMakeNull(context);
+}
+
+
+/*
+ * Builds the records of lightdm.languages from the list language-cache.c prepared while
+ * the extension was starting, or from the mock backend.
+ */
+static void
+make_language_records(JSContextRef context, GPtrArray *records) {
+	static const gchar * const names[] = {"code", "name", "territory"};
+	GPtrArray *languages;
+	const GList *link;
+	guint i;
+
+	if (greeter_backend_is_mock()) {
+		for (link = greeter_backend_get_languages(); link; link = link->next) {
+			const gchar *values[] = {
+				greeter_backend_language_get_code(link->data),
+				greeter_backend_language_get_name(link->data),
+				greeter_backend_language_get_territory(link->data),
+			};
+
+			prebuilt_array_add(context, records, make_record(context, names, values, G_N_ELEMENTS(values)));
+		}
+
+		return;
+	}
+
+	languages = language_cache_get();
+
+	for (i = 0; i < languages->len; i++) {
+		CachedLanguage *language = g_ptr_array_index(languages, i);
+		const gchar *values[] = {language->code, language->name, language->territory};
+
+		prebuilt_array_add(context, records, make_record(context, names, values, G_N_ELEMENTS(values)));
 	}
 }
 
 
+/*
+ * The records are built once per page, every call only makes a new array of them.
+ */
+static JSValueRef
+get_languages_cb(JSContextRef context,
+				 JSObjectRef thisObject,
+				 JSStringRef propertyName,
+				 JSValueRef *exception) {
+	return get_prebuilt_array(context, &prebuilt_languages, 0, make_language_records, exception);
+}
+
+
 static JSValueRef
 get_language_cb(JSContextRef context,
 				JSObjectRef thisObject,
 				JSStringRef propertyName,
 				JSValueRef *exception) {
-	return string_or_null(context, lightdm_language_get_name(lightdm_get_language()));
+	const CachedLanguage *language;
+
+	if (greeter_backend_is_mock()) {
+		return string_or_null(context, greeter_backend_language_get_name(greeter_backend_get_language()));
+	}
+
+	// Same as lightdm_get_language() without waiting for `locale -a`
+	language = language_cache_find(g_getenv("LANG"));
+
+	return string_or_null(context, (NULL != language) ? language->name : NULL);
 }
 
 
@@ -534,7 +734,7 @@ get_layouts_cb(JSContextRef context,
 	guint i, n_layouts = 0;
 	JSValueRef *args;
 
-	layouts = lightdm_get_layouts();
+	layouts = greeter_backend_get_layouts();
 	n_layouts = g_list_length((GList *) layouts);
 	args = g_malloc(sizeof(JSValueRef) * ( n_layouts + 1 ));
 
@@ -560,7 +760,7 @@ get_layout_cb(JSContextRef context,
 			  JSObjectRef thisObject,
 			  JSStringRef propertyName,
 			  JSValueRef *exception) {
-	return string_or_null(context, lightdm_layout_get_name(lightdm_get_layout()));
+	return string_or_null(context, greeter_backend_layout_get_name(greeter_backend_get_layout()));
 }
 
 
@@ -579,14 +779,14 @@ set_layout_cb(JSContextRef context,
 		return false;
 	}
 
-	layouts = lightdm_get_layouts();
+	layouts = greeter_backend_get_layouts();
 
 	for (link = layouts; link; link = link->next) {
 		LightDMLayout *currlayout = link->data;
 
-		if (!( g_strcmp0(lightdm_layout_get_name(currlayout), layout))) {
+		if (!( g_strcmp0(greeter_backend_layout_get_name(currlayout), layout))) {
 			g_object_ref(currlayout);
-			lightdm_set_layout(currlayout);
+			greeter_backend_set_layout(currlayout);
 			break;
 		}
 	}
@@ -597,36 +797,58 @@ set_layout_cb(JSContextRef context,
 }
 
 
+/*
+ * Builds the records of lightdm.sessions from session-catalog.c or the mock backend.
+ */
+static void
+make_session_records(JSContextRef context, GPtrArray *records) {
+	static const gchar * const names[] = {"key", "name", "comment"};
+	GPtrArray *sessions;
+	const GList *link;
+	guint i;
+
+	if (greeter_backend_is_mock()) {
+		for (link = greeter_backend_get_sessions(); link; link = link->next) {
+			const gchar *values[] = {
+				greeter_backend_session_get_key(link->data),
+				greeter_backend_session_get_name(link->data),
+				greeter_backend_session_get_comment(link->data),
+			};
+
+			prebuilt_array_add(context, records, make_record(context, names, values, G_N_ELEMENTS(values)));
+		}
+
+		return;
+	}
+
+	sessions = session_catalog_get(NULL);
+
+	for (i = 0; i < sessions->len; i++) {
+		CatalogSession *session = g_ptr_array_index(sessions, i);
+		const gchar *values[] = {session->key, session->name, session->comment};
+
+		prebuilt_array_add(context, records, make_record(context, names, values, G_N_ELEMENTS(values)));
+	}
+}
+
+
+/*
+ * The records are rebuilt when the session catalog changes (never for the mock backend),
+ * every call only makes a new array of them.
+ */
 static JSValueRef
 get_sessions_cb(JSContextRef context,
 				JSObjectRef thisObject,
 				JSStringRef propertyName,
 				JSValueRef *exception) {
 
-	JSObjectRef array;
-	const GList *sessions, *link;
-	guint i, n_sessions = 0;
-	JSValueRef *args;
-
-	sessions = lightdm_get_sessions();
-	n_sessions = g_list_length((GList *) sessions);
-	args = g_malloc(sizeof(JSValueRef) * ( n_sessions + 1 ));
-
-	for (i = 0, link = sessions; link; i++, link = link->next) {
-		LightDMSession *session = link->data;
-		g_object_ref(session);
+	guint generation = 0;
 
-		args[i] = JSObjectMake(context, lightdm_session_class, session);
+	if (! greeter_backend_is_mock()) {
+		session_catalog_get(&generation);
 	}
 
-	array = JSObjectMakeArray(context, n_sessions, args, exception);
-	g_free(args);
-
-	if (array == NULL) {
-		return JSValueMakeNull(context);
-	} else {
-		return array;
-	}
+	return get_prebuilt_array(context, &prebuilt_sessions, generation, make_session_records, exception);
 }
 
 
@@ -645,7 +867,7 @@ get_default_session_cb(JSContextRef context,
 					   JSObjectRef thisObject,
 					   JSStringRef propertyName,
 					   JSValueRef *exception) {
-	return string_or_null(context, lightdm_greeter_get_default_session_hint(GREETER));
+	return string_or_null(context, greeter_backend_get_default_session_hint(GREETER));
 }
 
 
@@ -681,32 +903,458 @@ cancel_autologin_cb(JSContextRef context,
 }
 
 
-static JSValueRef
-authenticate_cb(JSContextRef context,
-				JSObjectRef function,
-				JSObjectRef thisObject,
-				size_t argumentCount,
-				const JSValueRef arguments[],
-				JSValueRef *exception) {
-
-	gchar *name = NULL;
+/*
+ * PAM conversation latency
+ *
+ * To tell slow PAM modules from a slow daemon or theme, we time each phase of a
+ * conversation: authenticate -> first prompt (or message), respond -> next prompt (or
+ * completion) and completion -> session start. Only durations are recorded, never
+ * usernames, prompts or responses. Logged and exposed through __GreeterBridge in debug mode.
+ */
 
-	if (argumentCount > 0) {
-		name = arg_to_string(context, arguments[0], exception);
-	}
+typedef enum {
+	AUTH_PHASE_FIRST_PROMPT,
+	AUTH_PHASE_RESPONSE,
+	AUTH_PHASE_SESSION_START,
+	AUTH_PHASE_COUNT,
+} AuthPhase;
+
+static LatencyHistogram auth_latency[AUTH_PHASE_COUNT] = {
+	{"authenticate -> first prompt"},
+	{"respond -> next prompt"},
+	{"complete -> session start"},
+};
 
-	#ifdef HAS_LIGHTDM_1_19_2
-	GError *err = NULL;
+/* Monotonic time the current phase started or 0 */
+static gint64
+	auth_started,
+	auth_responded,
+	auth_completed;
 
-	lightdm_greeter_authenticate(GREETER, name, &err);
+
+static void
+record_auth_latency(AuthPhase phase, gint64 *since) {
+	if (0 == *since) {
+		return;
+	}
+
+	latency_histogram_add(&auth_latency[phase], (g_get_monotonic_time() - *since) / 1000);
+	*since = 0;
+}
+
+
+static void
+log_auth_latency(void) {
+	gchar *histogram;
+	guint i;
+
+	if (! debug_mode) {
+		return;
+	}
+
+	for (i = 0; i < AUTH_PHASE_COUNT; i++) {
+		histogram = latency_histogram_to_string(&auth_latency[i]);
+		g_message("PAM latency %s", histogram);
+		g_free(histogram);
+	}
+}
+
+
+static void
+auth_conversation_started(void) {
+	auth_started = g_get_monotonic_time();
+	auth_responded = 0;
+	auth_completed = 0;
+}
+
+
+/*
+ * A prompt or message arrived, or the conversation completed.
+ */
+static void
+auth_conversation_progressed(void) {
+	record_auth_latency(AUTH_PHASE_FIRST_PROMPT, &auth_started);
+	record_auth_latency(AUTH_PHASE_RESPONSE, &auth_responded);
+}
+
+
+/*
+ * Frame pacing of the web view, measured by the UI process in debug mode (see
+ * frame-stats.h). The latest FrameStats message, sent about once a second while the web
+ * view draws, or NULL.
+ */
+static GVariant *frame_stats = NULL;
+
+
+/*
+ * Speculative authentication
+ *
+ * With network PAM modules (sssd, krb5) the first prompt can take a second or more to
+ * arrive. When speculative_authentication is enabled, we start the PAM conversation for
+ * the user the theme is most likely to pick (select_user_hint, the last user that logged
+ * in or a user the theme says has focus) before the theme asks for it. Prompts and
+ * messages are held back until the theme calls authenticate() for that same user, at
+ * which point they are delivered as if the conversation had just started.
+ *
+ * While a speculative conversation hasn't been claimed it is invisible to the theme:
+ * in_authentication is false and cancel_authentication() leaves it alone.
+ *
+ * A conversation can also succeed before it is claimed (password-less PAM, a cached
+ * krb5 ticket). Its completion is held back too, so the theme gets the whole head start.
+ */
+
+typedef enum {
+	AUTH_EVENT_PROMPT,
+	AUTH_EVENT_MESSAGE,
+	AUTH_EVENT_COMPLETE,
+} AuthEventKind;
+
+typedef struct {
+	AuthEventKind  kind;
+	gint           type;
+	gchar         *text;
+} AuthEvent;
+
+static gboolean speculative_authentication;
+static gboolean speculating;
+static gchar *speculative_user;
+static gint64 speculation_started;
+static GQueue speculative_events = G_QUEUE_INIT;
+
+/* Idle source delivering a claimed conversation's held back events or 0 */
+static guint speculative_delivery_id;
+
+
+static void
+auth_event_free(AuthEvent *event) {
+	g_free(event->text);
+	g_free(event);
+}
+
+
+static gchar *
+get_last_user_path(void) {
+	return g_build_filename(g_get_user_cache_dir(), "lightdm-webkit2-greeter", "last-user", NULL);
+}
+
+
+/*
+ * Returns the user that last started a session from this greeter or NULL.
+ */
+static gchar *
+get_last_user(void) {
+	gchar *path = get_last_user_path(), *user = NULL;
+
+	if (g_file_get_contents(path, &user, NULL, NULL)) {
+		g_strstrip(user);
+	}
+
+	g_free(path);
+
+	return user;
+}
+
+
+static void
+save_last_user(const gchar *user) {
+	gchar *path = get_last_user_path(), *dir = g_path_get_dirname(path);
+
+	if (NULL != user && 0 == g_mkdir_with_parents(dir, 0700)) {
+		g_file_set_contents(path, user, -1, NULL);
+	}
+
+	g_free(dir);
+	g_free(path);
+}
+
+
+static void
+deliver_prompt(const gchar *text, LightDMPromptType type) {
+	gchar *etext, *script;
+	const gchar *ct = "";
+
+	switch (type) {
+		case LIGHTDM_PROMPT_TYPE_QUESTION:
+			ct = "text";
+			break;
+		case LIGHTDM_PROMPT_TYPE_SECRET:
+			ct = "password";
+			break;
+	}
+
+	etext = text_escape(text, TEXT_ESCAPE_JS_STRING);
+	script = g_strdup_printf("show_prompt('%s', '%s')", etext, ct);
+
+	evaluate_script_in_page(script);
+
+	g_free(script);
+	g_free(etext);
+}
+
+
+static void
+deliver_message(const gchar *text, LightDMMessageType type) {
+	gchar *etext, *script;
+	const gchar *mt = "";
+
+	switch (type) {
+		case LIGHTDM_MESSAGE_TYPE_ERROR:
+			mt = "error";
+			break;
+		case LIGHTDM_MESSAGE_TYPE_INFO:
+			mt = "info";
+			break;
+	}
+
+	etext = text_escape(text, TEXT_ESCAPE_JS_STRING);
+	script = g_strdup_printf("show_prompt('%s', '%s')", etext, mt);
+
+	evaluate_script_in_page(script);
+
+	g_free(script);
+	g_free(etext);
+}
+
+
+/*
+ * Forgets the held back events of a conversation that is gone.
+ */
+static void
+drop_speculative_events(void) {
+	if (0 != speculative_delivery_id) {
+		g_source_remove(speculative_delivery_id);
+		speculative_delivery_id = 0;
+	}
+
+	g_queue_foreach(&speculative_events, (GFunc) auth_event_free, NULL);
+	g_queue_clear(&speculative_events);
+}
+
+
+/*
+ * Delivers the held back events of a claimed conversation now. Called before anything
+ * newer from the conversation reaches the theme, so it sees them in order.
+ */
+static void
+deliver_speculative_events(void) {
+	AuthEvent *event;
+
+	if (0 != speculative_delivery_id) {
+		g_source_remove(speculative_delivery_id);
+		speculative_delivery_id = 0;
+	}
+
+	while (NULL != (event = g_queue_pop_head(&speculative_events))) {
+		if (AUTH_EVENT_PROMPT == event->kind) {
+			deliver_prompt(event->text, (LightDMPromptType) event->type);
+		} else if (AUTH_EVENT_MESSAGE == event->kind) {
+			deliver_message(event->text, (LightDMMessageType) event->type);
+		} else {
+			evaluate_script_in_page("authentication_complete()");
+		}
+
+		auth_event_free(event);
+	}
+}
+
+
+static void
+clear_speculation(void) {
+	drop_speculative_events();
+
+	g_free(speculative_user);
+	speculative_user = NULL;
+	speculating = FALSE;
+}
+
+
+/*
+ * Cancels the speculative conversation, if any, because the user went elsewhere.
+ */
+static void
+cancel_speculative_authentication(LightDMGreeter *greeter) {
+	if (! speculating) {
+		return;
+	}
+
+	g_debug("Cancelling speculative authentication for %s", speculative_user);
+
+	clear_speculation();
+
+	greeter_backend_cancel_authentication(greeter, NULL);
+}
+
+
+/*
+ * Starts a speculative conversation for `user` unless the theme has one of its own going,
+ * or we are already speculating for that user.
+ */
+static void
+start_speculative_authentication(LightDMGreeter *greeter, const gchar *user) {
+	GError *err = NULL;
+
+	if (! speculative_authentication || SESSION_STARTING || NULL == user || '\0' == *user) {
+		return;
+	}
+
+	if (speculating && 0 == g_strcmp0(user, speculative_user)) {
+		return;
+	}
+
+	if (! speculating && greeter_backend_get_in_authentication(greeter)) {
+		/* The theme's conversation, not ours to replace */
+		return;
+	}
+
+	cancel_speculative_authentication(greeter);
+
+	g_debug("Starting speculative authentication for %s", user);
+
+	greeter_backend_authenticate(greeter, user, &err);
+
+	if (NULL != err) {
+		g_warning("Speculative authentication failed to start: %s", err->message);
+		g_error_free(err);
+		return;
+	}
+
+	speculating = TRUE;
+	speculative_user = g_strdup(user);
+	speculation_started = g_get_monotonic_time();
+	auth_conversation_started();
+}
+
+
+static gboolean
+deliver_speculative_events_cb(gpointer user_data) {
+	speculative_delivery_id = 0;
+	deliver_speculative_events();
+
+	return G_SOURCE_REMOVE;
+}
+
+
+/*
+ * Hands the speculative conversation over to the theme if it is for `user`. Held back
+ * prompts are delivered from an idle callback so that authenticate() returns first, just
+ * like with a conversation that was started on demand, or right before the next event of
+ * the conversation if that comes first (see deliver_speculative_events()).
+ *
+ * Returns TRUE if the conversation was claimed.
+ */
+static gboolean
+claim_speculative_authentication(LightDMGreeter *greeter, const gchar *user) {
+	if (! speculating) {
+		return FALSE;
+	}
+
+	if (NULL == user || 0 != g_strcmp0(user, speculative_user)) {
+		cancel_speculative_authentication(greeter);
+		return FALSE;
+	}
+
+	g_debug(
+		"Claimed speculative authentication for %s after %" G_GINT64_FORMAT " ms (%u held back)",
+		user,
+		(g_get_monotonic_time() - speculation_started) / 1000,
+		g_queue_get_length(&speculative_events)
+	);
+
+	g_free(speculative_user);
+	speculative_user = NULL;
+	speculating = FALSE;
+
+	speculative_delivery_id = g_idle_add(deliver_speculative_events_cb, NULL);
+
+	return TRUE;
+}
+
+
+/*
+ * Holds back a prompt, message or the completion of a speculative conversation.
+ *
+ * Returns TRUE if the event was held back.
+ */
+static gboolean
+hold_back_auth_event(AuthEventKind kind, gint type, const gchar *text) {
+	AuthEvent *event;
+
+	if (! speculating) {
+		return FALSE;
+	}
+
+	event = g_new0(AuthEvent, 1);
+	event->kind = kind;
+	event->type = type;
+	event->text = g_strdup(text);
+
+	g_queue_push_tail(&speculative_events, event);
+
+	return TRUE;
+}
+
+
+/*
+ * Tells the greeter which user the theme has focused (eg. selected in its user list)
+ * so that their PAM conversation can be started while they type. Does nothing unless
+ * speculative_authentication is enabled.
+ */
+static JSValueRef
+focus_user_cb(JSContextRef context,
+			  JSObjectRef function,
+			  JSObjectRef thisObject,
+			  size_t argumentCount,
+			  const JSValueRef arguments[],
+			  JSValueRef *exception) {
+
+	gchar *user;
+
+	if (argumentCount != 1) {
+		return mkexception(context, exception, ARGNOTSUPPLIED);
+	}
+
+	user = arg_to_string(context, arguments[0], exception);
+
+	if (!user) {
+		return JSValueMakeNull(context);
+	}
+
+	start_speculative_authentication(GREETER, user);
+	g_free(user);
+
+	return JSValueMakeNull(context);
+}
+
+
+static JSValueRef
+authenticate_cb(JSContextRef context,
+				JSObjectRef function,
+				JSObjectRef thisObject,
+				size_t argumentCount,
+				const JSValueRef arguments[],
+				JSValueRef *exception) {
+
+	gchar *name = NULL;
+	GError *err = NULL;
+
+	if (argumentCount > 0) {
+		name = arg_to_string(context, arguments[0], exception);
+	}
+
+	if (claim_speculative_authentication(GREETER, name)) {
+		g_free(name);
+		return JSValueMakeNull(context);
+	}
+
+	drop_speculative_events();
+	auth_conversation_started();
+
+	greeter_backend_authenticate(GREETER, name, &err);
 
 	if (NULL != err) {
 		_mkexception(context, exception, err->message);
 		g_error_free(err);
 	}
-	#else
-	lightdm_greeter_authenticate(GREETER, name);
-	#endif
 
 	g_free(name);
 
@@ -722,18 +1370,18 @@ authenticate_as_guest_cb(JSContextRef context,
 						 const JSValueRef arguments[],
 						 JSValueRef *exception) {
 
-	#ifdef HAS_LIGHTDM_1_19_2
 	GError *err = NULL;
 
-	lightdm_greeter_authenticate_as_guest(GREETER, &err);
+	cancel_speculative_authentication(GREETER);
+	drop_speculative_events();
+	auth_conversation_started();
+
+	greeter_backend_authenticate_as_guest(GREETER, &err);
 
 	if (NULL != err) {
 		_mkexception(context, exception, err->message);
 		g_error_free(err);
 	}
-	#else
-	lightdm_greeter_authenticate_as_guest(GREETER);
-	#endif
 
 	return JSValueMakeNull(context);
 }
@@ -776,6 +1424,7 @@ respond_cb(JSContextRef context,
 		   JSValueRef *exception) {
 
 	gchar *response = NULL;
+	GError *err = NULL;
 
 	if (argumentCount != 1) {
 		return mkexception(context, exception, ARGNOTSUPPLIED);
@@ -787,18 +1436,14 @@ respond_cb(JSContextRef context,
 		return JSValueMakeNull(context);
 	}
 
-	#ifdef HAS_LIGHTDM_1_19_2
-	GError *err = NULL;
+	auth_responded = g_get_monotonic_time();
 
-	lightdm_greeter_respond(GREETER, response, &err);
+	greeter_backend_respond(GREETER, response, &err);
 
 	if (NULL != err) {
 		_mkexception(context, exception, err->message);
 		g_error_free(err);
 	}
-	#else
-	lightdm_greeter_respond(GREETER, response);
-	#endif
 
 	g_free(response);
 
@@ -814,18 +1459,20 @@ cancel_authentication_cb(JSContextRef context,
 						 const JSValueRef arguments[],
 						 JSValueRef *exception) {
 
-	#ifdef HAS_LIGHTDM_1_19_2
 	GError *err = NULL;
 
-	lightdm_greeter_cancel_authentication(GREETER, &err);
+	if (speculating) {
+		/* Not the theme's conversation */
+		return JSValueMakeNull(context);
+	}
+
+	drop_speculative_events();
+	greeter_backend_cancel_authentication(GREETER, &err);
 
 	if (NULL != err) {
 		_mkexception(context, exception, err->message);
 		g_error_free(err);
 	}
-	#else
-	lightdm_greeter_cancel_authentication(GREETER);
-	#endif
 
 	return JSValueMakeNull(context);
 }
@@ -836,7 +1483,11 @@ get_authentication_user_cb(JSContextRef context,
 						   JSObjectRef thisObject,
 						   JSStringRef propertyName,
 						   JSValueRef *exception) {
-	return string_or_null(context, lightdm_greeter_get_authentication_user(GREETER));
+	if (speculating) {
+		return JSValueMakeNull(context);
+	}
+
+	return string_or_null(context, greeter_backend_get_authentication_user(GREETER));
 }
 
 
@@ -899,7 +1550,8 @@ get_is_authenticated_cb(JSContextRef context,
 						JSObjectRef thisObject,
 						JSStringRef propertyName,
 						JSValueRef *exception) {
-	return JSValueMakeBoolean(context, lightdm_greeter_get_is_authenticated(GREETER));
+	/* Not until the theme claims the conversation, see authentication_complete_cb() */
+	return JSValueMakeBoolean(context, greeter_backend_get_is_authenticated(GREETER) && ! speculating);
 }
 
 
@@ -908,7 +1560,7 @@ get_in_authentication_cb(JSContextRef context,
 						 JSObjectRef thisObject,
 						 JSStringRef propertyName,
 						 JSValueRef *exception) {
-	return JSValueMakeBoolean(context, lightdm_greeter_get_in_authentication(GREETER));
+	return JSValueMakeBoolean(context, greeter_backend_get_in_authentication(GREETER) && ! speculating);
 }
 
 
@@ -918,7 +1570,7 @@ get_can_suspend_cb(JSContextRef context,
 				   JSStringRef propertyName,
 				   JSValueRef *exception) {
 
-	return JSValueMakeBoolean(context, lightdm_get_can_suspend());
+	return JSValueMakeBoolean(context, greeter_backend_can_power_action(GREETER_BACKEND_SUSPEND));
 }
 
 
@@ -930,7 +1582,7 @@ suspend_cb(JSContextRef context,
 		   const JSValueRef arguments[],
 		   JSValueRef *exception) {
 
-	lightdm_suspend(NULL);
+	greeter_backend_power_action(GREETER_BACKEND_SUSPEND);
 
 	return JSValueMakeNull(context);
 }
@@ -942,7 +1594,7 @@ get_can_hibernate_cb(JSContextRef context,
 					 JSStringRef propertyName,
 					 JSValueRef *exception) {
 
-	return JSValueMakeBoolean(context, lightdm_get_can_hibernate());
+	return JSValueMakeBoolean(context, greeter_backend_can_power_action(GREETER_BACKEND_HIBERNATE));
 }
 
 
@@ -954,7 +1606,7 @@ hibernate_cb(JSContextRef context,
 			 const JSValueRef arguments[],
 			 JSValueRef *exception) {
 
-	lightdm_hibernate(NULL);
+	greeter_backend_power_action(GREETER_BACKEND_HIBERNATE);
 
 	return JSValueMakeNull(context);
 }
@@ -966,7 +1618,7 @@ get_can_restart_cb(JSContextRef context,
 				   JSStringRef propertyName,
 				   JSValueRef *exception) {
 
-	return JSValueMakeBoolean(context, lightdm_get_can_restart());
+	return JSValueMakeBoolean(context, greeter_backend_can_power_action(GREETER_BACKEND_RESTART));
 }
 
 
@@ -978,7 +1630,7 @@ restart_cb(JSContextRef context,
 		   const JSValueRef arguments[],
 		   JSValueRef *exception) {
 
-	lightdm_restart(NULL);
+	greeter_backend_power_action(GREETER_BACKEND_RESTART);
 
 	return JSValueMakeNull(context);
 }
@@ -990,7 +1642,7 @@ get_can_shutdown_cb(JSContextRef context,
 					JSStringRef propertyName,
 					JSValueRef *exception) {
 
-	return JSValueMakeBoolean(context, lightdm_get_can_shutdown());
+	return JSValueMakeBoolean(context, greeter_backend_can_power_action(GREETER_BACKEND_SHUTDOWN));
 }
 
 
@@ -1002,7 +1654,7 @@ shutdown_cb(JSContextRef context,
 			const JSValueRef arguments[],
 			JSValueRef *exception) {
 
-	lightdm_shutdown(NULL);
+	greeter_backend_power_action(GREETER_BACKEND_SHUTDOWN);
 
 	return JSValueMakeNull(context);
 }
@@ -1017,12 +1669,13 @@ start_session_cb(JSContextRef context,
 				 JSValueRef *exception) {
 
 	gchar *session = NULL;
-	gboolean result;
+	gboolean result, started = FALSE;
 	GError *err = NULL;
 
-	WebKitDOMDOMWindow *dom_window;
-	WebKitDOMDocument *dom_document;
-	WebKitWebPage *web_page;
+	if (speculating) {
+		/* A speculative conversation may have succeeded, but the theme hasn't claimed it */
+		return mkexception(context, exception, NOTAUTHENTICATED);
+	}
 
 	/* FIXME: old API required lightdm.login(username, session), but the username
 	 * is never actually used.  At some point, deprecate the old usage.  For now,
@@ -1034,44 +1687,165 @@ start_session_cb(JSContextRef context,
 		session = arg_to_string(context, arguments[1], exception);
 	}
 
-	web_page = webkit_web_extension_get_page(WEB_EXTENSION, page_id);
+	/* Stop expecting theme heartbeats */
+	send_message_to_ui_process(GREETER_MESSAGE_SESSION_STARTING, g_variant_new("()"));
 
-	if (NULL != web_page) {
-		dom_document = webkit_web_page_get_dom_document(web_page);
-		dom_window = webkit_dom_document_get_default_view(dom_document);
-
-		if (dom_window) {
-			/* Stop theme heartbeat */
-			webkit_dom_dom_window_webkit_message_handlers_post_message(
-				dom_window, "GreeterBridge", "Heartbeat::Exit"
-			);
-		}
+	if (speculative_authentication) {
+		save_last_user(greeter_backend_get_authentication_user(GREETER));
 	}
 
+	record_auth_latency(AUTH_PHASE_SESSION_START, &auth_completed);
+	log_auth_latency();
+
 	SESSION_STARTING = TRUE;
 
-	result = lightdm_greeter_start_session_sync(GREETER, session, &err);
+	result = greeter_backend_start_session(GREETER, session, &err);
 	g_free(session);
 
 	if (err != NULL) {
-		SESSION_STARTING = FALSE;
 		_mkexception(context, exception, err->message);
 		g_error_free(err);
+
+	} else if (result && ! greeter_backend_is_mock()) {
+		/* Let the UI process give back everything it holds */
+		send_message_to_ui_process(GREETER_MESSAGE_SESSION_STARTED, g_variant_new("()"));
+		started = TRUE;
+	}
+
+	if (! started) {
+		/* Failed, or the mock backend started nothing: the page stays for the next attempt */
+		SESSION_STARTING = FALSE;
+		send_message_to_ui_process(GREETER_MESSAGE_SESSION_NOT_STARTED, g_variant_new("()"));
 	}
 
 	return JSValueMakeBoolean(context, result);
 }
 
 
-static JSValueRef
-set_language_cb(JSContextRef context,
-				JSObjectRef function,
+/*
+ * Opens a locale with the `categories` (LC_*_MASK) of `language` ("auto", a language code
+ * like "de" or a full locale name like "de_DE.UTF-8").
+ *
+ * Returns a locale object that must be freed with freelocale() or (locale_t) 0.
+ */
+static locale_t
+open_locale(const gchar *language, int categories) {
+	gchar *candidates[4] = {NULL, NULL, NULL, NULL};
+	locale_t result = (locale_t) 0;
+	guint i;
+
+	if (NULL == language || '\0' == *language || 0 == g_strcmp0(language, "auto")) {
+		return newlocale(categories, "", (locale_t) 0);
+	}
+
+	candidates[0] = g_strdup_printf("%s.UTF-8", language);
+	candidates[1] = g_strdup(language);
+
+	if (NULL == strchr(language, '_')) {
+		/* "de" -> "de_DE.UTF-8" */
+		gchar *territory = g_ascii_strup(language, -1);
+		candidates[2] = g_strdup_printf("%s_%s.UTF-8", language, territory);
+		g_free(territory);
+	}
+
+	for (i = 0; i < G_N_ELEMENTS(candidates) && (locale_t) 0 == result; i++) {
+		if (NULL != candidates[i]) {
+			result = newlocale(categories, candidates[i], (locale_t) 0);
+		}
+	}
+
+	for (i = 0; i < G_N_ELEMENTS(candidates); i++) {
+		g_free(candidates[i]);
+	}
+
+	return result;
+}
+
+
+/*
+ * Language picked with lightdm.set_language() and its LC_MESSAGES locale. Translations
+ * are looked up under that locale with uselocale() instead of setting LANGUAGE: other
+ * threads (WebKit's, the language cache's) read the environment, so changing it isn't
+ * safe here.
+ */
+static gchar *translation_language = NULL;
+static locale_t translation_locale = (locale_t) 0;
+
+
+/*
+ * Translates `msgid` (or picks the form of `msgid_plural` for `n` if it isn't NULL) into
+ * the language picked with lightdm.set_language(), or the process locale's before that.
+ */
+static const gchar *
+translate(const gchar *msgid, const gchar *msgid_plural, gulong n) {
+	locale_t previous_locale = (locale_t) 0;
+	const gchar *result;
+
+	if ((locale_t) 0 != translation_locale) {
+		previous_locale = uselocale(translation_locale);
+	}
+
+	if (NULL == msgid_plural) {
+		result = dcgettext(NULL, msgid, LC_MESSAGES);
+	} else {
+		result = dcngettext(NULL, msgid, msgid_plural, n, LC_MESSAGES);
+	}
+
+	if ((locale_t) 0 != translation_locale) {
+		uselocale(previous_locale);
+	}
+
+	return result;
+}
+
+
+/*
+ * Makes `language` the language used for translations and lets the theme know so it can
+ * drop any translations it exported from the previous language's catalog.
+ */
+static void
+set_translation_language(JSContextRef context, const gchar *language) {
+	gchar *escaped, *script;
+	JSStringRef command;
+
+	g_free(translation_language);
+	translation_language = g_strdup(language);
+
+	if ((locale_t) 0 != translation_locale) {
+		freelocale(translation_locale);
+	}
+
+	translation_locale = open_locale(language, LC_MESSAGES_MASK | LC_CTYPE_MASK);
+
+	if ((locale_t) 0 == translation_locale) {
+		g_warning("No locale installed for %s, gettext() keeps translating into the default language", language);
+	}
+
+	escaped = text_escape(language, TEXT_ESCAPE_JS_STRING);
+	script = g_strdup_printf(
+		"window.dispatchEvent(new CustomEvent('greeter-language-changed', {detail: '%s'}))",
+		escaped
+	);
+	command = JSStringCreateWithUTF8CString(script);
+
+	JSEvaluateScript(context, command, NULL, NULL, 0, NULL);
+
+	JSStringRelease(command);
+	g_free(script);
+	g_free(escaped);
+}
+
+
+static JSValueRef
+set_language_cb(JSContextRef context,
+				JSObjectRef function,
 				JSObjectRef thisObject,
 				size_t argumentCount,
 				const JSValueRef arguments[],
 				JSValueRef *exception) {
 
 	gchar *language = NULL;
+	GError *err = NULL;
 
 	if (argumentCount != 1) {
 		return mkexception(context, exception, ARGNOTSUPPLIED);
@@ -1083,19 +1857,17 @@ set_language_cb(JSContextRef context,
 		return JSValueMakeNull(context);
 	}
 
-	#ifdef HAS_LIGHTDM_1_19_2
-	GError *err = NULL;
-
-	lightdm_greeter_set_language(GREETER, language, &err);
+	greeter_backend_set_language(GREETER, language, &err);
 
 	if (NULL != err) {
 		_mkexception(context, exception, err->message);
 		g_error_free(err);
+		g_free(language);
+
+		return JSValueMakeNull(context);
 	}
-	#else
-	lightdm_greeter_set_language(GREETER, language);
-	#endif
 
+	set_translation_language(context, language);
 	g_free(language);
 
 	return JSValueMakeNull(context);
@@ -1123,7 +1895,7 @@ gettext_cb(JSContextRef context,
 		return JSValueMakeNull(context);
 	}
 
-	result = string_or_null(context, gettext(string));
+	result = string_or_null(context, translate(string, NULL, 0));
 	g_free(string);
 
 	return result;
@@ -1159,7 +1931,7 @@ ngettext_cb(JSContextRef context,
 	}
 
 	n = JSValueToNumber(context, arguments[2], exception);
-	result = string_or_null(context, ngettext(string, plural_string, n));
+	result = string_or_null(context, translate(string, plural_string, n));
 
 	g_free(string);
 	g_free(plural_string);
@@ -1167,6 +1939,423 @@ ngettext_cb(JSContextRef context,
 	return result;
 }
 
+
+/*
+ * Sets a property on a JavaScript object. Used when building plain objects
+ * that are handed to themes.
+ */
+static void
+js_object_set(JSContextRef context, JSObjectRef object, const gchar *name, JSValueRef value) {
+	JSStringRef prop = JSStringCreateWithUTF8CString(name);
+
+	JSObjectSetProperty(context, object, prop, value, kJSPropertyAttributeNone, NULL);
+	JSStringRelease(prop);
+}
+
+
+/*
+ * Gets the length of `value`, which must be an array of at most MAX_ARRAY_LENGTH items.
+ *
+ * Returns FALSE and sets `exception` if it isn't.
+ */
+static gboolean
+get_array_length(JSContextRef context, JSValueRef value, guint *length, JSValueRef *exception) {
+	JSStringRef length_prop;
+	gdouble number;
+
+	if (! JSValueIsArray(context, value)) {
+		_mkexception(context, exception, EXPECTARRAY);
+		return FALSE;
+	}
+
+	length_prop = JSStringCreateWithUTF8CString("length");
+	number = JSValueToNumber(
+		context,
+		JSObjectGetProperty(context, (JSObjectRef) value, length_prop, exception),
+		exception
+	);
+	JSStringRelease(length_prop);
+
+	if (! isfinite(number) || number < 0 || number > MAX_ARRAY_LENGTH) {
+		_mkexception(context, exception, ARRAYTOOLONG);
+		return FALSE;
+	}
+
+	*length = (guint) number;
+
+	return TRUE;
+}
+
+
+/*
+ * A translation catalog (.mo file) for the active language. Keys and values point
+ * directly into the mapped file.
+ */
+typedef struct {
+	gchar       *path;
+	GMappedFile *file;
+	GHashTable  *messages;   /* msgid -> TranslationEntry */
+	gchar       *plural;     /* C plural expression from the catalog header */
+	guint        nplurals;
+} TranslationCatalog;
+
+typedef struct {
+	const gchar *str;        /* Plural forms are separated by NUL bytes */
+	guint32      length;
+	gboolean     plural;     /* Has a msgid_plural, even if the language has one form */
+} TranslationEntry;
+
+
+#define MO_MAGIC         0x950412de
+#define DEFAULT_PLURAL   "n != 1"
+
+static TranslationCatalog *translation_catalog = NULL;
+
+
+static void
+translation_catalog_free(TranslationCatalog *catalog) {
+	if (NULL == catalog) {
+		return;
+	}
+
+	g_hash_table_destroy(catalog->messages);
+	g_mapped_file_unref(catalog->file);
+	g_free(catalog->plural);
+	g_free(catalog->path);
+	g_free(catalog);
+}
+
+
+/*
+ * Finds the .mo file gettext() would use for the current text domain and `language`, or
+ * the process locale's languages if it is NULL.
+ *
+ * Returns a newly allocated path or NULL if there is no catalog for the language.
+ */
+static gchar *
+find_translation_catalog_path(const gchar *language) {
+	const gchar *domain = textdomain(NULL);
+	const gchar *dir = bindtextdomain(domain, NULL);
+	const gchar * const *names;
+	gchar **variants = NULL;
+	gchar *mo_name, *path = NULL;
+
+	if (NULL == domain || NULL == dir) {
+		return NULL;
+	}
+
+	if (NULL != language) {
+		/* "de_DE.UTF-8" -> "de_DE.UTF-8", "de_DE", "de.UTF-8", "de" */
+		variants = g_get_locale_variants(language);
+		names = (const gchar * const *) variants;
+	} else {
+		names = g_get_language_names();
+	}
+
+	mo_name = g_strdup_printf("%s.mo", domain);
+
+	for (; NULL != *names; names++) {
+		if (0 == g_strcmp0(*names, "C")) {
+			continue;
+		}
+
+		path = g_build_filename(dir, *names, "LC_MESSAGES", mo_name, NULL);
+
+		if (g_file_test(path, G_FILE_TEST_IS_REGULAR)) {
+			break;
+		}
+
+		g_free(path);
+		path = NULL;
+	}
+
+	g_strfreev(variants);
+	g_free(mo_name);
+
+	return path;
+}
+
+
+/*
+ * Extracts `nplurals` and `plural` from the catalog header. The expression is only accepted
+ * if it is made of the tokens gettext allows so that it can be evaluated as JavaScript.
+ */
+static void
+parse_plural_forms(TranslationCatalog *catalog, const gchar *header) {
+	const gchar *forms, *nplurals, *plural;
+	gchar *expr;
+
+	catalog->nplurals = 2;
+	catalog->plural = g_strdup(DEFAULT_PLURAL);
+
+	forms = (NULL != header) ? strstr(header, "Plural-Forms:") : NULL;
+
+	if (NULL == forms) {
+		return;
+	}
+
+	nplurals = strstr(forms, "nplurals=");
+	plural = strstr(forms, "plural=");
+
+	/* "nplurals=" also contains "plural=" */
+	if (NULL != plural && plural == nplurals + 2) {
+		plural = strstr(plural + 7, "plural=");
+	}
+
+	if (NULL == nplurals || NULL == plural) {
+		return;
+	}
+
+	expr = g_strndup(plural + 7, strcspn(plural + 7, ";\n"));
+	g_strstrip(expr);
+
+	if ('\0' == *expr || strspn(expr, "n0123456789 ()?:|&=!<>%+-*/") != strlen(expr)) {
+		g_warning("Ignoring unsupported plural expression in translation catalog: %s", expr);
+		g_free(expr);
+		return;
+	}
+
+	catalog->nplurals = (guint) MAX(1, g_ascii_strtoull(nplurals + 9, NULL, 10));
+
+	g_free(catalog->plural);
+	catalog->plural = expr;
+}
+
+
+static gboolean
+mo_string_at(const gchar *data, gsize size, guint32 table, guint32 index, gboolean swap,
+			 const gchar **str, guint32 *length) {
+	const guint32 *entry;
+	guint32 len, offset;
+
+	if ((gsize) table + ((gsize) index + 1) * 8 > size) {
+		return FALSE;
+	}
+
+	entry = (const guint32 *) (data + table + (gsize) index * 8);
+	len = swap ? GUINT32_SWAP_LE_BE(entry[0]) : entry[0];
+	offset = swap ? GUINT32_SWAP_LE_BE(entry[1]) : entry[1];
+
+	/* Strings are NUL terminated in the file; the length does not include it */
+	if ((gsize) offset + len >= size || '\0' != data[offset + len]) {
+		return FALSE;
+	}
+
+	*str = data + offset;
+	*length = len;
+
+	return TRUE;
+}
+
+
+static TranslationCatalog *
+translation_catalog_load(const gchar *path) {
+	TranslationCatalog *catalog;
+	GMappedFile *file;
+	const gchar *data, *msgid, *msgstr;
+	const guint32 *header;
+	guint32 n_strings, originals, translations, msgid_len, msgstr_len, i;
+	gboolean swap;
+	gsize size;
+	GError *err = NULL;
+
+	file = g_mapped_file_new(path, FALSE, &err);
+
+	if (NULL != err) {
+		g_warning("Unable to read translation catalog: %s", err->message);
+		g_error_free(err);
+		return NULL;
+	}
+
+	data = g_mapped_file_get_contents(file);
+	size = g_mapped_file_get_length(file);
+	header = (const guint32 *) data;
+
+	if (size < 20 || (MO_MAGIC != header[0] && MO_MAGIC != GUINT32_SWAP_LE_BE(header[0]))) {
+		g_warning("Invalid translation catalog: %s", path);
+		g_mapped_file_unref(file);
+		return NULL;
+	}
+
+	swap = (MO_MAGIC != header[0]);
+	n_strings = swap ? GUINT32_SWAP_LE_BE(header[2]) : header[2];
+	originals = swap ? GUINT32_SWAP_LE_BE(header[3]) : header[3];
+	translations = swap ? GUINT32_SWAP_LE_BE(header[4]) : header[4];
+
+	catalog = g_new0(TranslationCatalog, 1);
+	catalog->path = g_strdup(path);
+	catalog->file = file;
+	catalog->messages = g_hash_table_new_full(g_str_hash, g_str_equal, NULL, g_free);
+
+	for (i = 0; i < n_strings; i++) {
+		TranslationEntry *entry;
+
+		if (! mo_string_at(data, size, originals, i, swap, &msgid, &msgid_len)
+			|| ! mo_string_at(data, size, translations, i, swap, &msgstr, &msgstr_len)) {
+			g_warning("Truncated translation catalog: %s", path);
+			break;
+		}
+
+		if (0 == msgid_len) {
+			parse_plural_forms(catalog, msgstr);
+			continue;
+		}
+
+		/* Keyed by the singular msgid, which is NUL terminated even for plural entries */
+		entry = g_new(TranslationEntry, 1);
+		entry->str = msgstr;
+		entry->length = msgstr_len;
+		entry->plural = NULL != memchr(msgid, '\0', msgid_len);
+
+		g_hash_table_insert(catalog->messages, (gpointer) msgid, entry);
+	}
+
+	if (NULL == catalog->plural) {
+		parse_plural_forms(catalog, NULL);
+	}
+
+	return catalog;
+}
+
+
+/*
+ * Returns the catalog for the active language, (re)loading it if the language changed.
+ * A catalog that can't be loaded isn't tried again until the language changes.
+ */
+static TranslationCatalog *
+get_translation_catalog(void) {
+	static gchar *failed_path = NULL;
+	gchar *path = find_translation_catalog_path(translation_language);
+
+	if (NULL == path || 0 == g_strcmp0(path, failed_path)) {
+		translation_catalog_free(translation_catalog);
+		translation_catalog = NULL;
+		g_free(path);
+
+		return NULL;
+	}
+
+	if (NULL == translation_catalog || 0 != g_strcmp0(path, translation_catalog->path)) {
+		translation_catalog_free(translation_catalog);
+		translation_catalog = translation_catalog_load(path);
+
+		g_free(failed_path);
+		failed_path = (NULL == translation_catalog) ? g_strdup(path) : NULL;
+	}
+
+	g_free(path);
+
+	return translation_catalog;
+}
+
+
+static JSValueRef
+translation_entry_to_js(JSContextRef context, const TranslationEntry *entry) {
+	const gchar *form, *end = entry->str + entry->length;
+	JSValueRef *forms;
+	JSObjectRef array;
+	guint n_forms = 0;
+
+	if (! entry->plural) {
+		return string_or_null(context, entry->str);
+	}
+
+	forms = g_new(JSValueRef, entry->length + 1);
+
+	for (form = entry->str; form <= end; form += strlen(form) + 1) {
+		forms[n_forms++] = string_or_null(context, form);
+	}
+
+	array = JSObjectMakeArray(context, n_forms, forms, NULL);
+	g_free(forms);
+
+	return (NULL != array) ? array : JSValueMakeNull(context);
+}
+
+
+/*
+ * Exports the translation catalog of the active language as a plain object so that themes
+ * can translate strings without calling into the greeter for every string.
+ *
+ * Accepts an optional array of msgids to limit the export to those strings.
+ *
+ * Returns an object: {
+ *     complete: Whether every available translation was exported. False without a
+ *               catalog we can read, gettext() may still have translations then,
+ *     nplurals: Number of plural forms,
+ *     plural:   Plural form expression (C syntax, also valid JavaScript) of `n`,
+ *     messages: Map of msgid to translation (or array of plural forms),
+ * }
+ */
+static JSValueRef
+export_catalog_cb(JSContextRef context,
+				  JSObjectRef function,
+				  JSObjectRef thisObject,
+				  size_t argumentCount,
+				  const JSValueRef arguments[],
+				  JSValueRef *exception) {
+
+	TranslationCatalog *catalog;
+	TranslationEntry *entry;
+	JSObjectRef result, messages, msgids = NULL;
+	GHashTableIter iter;
+	gpointer key, value;
+	guint i, n_msgids = 0;
+	gchar *msgid;
+
+	if (argumentCount > 0 && ! JSValueIsNull(context, arguments[0])
+		&& ! JSValueIsUndefined(context, arguments[0])) {
+
+		if (! get_array_length(context, arguments[0], &n_msgids, exception)) {
+			return JSValueMakeNull(context);
+		}
+
+		msgids = JSValueToObject(context, arguments[0], exception);
+	}
+
+	catalog = get_translation_catalog();
+	result = JSObjectMake(context, NULL, NULL);
+	messages = JSObjectMake(context, NULL, NULL);
+
+	if (NULL == msgids && NULL != catalog) {
+		g_hash_table_iter_init(&iter, catalog->messages);
+
+		while (g_hash_table_iter_next(&iter, &key, &value)) {
+			js_object_set(context, messages, key, translation_entry_to_js(context, value));
+		}
+
+	} else if (NULL != msgids) {
+		for (i = 0; i < n_msgids; i++) {
+			msgid = arg_to_string(context, JSObjectGetPropertyAtIndex(context, msgids, i, exception), exception);
+
+			if (!msgid) {
+				return JSValueMakeNull(context);
+			}
+
+			if (NULL != catalog) {
+				entry = g_hash_table_lookup(catalog->messages, msgid);
+
+				if (NULL != entry) {
+					js_object_set(context, messages, msgid, translation_entry_to_js(context, entry));
+				}
+
+			} else if (translate(msgid, NULL, 0) != msgid) {
+				/* No catalog we can read directly; ask gettext instead */
+				js_object_set(context, messages, msgid, string_or_null(context, translate(msgid, NULL, 0)));
+			}
+
+			g_free(msgid);
+		}
+	}
+
+	js_object_set(context, result, "complete", JSValueMakeBoolean(context, NULL == msgids && NULL != catalog));
+	js_object_set(context, result, "nplurals", JSValueMakeNumber(context, (NULL != catalog) ? catalog->nplurals : 2));
+	js_object_set(context, result, "plural", string_or_null(context, (NULL != catalog) ? catalog->plural : DEFAULT_PLURAL));
+	js_object_set(context, result, "messages", messages);
+
+	return result;
+}
+
 /*
  * Gets a key's value from config file.
  *
@@ -1202,11 +2391,7 @@ get_conf_str_cb(JSContextRef context,
 		value = g_strdup_printf("%s", THEME_DIR);
 
 	} else if (0 == g_strcmp0(key, "lightdm_data_dir")) {
-		#ifdef HAS_LIGHTDM_1_19_2
-		value = lightdm_greeter_ensure_shared_data_dir_sync(GREETER, section, &err);
-		#else
-		value = lightdm_greeter_ensure_shared_data_dir_sync(GREETER, section);
-		#endif
+		value = greeter_backend_ensure_shared_data_dir(GREETER, section, &err);
 
 	} else {
 		value = g_key_file_get_string(keyfile, section, key, &err);
@@ -1378,7 +2563,7 @@ txt2html_cb(JSContextRef context,
 			size_t argumentCount,
 			const JSValueRef arguments[],
 			JSValueRef *exception) {
-	gchar *txt;
+	gchar *txt, *escaped;
 	JSValueRef result;
 
 	if (argumentCount != 1) {
@@ -1390,36 +2575,535 @@ txt2html_cb(JSContextRef context,
 		return JSValueMakeNull(context);
 	}
 
-	/* Replace & with &amp; */
-	txt = g_strreplace (txt, "&", "&amp;");
-
-	/* Replace " with &quot; */
-	txt = g_strreplace (txt, "\"", "&quot;");
-
-	/* Replace < with &lt; */
-	txt = g_strreplace (txt, "<", "&lt;");
-
-	/* Replace > with &gt; */
-	txt = g_strreplace (txt, ">", "&gt;");
-
-	/* Replace newlines with <br> */
-	txt = g_strreplace (txt, "\n", "<br>");
+	escaped = text_escape(txt, TEXT_ESCAPE_HTML);
+	g_free(txt);
 
-	result = string_or_null (context, txt);
-	g_free (txt);
+	result = string_or_null(context, escaped);
+	g_free(escaped);
 
 	return result;
 }
 
 
-static gchar *
-remove_query_and_hash(gchar *str) {
-	gchar *ptr = NULL;
-
-	ptr = strchr(str, '?');
-
-	if (NULL != ptr) {
-		*ptr = '\0';
+/*
+ * Escapes every string in an array in one call so that themes rendering lists
+ * (users, sessions, messages) don't pay for a bridge crossing per string.
+ *
+ * Returns a new array of the escaped strings.
+ */
+static JSValueRef
+txt2html_bulk_cb(JSContextRef context,
+				 JSObjectRef function,
+				 JSObjectRef thisObject,
+				 size_t argumentCount,
+				 const JSValueRef arguments[],
+				 JSValueRef *exception) {
+	JSObjectRef texts, array;
+	JSValueRef *args;
+	guint i, n_texts;
+	gchar *txt, *escaped;
+
+	if (argumentCount != 1) {
+		return mkexception(context, exception, ARGNOTSUPPLIED);
+	}
+
+	if (! get_array_length(context, arguments[0], &n_texts, exception)) {
+		return JSValueMakeNull(context);
+	}
+
+	texts = JSValueToObject(context, arguments[0], exception);
+
+	args = g_malloc(sizeof(JSValueRef) * ( n_texts + 1 ));
+
+	for (i = 0; i < n_texts; i++) {
+		txt = arg_to_string(context, JSObjectGetPropertyAtIndex(context, texts, i, exception), exception);
+
+		if (!txt) {
+			g_free(args);
+			return JSValueMakeNull(context);
+		}
+
+		escaped = text_escape(txt, TEXT_ESCAPE_HTML);
+		args[i] = string_or_null(context, escaped);
+
+		g_free(escaped);
+		g_free(txt);
+	}
+
+	array = JSObjectMakeArray(context, n_texts, args, exception);
+	g_free(args);
+
+	if (array == NULL) {
+		return JSValueMakeNull(context);
+	} else {
+		return array;
+	}
+}
+
+
+static void
+append_strftime_literal(GString *result, gchar c) {
+	if ('%' == c) {
+		g_string_append(result, "%%");
+	} else {
+		g_string_append_c(result, c);
+	}
+}
+
+
+/*
+ * Converts a moment.js format string to a strftime() format string. Only the tokens
+ * themes commonly use for clocks are supported.
+ *
+ * Returns a newly allocated string or NULL if `format` contains unsupported tokens.
+ */
+static gchar *
+moment_format_to_strftime(const gchar *format, gboolean twelve_hour) {
+	/* Longest tokens first so that eg. "MMMM" isn't read as "MM" twice. Tokens that
+	 * strftime() can't express (NULL) make us fall back to moment.js.
+	 */
+	static const struct {
+		const gchar *token;
+		const gchar *strftime_12h;
+		const gchar *strftime_24h;
+	} tokens[] = {
+		{"LLLL", NULL,           NULL},
+		{"LLL",  NULL,           NULL},
+		{"LL",   NULL,           NULL},
+		{"LTS",  "%-I:%M:%S %p", "%H:%M:%S"},
+		{"LT",   "%-I:%M %p",    "%H:%M"},
+		{"L",    "%x",           "%x"},
+		{"YYYY", "%Y",           "%Y"},
+		{"YY",   "%y",           "%y"},
+		{"MMMM", "%B",           "%B"},
+		{"MMM",  "%b",           "%b"},
+		{"MM",   "%m",           "%m"},
+		{"M",    "%-m",          "%-m"},
+		{"dddd", "%A",           "%A"},
+		{"ddd",  "%a",           "%a"},
+		{"DD",   "%d",           "%d"},
+		{"Do",   NULL,           NULL},
+		{"D",    "%-d",          "%-d"},
+		{"HH",   "%H",           "%H"},
+		{"H",    "%-H",          "%-H"},
+		{"hh",   "%I",           "%I"},
+		{"h",    "%-I",          "%-I"},
+		{"mm",   "%M",           "%M"},
+		{"m",    "%-M",          "%-M"},
+		{"ss",   "%S",           "%S"},
+		{"s",    "%-S",          "%-S"},
+		{"A",    "%p",           "%p"},
+		{"a",    "%P",           "%P"},
+		{"ZZ",   "%z",           "%z"},
+	};
+	GString *result = g_string_new(NULL);
+	const gchar *ptr = format, *end;
+	guint i;
+
+	while ('\0' != *ptr) {
+		if ('[' == *ptr) {
+			/* [Escaped text] */
+			end = strchr(ptr, ']');
+
+			if (NULL == end) {
+				break;
+			}
+
+			for (ptr++; ptr < end; ptr++) {
+				append_strftime_literal(result, *ptr);
+			}
+
+			ptr++;
+			continue;
+		}
+
+		if (! g_ascii_isalpha(*ptr)) {
+			append_strftime_literal(result, *ptr);
+			ptr++;
+			continue;
+		}
+
+		for (i = 0; i < G_N_ELEMENTS(tokens); i++) {
+			if (g_str_has_prefix(ptr, tokens[i].token)) {
+				if (NULL == tokens[i].strftime_24h) {
+					g_string_free(result, TRUE);
+					return NULL;
+				}
+
+				g_string_append(result, twelve_hour ? tokens[i].strftime_12h : tokens[i].strftime_24h);
+				ptr += strlen(tokens[i].token);
+				break;
+			}
+		}
+
+		if (G_N_ELEMENTS(tokens) == i) {
+			g_string_free(result, TRUE);
+			return NULL;
+		}
+	}
+
+	return g_string_free(result, FALSE);
+}
+
+
+/*
+ * Whether the locale writes times with a 12-hour clock.
+ */
+static gboolean
+locale_uses_twelve_hour_clock(locale_t locale) {
+	const gchar *t_fmt = nl_langinfo_l(T_FMT, locale);
+	const gchar *am = nl_langinfo_l(AM_STR, locale);
+
+	return (NULL != am && '\0' != *am)
+		&& (NULL != strstr(t_fmt, "%r") || NULL != strstr(t_fmt, "%I") || NULL != strstr(t_fmt, "%l"));
+}
+
+
+/*
+ * Formats the current time with a moment.js `format` in `language` ("auto" or a locale).
+ * The converted format and opened locale are cached since the clock asks for the same
+ * thing every time.
+ *
+ * Returns a newly allocated string or NULL if we can't format it natively.
+ */
+static gchar *
+format_localized_time(const gchar *format, const gchar *language) {
+	static gchar *cached_format = NULL, *cached_language = NULL, *cached_strftime = NULL;
+	static locale_t time_locale = (locale_t) 0;
+
+	gchar buffer[256];
+	locale_t previous_locale;
+	struct tm now_tm;
+	time_t now;
+	gsize length;
+
+	if (0 != g_strcmp0(language, cached_language) || 0 != g_strcmp0(format, cached_format)) {
+		if ((locale_t) 0 != time_locale) {
+			freelocale(time_locale);
+		}
+
+		time_locale = open_locale(language, LC_TIME_MASK | LC_CTYPE_MASK);
+
+		g_free(cached_strftime);
+		cached_strftime = ((locale_t) 0 != time_locale)
+			? moment_format_to_strftime(format, locale_uses_twelve_hour_clock(time_locale))
+			: NULL;
+
+		g_free(cached_language);
+		g_free(cached_format);
+		cached_language = g_strdup(language);
+		cached_format = g_strdup(format);
+	}
+
+	if (NULL == cached_strftime) {
+		return NULL;
+	}
+
+	now = time(NULL);
+	localtime_r(&now, &now_tm);
+
+	previous_locale = uselocale(time_locale);
+	length = strftime(buffer, sizeof(buffer), cached_strftime, &now_tm);
+	uselocale(previous_locale);
+
+	if (0 == length) {
+		return NULL;
+	}
+
+	return g_strdup(g_strstrip(buffer));
+}
+
+
+/*
+ * Formats the current time natively so that themes don't need moment.js just to show
+ * a clock. See theme_utils.get_current_localized_time().
+ *
+ * Arguments: format (moment.js tokens), language ("auto" or a locale)
+ *
+ * Returns the formatted time, or null if the format has tokens we don't support.
+ */
+static JSValueRef
+get_localized_time_cb(JSContextRef context,
+					  JSObjectRef function,
+					  JSObjectRef thisObject,
+					  size_t argumentCount,
+					  const JSValueRef arguments[],
+					  JSValueRef *exception) {
+
+	gchar *format, *language, *local_time;
+	JSValueRef result;
+
+	if (argumentCount != 2) {
+		return mkexception(context, exception, ARGNOTSUPPLIED);
+	}
+
+	format = arg_to_string(context, arguments[0], exception);
+	if (!format) {
+		return JSValueMakeNull(context);
+	}
+
+	language = arg_to_string(context, arguments[1], exception);
+	if (!language) {
+		g_free(format);
+		return JSValueMakeNull(context);
+	}
+
+	local_time = format_localized_time(format, language);
+	result = string_or_null(context, local_time);
+
+	g_free(local_time);
+	g_free(language);
+	g_free(format);
+
+	return result;
+}
+
+
+/*
+ * Loads moment.js into the page. The bundle calls this the first time a theme
+ * accesses window.moment.
+ */
+static JSValueRef
+load_moment_cb(JSContextRef context,
+			   JSObjectRef function,
+			   JSObjectRef thisObject,
+			   size_t argumentCount,
+			   const JSValueRef arguments[],
+			   JSValueRef *exception) {
+
+	gchar *source;
+	JSStringRef script, url;
+	JSValueRef error = NULL;
+	GError *err = NULL;
+
+	g_file_get_contents(MOMENT_JS_PATH, &source, NULL, &err);
+
+	if (NULL != err) {
+		_mkexception(context, exception, err->message);
+		g_error_free(err);
+		return JSValueMakeBoolean(context, FALSE);
+	}
+
+	script = JSStringCreateWithUTF8CString(source);
+	url = JSStringCreateWithUTF8CString("file://" MOMENT_JS_PATH);
+
+	JSEvaluateScript(context, script, NULL, url, 1, &error);
+
+	JSStringRelease(url);
+	JSStringRelease(script);
+	g_free(source);
+
+	if (NULL != error) {
+		/* window.moment stays undefined, let the theme see why */
+		*exception = error;
+		return JSValueMakeBoolean(context, FALSE);
+	}
+
+	return JSValueMakeBoolean(context, TRUE);
+}
+
+
+/*
+ * Returns the PAM conversation latency histograms (see record_auth_latency()) or null
+ * when not in debug mode:
+ *
+ *   [{phase, count, total_ms, max_ms, buckets: [{le_ms, count}, ...]}, ...]
+ *
+ * The last bucket's le_ms is null (no upper bound).
+ */
+static JSValueRef
+bridge_auth_latency_cb(JSContextRef context,
+					   JSObjectRef function,
+					   JSObjectRef thisObject,
+					   size_t argumentCount,
+					   const JSValueRef arguments[],
+					   JSValueRef *exception) {
+
+	JSValueRef phases[AUTH_PHASE_COUNT], buckets[LATENCY_HISTOGRAM_BUCKETS];
+	JSStringRef name;
+	JSObjectRef phase, bucket;
+	const LatencyHistogram *histogram;
+	guint i, j;
+
+	if (! debug_mode) {
+		return JSValueMakeNull(context);
+	}
+
+	for (i = 0; i < AUTH_PHASE_COUNT; i++) {
+		histogram = &auth_latency[i];
+
+		for (j = 0; j < LATENCY_HISTOGRAM_BUCKETS; j++) {
+			bucket = JSObjectMake(context, NULL, NULL);
+
+			js_object_set(context, bucket, "le_ms", (G_MAXINT64 == latency_histogram_bounds[j])
+				? JSValueMakeNull(context)
+				: JSValueMakeNumber(context, latency_histogram_bounds[j]));
+			js_object_set(context, bucket, "count", JSValueMakeNumber(context, histogram->counts[j]));
+
+			buckets[j] = bucket;
+		}
+
+		phase = JSObjectMake(context, NULL, NULL);
+		name = JSStringCreateWithUTF8CString(histogram->name);
+
+		js_object_set(context, phase, "phase", JSValueMakeString(context, name));
+		js_object_set(context, phase, "count", JSValueMakeNumber(context, histogram->count));
+		js_object_set(context, phase, "total_ms", JSValueMakeNumber(context, histogram->total));
+		js_object_set(context, phase, "max_ms", JSValueMakeNumber(context, histogram->max));
+		js_object_set(context, phase, "buckets", JSObjectMakeArray(context, LATENCY_HISTOGRAM_BUCKETS, buckets, exception));
+
+		JSStringRelease(name);
+		phases[i] = phase;
+	}
+
+	return JSObjectMakeArray(context, AUTH_PHASE_COUNT, phases, exception);
+}
+
+
+/*
+ * Returns the web view's frame pacing or null when not in debug mode or before it first
+ * drew:
+ *
+ *   {frames, animations, long_frames, dropped_frames, refresh_ms,
+ *    mean_ms, p50_ms, p95_ms, p99_ms, max_ms}
+ *
+ * Intervals are between consecutive frames of an animation, long frames took more than
+ * 50 ms and dropped frames are the display refreshes animations missed.
+ */
+static JSValueRef
+bridge_frame_stats_cb(JSContextRef context,
+					  JSObjectRef function,
+					  JSObjectRef thisObject,
+					  size_t argumentCount,
+					  const JSValueRef arguments[],
+					  JSValueRef *exception) {
+
+	guint64 frames, animations, long_frames, dropped_frames;
+	gdouble refresh, mean, p50, p95, p99, max;
+	JSObjectRef stats;
+
+	if (! debug_mode || NULL == frame_stats) {
+		return JSValueMakeNull(context);
+	}
+
+	g_variant_get(
+		frame_stats,
+		GREETER_MESSAGE_FRAME_STATS_TYPE,
+		&frames, &animations, &long_frames, &dropped_frames,
+		&refresh, &mean, &p50, &p95, &p99, &max
+	);
+
+	stats = JSObjectMake(context, NULL, NULL);
+
+	js_object_set(context, stats, "frames", JSValueMakeNumber(context, frames));
+	js_object_set(context, stats, "animations", JSValueMakeNumber(context, animations));
+	js_object_set(context, stats, "long_frames", JSValueMakeNumber(context, long_frames));
+	js_object_set(context, stats, "dropped_frames", JSValueMakeNumber(context, dropped_frames));
+	js_object_set(context, stats, "refresh_ms", JSValueMakeNumber(context, refresh));
+	js_object_set(context, stats, "mean_ms", JSValueMakeNumber(context, mean));
+	js_object_set(context, stats, "p50_ms", JSValueMakeNumber(context, p50));
+	js_object_set(context, stats, "p95_ms", JSValueMakeNumber(context, p95));
+	js_object_set(context, stats, "p99_ms", JSValueMakeNumber(context, p99));
+	js_object_set(context, stats, "max_ms", JSValueMakeNumber(context, max));
+
+	return stats;
+}
+
+
+/*
+ * Forwards a theme heartbeat (see ThemeHeartbeat.js) to the UI process.
+ */
+static JSValueRef
+bridge_heartbeat_cb(JSContextRef context,
+					JSObjectRef function,
+					JSObjectRef thisObject,
+					size_t argumentCount,
+					const JSValueRef arguments[],
+					JSValueRef *exception) {
+	gint64 lag;
+
+	if (argumentCount != 1) {
+		return mkexception(context, exception, ARGNOTSUPPLIED);
+	}
+
+	lag = (gint64) JSValueToNumber(context, arguments[0], exception);
+
+	send_message_to_ui_process(GREETER_MESSAGE_HEARTBEAT, g_variant_new("(x)", lag));
+
+	return JSValueMakeNull(context);
+}
+
+
+/*
+ * Tells the UI process that the theme is ready (see ThemeHeartbeat.js).
+ */
+static JSValueRef
+bridge_theme_ready_cb(JSContextRef context,
+					  JSObjectRef function,
+					  JSObjectRef thisObject,
+					  size_t argumentCount,
+					  const JSValueRef arguments[],
+					  JSValueRef *exception) {
+
+	send_message_to_ui_process(GREETER_MESSAGE_THEME_READY, g_variant_new("()"));
+
+	return JSValueMakeNull(context);
+}
+
+
+/*
+ * Forwards an uncaught theme error (see ThemeErrorReporter.js) to the UI process.
+ *
+ * Arguments: kind, message, source, stack, line, column
+ */
+static JSValueRef
+bridge_report_error_cb(JSContextRef context,
+					   JSObjectRef function,
+					   JSObjectRef thisObject,
+					   size_t argumentCount,
+					   const JSValueRef arguments[],
+					   JSValueRef *exception) {
+	gchar *strings[4] = {NULL, NULL, NULL, NULL};
+	gint line, column;
+	guint i;
+
+	if (argumentCount != 6) {
+		return mkexception(context, exception, ARGNOTSUPPLIED);
+	}
+
+	for (i = 0; i < G_N_ELEMENTS(strings); i++) {
+		strings[i] = arg_to_string(context, arguments[i], exception);
+
+		if (!strings[i]) {
+			goto out;
+		}
+	}
+
+	line = (gint) JSValueToNumber(context, arguments[4], exception);
+	column = (gint) JSValueToNumber(context, arguments[5], exception);
+
+	send_message_to_ui_process(
+		GREETER_MESSAGE_THEME_ERROR,
+		g_variant_new("(ssssii)", strings[0], strings[1], strings[2], strings[3], line, column)
+	);
+
+out:
+	for (i = 0; i < G_N_ELEMENTS(strings); i++) {
+		g_free(strings[i]);
+	}
+
+	return JSValueMakeNull(context);
+}
+
+
+static gchar *
+remove_query_and_hash(gchar *str) {
+	gchar *ptr = NULL;
+
+	ptr = strchr(str, '?');
+
+	if (NULL != ptr) {
+		*ptr = '\0';
 	}
 
 	ptr = strchr(str, '#');
@@ -1432,129 +3116,337 @@ remove_query_and_hash(gchar *str) {
 }
 
 
+/*
+ * Bridge call metrics
+ *
+ * With metrics_socket enabled, every call of a bridge function (and of the lightdm list
+ * getters) is counted and one in BRIDGE_CALL_SAMPLE_EVERY is timed, which keeps the
+ * overhead below what bridge-bench can measure. The tables below point at the
+ * *_metered wrappers generated here, which also carry the bridge_call tracepoints (see
+ * greeter-trace.h). The remaining callbacks only get a wrapper when tracing is enabled.
+ */
+#define BRIDGE_CALL_SAMPLE_EVERY 16
+
+typedef struct {
+	const gchar *name;
+	guint64      calls;
+	guint64      timed;
+	gint64       timed_total;   /* Microseconds */
+} BridgeCallMetric;
+
+/* The metrics of the functions that were called at least once */
+static GSList *bridge_call_metrics;
+
+
+/*
+ * Counts a call. Returns TRUE if it should be timed.
+ */
+static inline gboolean
+bridge_call_begin(BridgeCallMetric *metric) {
+	if (! metrics_socket) {
+		return FALSE;
+	}
+
+	if (0 == metric->calls++) {
+		bridge_call_metrics = g_slist_prepend(bridge_call_metrics, metric);
+	}
+
+	return 1 == metric->calls % BRIDGE_CALL_SAMPLE_EVERY;
+}
+
+
+static void
+bridge_call_end(BridgeCallMetric *metric, gint64 started) {
+	metric->timed++;
+	metric->timed_total += g_get_monotonic_time() - started;
+}
+
+
+#define METERED_CALL(metric, call) \
+	JSValueRef result; \
+	gint64 started = 0; \
+	\
+	GREETER_TRACE1(bridge_call_entry, metric.name); \
+	\
+	if (bridge_call_begin(&metric)) { \
+		started = g_get_monotonic_time(); \
+	} \
+	\
+	result = call; \
+	\
+	if (0 != started) { \
+		bridge_call_end(&metric, started); \
+	} \
+	\
+	GREETER_TRACE1(bridge_call_return, metric.name); \
+	\
+	return result;
+
+#define METERED_FUNCTION(name, callback) \
+	static BridgeCallMetric callback##_metric = {name}; \
+	\
+	static JSValueRef \
+	callback##_metered(JSContextRef context, \
+					   JSObjectRef function, \
+					   JSObjectRef thisObject, \
+					   size_t argumentCount, \
+					   const JSValueRef arguments[], \
+					   JSValueRef *exception) { \
+		METERED_CALL(callback##_metric, callback(context, function, thisObject, argumentCount, arguments, exception)) \
+	}
+
+#define METERED_GETTER(name, callback) \
+	static BridgeCallMetric callback##_metric = {name}; \
+	\
+	static JSValueRef \
+	callback##_metered(JSContextRef context, \
+					   JSObjectRef thisObject, \
+					   JSStringRef propertyName, \
+					   JSValueRef *exception) { \
+		METERED_CALL(callback##_metric, callback(context, thisObject, propertyName, exception)) \
+	}
+
+METERED_GETTER("__LightDMGreeter.languages", get_languages_cb)
+METERED_GETTER("__LightDMGreeter.layouts",   get_layouts_cb)
+METERED_GETTER("__LightDMGreeter.sessions",  get_sessions_cb)
+METERED_GETTER("__LightDMGreeter.users",     get_users_cb)
+
+METERED_FUNCTION("__LightDMGreeter.authenticate",          authenticate_cb)
+METERED_FUNCTION("__LightDMGreeter.authenticate_as_guest", authenticate_as_guest_cb)
+METERED_FUNCTION("__LightDMGreeter.cancel_authentication", cancel_authentication_cb)
+METERED_FUNCTION("__LightDMGreeter.cancel_autologin",      cancel_autologin_cb)
+METERED_FUNCTION("__LightDMGreeter.focus_user",            focus_user_cb)
+METERED_FUNCTION("__LightDMGreeter.get_hint",              get_hint_cb)
+METERED_FUNCTION("__LightDMGreeter.hibernate",             hibernate_cb)
+METERED_FUNCTION("__LightDMGreeter.respond",               respond_cb)
+METERED_FUNCTION("__LightDMGreeter.restart",               restart_cb)
+METERED_FUNCTION("__LightDMGreeter.set_language",          set_language_cb)
+METERED_FUNCTION("__LightDMGreeter.shutdown",              shutdown_cb)
+METERED_FUNCTION("__LightDMGreeter.start_session",         start_session_cb)
+METERED_FUNCTION("__LightDMGreeter.suspend",               suspend_cb)
+
+METERED_FUNCTION("__Gettext.export_catalog", export_catalog_cb)
+METERED_FUNCTION("__Gettext.gettext",        gettext_cb)
+METERED_FUNCTION("__Gettext.ngettext",       ngettext_cb)
+
+METERED_FUNCTION("__GreeterConfig.get_str",  get_conf_str_cb)
+METERED_FUNCTION("__GreeterConfig.get_num",  get_conf_num_cb)
+METERED_FUNCTION("__GreeterConfig.get_bool", get_conf_bool_cb)
+
+METERED_FUNCTION("__ThemeUtils.dirlist",        get_dirlist_cb)
+METERED_FUNCTION("__ThemeUtils.load_moment",    load_moment_cb)
+METERED_FUNCTION("__ThemeUtils.localized_time", get_localized_time_cb)
+METERED_FUNCTION("__ThemeUtils.txt2html",       txt2html_cb)
+METERED_FUNCTION("__ThemeUtils.txt2html_bulk",  txt2html_bulk_cb)
+
+METERED_FUNCTION("LightDMUser.get_image", get_user_image_at_size_cb)
+
+METERED_FUNCTION("__GreeterBridge.auth_latency", bridge_auth_latency_cb)
+METERED_FUNCTION("__GreeterBridge.frame_stats",  bridge_frame_stats_cb)
+METERED_FUNCTION("__GreeterBridge.heartbeat",    bridge_heartbeat_cb)
+METERED_FUNCTION("__GreeterBridge.report_error", bridge_report_error_cb)
+METERED_FUNCTION("__GreeterBridge.theme_ready",  bridge_theme_ready_cb)
+
+
+#ifdef HAS_TRACING
+#define TRACED(callback) callback##_traced
+
+#define TRACED_GETTER(name, callback) \
+	static JSValueRef \
+	callback##_traced(JSContextRef context, \
+					  JSObjectRef thisObject, \
+					  JSStringRef propertyName, \
+					  JSValueRef *exception) { \
+		JSValueRef result; \
+		\
+		GREETER_TRACE1(bridge_call_entry, name); \
+		result = callback(context, thisObject, propertyName, exception); \
+		GREETER_TRACE1(bridge_call_return, name); \
+		\
+		return result; \
+	}
+
+#define TRACED_SETTER(name, callback) \
+	static bool \
+	callback##_traced(JSContextRef context, \
+					  JSObjectRef thisObject, \
+					  JSStringRef propertyName, \
+					  JSValueRef value, \
+					  JSValueRef *exception) { \
+		bool result; \
+		\
+		GREETER_TRACE1(bridge_call_entry, name); \
+		result = callback(context, thisObject, propertyName, value, exception); \
+		GREETER_TRACE1(bridge_call_return, name); \
+		\
+		return result; \
+	}
+#else
+#define TRACED(callback) callback
+#define TRACED_GETTER(name, callback)
+#define TRACED_SETTER(name, callback)
+#endif
+
+TRACED_GETTER("LightDMUser.display_name",   get_user_display_name_cb)
+TRACED_GETTER("LightDMUser.home_directory", get_user_home_directory_cb)
+TRACED_GETTER("LightDMUser.image",          get_user_image_cb)
+TRACED_GETTER("LightDMUser.language",       get_user_language_cb)
+TRACED_GETTER("LightDMUser.layout",         get_user_layout_cb)
+TRACED_GETTER("LightDMUser.logged_in",      get_user_logged_in_cb)
+TRACED_GETTER("LightDMUser.session",        get_user_session_cb)
+TRACED_GETTER("LightDMUser.username",       get_user_name_cb)
+TRACED_GETTER("LightDMUser.real_name",      get_user_real_name_cb)
+
+TRACED_GETTER("LightDMLayout.name",              get_layout_name_cb)
+TRACED_GETTER("LightDMLayout.short_description", get_layout_short_description_cb)
+TRACED_GETTER("LightDMLayout.description",       get_layout_description_cb)
+
+TRACED_GETTER("__LightDMGreeter.authentication_user", get_authentication_user_cb)
+TRACED_GETTER("__LightDMGreeter.autologin_guest",     get_autologin_guest_cb)
+TRACED_GETTER("__LightDMGreeter.autologin_timeout",   get_autologin_timeout_cb)
+TRACED_GETTER("__LightDMGreeter.autologin_user",      get_autologin_user_cb)
+TRACED_GETTER("__LightDMGreeter.can_hibernate",       get_can_hibernate_cb)
+TRACED_GETTER("__LightDMGreeter.can_restart",         get_can_restart_cb)
+TRACED_GETTER("__LightDMGreeter.can_shutdown",        get_can_shutdown_cb)
+TRACED_GETTER("__LightDMGreeter.can_suspend",         get_can_suspend_cb)
+TRACED_GETTER("__LightDMGreeter.default_session",     get_default_session_cb)
+TRACED_GETTER("__LightDMGreeter.has_guest_account",   get_has_guest_account_cb)
+TRACED_GETTER("__LightDMGreeter.hide_users",          get_hide_users_cb)
+TRACED_GETTER("__LightDMGreeter.hostname",            get_hostname_cb)
+TRACED_GETTER("__LightDMGreeter.in_authentication",   get_in_authentication_cb)
+TRACED_GETTER("__LightDMGreeter.is_authenticated",    get_is_authenticated_cb)
+TRACED_GETTER("__LightDMGreeter.language",            get_language_cb)
+TRACED_GETTER("__LightDMGreeter.layout",              get_layout_cb)
+TRACED_SETTER("__LightDMGreeter.layout",              set_layout_cb)
+TRACED_GETTER("__LightDMGreeter.lock_hint",           get_lock_hint_cb)
+TRACED_GETTER("__LightDMGreeter.num_users",           get_num_users_cb)
+TRACED_GETTER("__LightDMGreeter.select_guest_hint",   get_select_guest_hint_cb)
+TRACED_GETTER("__LightDMGreeter.select_user_hint",    get_select_user_hint_cb)
+TRACED_GETTER("__LightDMGreeter.session_starting",    get_session_starting_cb)
+
+
 static const JSStaticValue lightdm_user_values[] = {
-	{"display_name",   get_user_display_name_cb,   NULL, kJSPropertyAttributeReadOnly},
-	{"home_directory", get_user_home_directory_cb, NULL, kJSPropertyAttributeReadOnly},
-	{"image",          get_user_image_cb,          NULL, kJSPropertyAttributeReadOnly},
-	{"language",       get_user_language_cb,       NULL, kJSPropertyAttributeReadOnly},
-	{"layout",         get_user_layout_cb,         NULL, kJSPropertyAttributeReadOnly},
-	{"logged_in",      get_user_logged_in_cb,      NULL, kJSPropertyAttributeReadOnly},
-	{"session",        get_user_session_cb,        NULL, kJSPropertyAttributeReadOnly},
-	{"username",       get_user_name_cb,           NULL, kJSPropertyAttributeReadOnly},
+	{"display_name",   TRACED(get_user_display_name_cb),   NULL, kJSPropertyAttributeReadOnly},
+	{"home_directory", TRACED(get_user_home_directory_cb), NULL, kJSPropertyAttributeReadOnly},
+	{"image",          TRACED(get_user_image_cb),          NULL, kJSPropertyAttributeReadOnly},
+	{"language",       TRACED(get_user_language_cb),       NULL, kJSPropertyAttributeReadOnly},
+	{"layout",         TRACED(get_user_layout_cb),         NULL, kJSPropertyAttributeReadOnly},
+	{"logged_in",      TRACED(get_user_logged_in_cb),      NULL, kJSPropertyAttributeReadOnly},
+	{"session",        TRACED(get_user_session_cb),        NULL, kJSPropertyAttributeReadOnly},
+	{"username",       TRACED(get_user_name_cb),           NULL, kJSPropertyAttributeReadOnly},
 	/* ---->>> DEPRECATED! <<<------>>> DEPRECATED! <<<------->>> DEPRECATED! <<<----*/
-	{"name",           get_user_name_cb,           NULL, kJSPropertyAttributeReadOnly},
-	{"real_name",      get_user_real_name_cb,      NULL, kJSPropertyAttributeReadOnly},
+	{"name",           TRACED(get_user_name_cb),           NULL, kJSPropertyAttributeReadOnly},
+	{"real_name",      TRACED(get_user_real_name_cb),      NULL, kJSPropertyAttributeReadOnly},
 	/* ---->>> DEPRECATED! <<<------>>> DEPRECATED! <<<------->>> DEPRECATED! <<<----*/
-	{NULL,             NULL,                       NULL, 0}};
+	{NULL,             NULL,                               NULL, 0}};
 
-static const JSStaticValue lightdm_language_values[] = {
-	{"code",      get_language_code_cb,      NULL, kJSPropertyAttributeReadOnly},
-	{"name",      get_language_name_cb,      NULL, kJSPropertyAttributeReadOnly},
-	{"territory", get_language_territory_cb, NULL, kJSPropertyAttributeReadOnly},
-	{NULL,        NULL,                      NULL, 0}};
+static const JSStaticFunction lightdm_user_functions[] = {
+	{"get_image", get_user_image_at_size_cb_metered, kJSPropertyAttributeReadOnly},
+	{NULL,        NULL,                              0}};
 
 static const JSStaticValue lightdm_layout_values[] = {
-	{"name",              get_layout_name_cb,              NULL, kJSPropertyAttributeReadOnly},
-	{"short_description", get_layout_short_description_cb, NULL, kJSPropertyAttributeReadOnly},
-	{"description",       get_layout_description_cb,       NULL, kJSPropertyAttributeReadOnly},
-	{NULL,                NULL,                            NULL, 0}};
-
-static const JSStaticValue lightdm_session_values[] = {
-	{"key",     get_session_key_cb,     NULL, kJSPropertyAttributeReadOnly},
-	{"name",    get_session_name_cb,    NULL, kJSPropertyAttributeReadOnly},
-	{"comment", get_session_comment_cb, NULL, kJSPropertyAttributeReadOnly},
-	{NULL,      NULL,                   NULL, 0}};
+	{"name",              TRACED(get_layout_name_cb),              NULL, kJSPropertyAttributeReadOnly},
+	{"short_description", TRACED(get_layout_short_description_cb), NULL, kJSPropertyAttributeReadOnly},
+	{"description",       TRACED(get_layout_description_cb),       NULL, kJSPropertyAttributeReadOnly},
+	{NULL,                NULL,                                    NULL, 0}};
 
 static const JSStaticValue lightdm_greeter_values[] = {
-	{"authentication_user", get_authentication_user_cb, NULL,            kJSPropertyAttributeReadOnly},
-	{"autologin_guest",     get_autologin_guest_cb,     NULL,            kJSPropertyAttributeReadOnly},
-	{"autologin_timeout",   get_autologin_timeout_cb,   NULL,            kJSPropertyAttributeReadOnly},
-	{"autologin_user",      get_autologin_user_cb,      NULL,            kJSPropertyAttributeReadOnly},
-	{"can_hibernate",       get_can_hibernate_cb,       NULL,            kJSPropertyAttributeReadOnly},
-	{"can_restart",         get_can_restart_cb,         NULL,            kJSPropertyAttributeReadOnly},
-	{"can_shutdown",        get_can_shutdown_cb,        NULL,            kJSPropertyAttributeReadOnly},
-	{"can_suspend",         get_can_suspend_cb,         NULL,            kJSPropertyAttributeReadOnly},
-	{"default_session",     get_default_session_cb,     NULL,            kJSPropertyAttributeReadOnly},
-	{"has_guest_account",   get_has_guest_account_cb,   NULL,            kJSPropertyAttributeReadOnly},
-	{"hide_users",          get_hide_users_cb,          NULL,            kJSPropertyAttributeReadOnly},
-	{"hostname",            get_hostname_cb,            NULL,            kJSPropertyAttributeReadOnly},
-	{"in_authentication",   get_in_authentication_cb,   NULL,            kJSPropertyAttributeReadOnly},
-	{"is_authenticated",    get_is_authenticated_cb,    NULL,            kJSPropertyAttributeReadOnly},
-	{"language",            get_language_cb,            NULL,            kJSPropertyAttributeReadOnly},
-	{"languages",           get_languages_cb,           NULL,            kJSPropertyAttributeReadOnly},
-	{"layout",              get_layout_cb,              set_layout_cb,   kJSPropertyAttributeNone},
-	{"layouts",             get_layouts_cb,             NULL,            kJSPropertyAttributeReadOnly},
-	{"lock_hint",           get_lock_hint_cb,           NULL,            kJSPropertyAttributeReadOnly},
-	{"num_users",           get_num_users_cb,           NULL,            kJSPropertyAttributeReadOnly},
-	{"select_guest_hint",   get_select_guest_hint_cb,   NULL,            kJSPropertyAttributeReadOnly},
-	{"select_user_hint",    get_select_user_hint_cb,    NULL,            kJSPropertyAttributeReadOnly},
-	{"sessions",            get_sessions_cb,            NULL,            kJSPropertyAttributeReadOnly},
-	{"session_starting",    get_session_starting_cb,    NULL,            kJSPropertyAttributeReadOnly},
-	{"users",               get_users_cb,               NULL,            kJSPropertyAttributeReadOnly},
+	{"authentication_user", TRACED(get_authentication_user_cb), NULL,                  kJSPropertyAttributeReadOnly},
+	{"autologin_guest",     TRACED(get_autologin_guest_cb),     NULL,                  kJSPropertyAttributeReadOnly},
+	{"autologin_timeout",   TRACED(get_autologin_timeout_cb),   NULL,                  kJSPropertyAttributeReadOnly},
+	{"autologin_user",      TRACED(get_autologin_user_cb),      NULL,                  kJSPropertyAttributeReadOnly},
+	{"can_hibernate",       TRACED(get_can_hibernate_cb),       NULL,                  kJSPropertyAttributeReadOnly},
+	{"can_restart",         TRACED(get_can_restart_cb),         NULL,                  kJSPropertyAttributeReadOnly},
+	{"can_shutdown",        TRACED(get_can_shutdown_cb),        NULL,                  kJSPropertyAttributeReadOnly},
+	{"can_suspend",         TRACED(get_can_suspend_cb),         NULL,                  kJSPropertyAttributeReadOnly},
+	{"default_session",     TRACED(get_default_session_cb),     NULL,                  kJSPropertyAttributeReadOnly},
+	{"has_guest_account",   TRACED(get_has_guest_account_cb),   NULL,                  kJSPropertyAttributeReadOnly},
+	{"hide_users",          TRACED(get_hide_users_cb),          NULL,                  kJSPropertyAttributeReadOnly},
+	{"hostname",            TRACED(get_hostname_cb),            NULL,                  kJSPropertyAttributeReadOnly},
+	{"in_authentication",   TRACED(get_in_authentication_cb),   NULL,                  kJSPropertyAttributeReadOnly},
+	{"is_authenticated",    TRACED(get_is_authenticated_cb),    NULL,                  kJSPropertyAttributeReadOnly},
+	{"language",            TRACED(get_language_cb),            NULL,                  kJSPropertyAttributeReadOnly},
+	{"languages",           get_languages_cb_metered,           NULL,                  kJSPropertyAttributeReadOnly},
+	{"layout",              TRACED(get_layout_cb),              TRACED(set_layout_cb), kJSPropertyAttributeNone},
+	{"layouts",             get_layouts_cb_metered,             NULL,                  kJSPropertyAttributeReadOnly},
+	{"lock_hint",           TRACED(get_lock_hint_cb),           NULL,                  kJSPropertyAttributeReadOnly},
+	{"num_users",           TRACED(get_num_users_cb),           NULL,                  kJSPropertyAttributeReadOnly},
+	{"select_guest_hint",   TRACED(get_select_guest_hint_cb),   NULL,                  kJSPropertyAttributeReadOnly},
+	{"select_user_hint",    TRACED(get_select_user_hint_cb),    NULL,                  kJSPropertyAttributeReadOnly},
+	{"sessions",            get_sessions_cb_metered,            NULL,                  kJSPropertyAttributeReadOnly},
+	{"session_starting",    TRACED(get_session_starting_cb),    NULL,                  kJSPropertyAttributeReadOnly},
+	{"users",               get_users_cb_metered,               NULL,                  kJSPropertyAttributeReadOnly},
 	/* ------>>> DEPRECATED! <<<----------->>> DEPRECATED! <<<------------>>> DEPRECATED! <<<------*/
-	{"default_language",    get_language_cb,            NULL,            kJSPropertyAttributeReadOnly},
-	{"default_layout",      get_layout_cb,              NULL,            kJSPropertyAttributeReadOnly},
-    {"select_guest",        get_select_guest_hint_cb,   NULL,            kJSPropertyAttributeReadOnly},
-    {"select_user",         get_select_user_hint_cb,    NULL,            kJSPropertyAttributeReadOnly},
-	{"timed_login_delay",   get_autologin_timeout_cb,   NULL,            kJSPropertyAttributeReadOnly},
-	{"timed_login_user",    get_autologin_user_cb,      NULL,            kJSPropertyAttributeReadOnly},
+	{"default_language",    TRACED(get_language_cb),            NULL,                  kJSPropertyAttributeReadOnly},
+	{"default_layout",      TRACED(get_layout_cb),              NULL,                  kJSPropertyAttributeReadOnly},
+    {"select_guest",        TRACED(get_select_guest_hint_cb),   NULL,                  kJSPropertyAttributeReadOnly},
+    {"select_user",         TRACED(get_select_user_hint_cb),    NULL,                  kJSPropertyAttributeReadOnly},
+	{"timed_login_delay",   TRACED(get_autologin_timeout_cb),   NULL,                  kJSPropertyAttributeReadOnly},
+	{"timed_login_user",    TRACED(get_autologin_user_cb),      NULL,                  kJSPropertyAttributeReadOnly},
 	/* ------>>> DEPRECATED! <<<----------->>> DEPRECATED! <<<------------>>> DEPRECATED! <<<------*/
-	{NULL,                  NULL,                       NULL,            0}};
+	{NULL,                  NULL,                               NULL,                  0}};
 
 static const JSStaticFunction lightdm_greeter_functions[] = {
-	{"authenticate",          authenticate_cb,          kJSPropertyAttributeReadOnly},
-	{"authenticate_as_guest", authenticate_as_guest_cb, kJSPropertyAttributeReadOnly},
-	{"cancel_authentication", cancel_authentication_cb, kJSPropertyAttributeReadOnly},
-	{"cancel_autologin",      cancel_autologin_cb,      kJSPropertyAttributeReadOnly},
-	{"get_hint",              get_hint_cb,              kJSPropertyAttributeReadOnly},
-	{"hibernate",             hibernate_cb,             kJSPropertyAttributeReadOnly},
-	{"respond",               respond_cb,               kJSPropertyAttributeReadOnly},
-	{"restart",               restart_cb,               kJSPropertyAttributeReadOnly},
-	{"set_language",          set_language_cb,          kJSPropertyAttributeReadOnly},
-	{"shutdown",              shutdown_cb,              kJSPropertyAttributeReadOnly},
-	{"start_session",         start_session_cb,         kJSPropertyAttributeReadOnly},
-	{"suspend",               suspend_cb,               kJSPropertyAttributeReadOnly},
+	{"authenticate",          authenticate_cb_metered,          kJSPropertyAttributeReadOnly},
+	{"authenticate_as_guest", authenticate_as_guest_cb_metered, kJSPropertyAttributeReadOnly},
+	{"cancel_authentication", cancel_authentication_cb_metered, kJSPropertyAttributeReadOnly},
+	{"cancel_autologin",      cancel_autologin_cb_metered,      kJSPropertyAttributeReadOnly},
+	{"focus_user",            focus_user_cb_metered,            kJSPropertyAttributeReadOnly},
+	{"get_hint",              get_hint_cb_metered,              kJSPropertyAttributeReadOnly},
+	{"hibernate",             hibernate_cb_metered,             kJSPropertyAttributeReadOnly},
+	{"respond",               respond_cb_metered,               kJSPropertyAttributeReadOnly},
+	{"restart",               restart_cb_metered,               kJSPropertyAttributeReadOnly},
+	{"set_language",          set_language_cb_metered,          kJSPropertyAttributeReadOnly},
+	{"shutdown",              shutdown_cb_metered,              kJSPropertyAttributeReadOnly},
+	{"start_session",         start_session_cb_metered,         kJSPropertyAttributeReadOnly},
+	{"suspend",               suspend_cb_metered,               kJSPropertyAttributeReadOnly},
 	/* -------->>> DEPRECATED! <<<---------------------->>> DEPRECATED! <<<---------*/
-	{"cancel_timed_login",    cancel_autologin_cb,      kJSPropertyAttributeReadOnly},
-	{"login",                 start_session_cb,         kJSPropertyAttributeReadOnly},
-	{"provide_secret",        respond_cb,               kJSPropertyAttributeReadOnly},
-	{"start_session_sync",    start_session_cb,         kJSPropertyAttributeReadOnly},
+	{"cancel_timed_login",    cancel_autologin_cb_metered,      kJSPropertyAttributeReadOnly},
+	{"login",                 start_session_cb_metered,         kJSPropertyAttributeReadOnly},
+	{"provide_secret",        respond_cb_metered,               kJSPropertyAttributeReadOnly},
+	{"start_session_sync",    start_session_cb_metered,         kJSPropertyAttributeReadOnly},
 	/* -------->>> DEPRECATED! <<<---------------------->>> DEPRECATED! <<<---------*/
-	{NULL,                    NULL,                     0}};
+	{NULL,                    NULL,                             0}};
 
 static const JSStaticFunction gettext_functions[] = {
-	{"gettext",  gettext_cb,  kJSPropertyAttributeReadOnly},
-	{"ngettext", ngettext_cb, kJSPropertyAttributeReadOnly},
-	{NULL,       NULL,        0}};
+	{"export_catalog", export_catalog_cb_metered, kJSPropertyAttributeReadOnly},
+	{"gettext",        gettext_cb_metered,        kJSPropertyAttributeReadOnly},
+	{"ngettext",       ngettext_cb_metered,       kJSPropertyAttributeReadOnly},
+	{NULL,             NULL,                      0}};
 
 
 static const JSStaticFunction greeter_config_functions[] = {
-	{"get_str",  get_conf_str_cb,  kJSPropertyAttributeReadOnly},
-	{"get_num",  get_conf_num_cb,  kJSPropertyAttributeReadOnly},
-	{"get_bool", get_conf_bool_cb, kJSPropertyAttributeReadOnly},
-	{NULL,       NULL,             0}};
+	{"get_str",  get_conf_str_cb_metered,  kJSPropertyAttributeReadOnly},
+	{"get_num",  get_conf_num_cb_metered,  kJSPropertyAttributeReadOnly},
+	{"get_bool", get_conf_bool_cb_metered, kJSPropertyAttributeReadOnly},
+	{NULL,       NULL,                     0}};
 
 
 static const JSStaticFunction theme_utils_functions[] = {
-	{"dirlist",  get_dirlist_cb,   kJSPropertyAttributeReadOnly},
-	{"txt2html", txt2html_cb,      kJSPropertyAttributeReadOnly},
-	{NULL,       NULL,             0}};
+	{"dirlist",        get_dirlist_cb_metered,        kJSPropertyAttributeReadOnly},
+	{"load_moment",    load_moment_cb_metered,        kJSPropertyAttributeReadOnly},
+	{"localized_time", get_localized_time_cb_metered, kJSPropertyAttributeReadOnly},
+	{"txt2html",       txt2html_cb_metered,           kJSPropertyAttributeReadOnly},
+	{"txt2html_bulk",  txt2html_bulk_cb_metered,      kJSPropertyAttributeReadOnly},
+	{NULL,             NULL,                          0}};
 
 
-static const JSClassDefinition lightdm_user_definition = {
-	0,                     /* Version       */
-	kJSClassAttributeNone, /* Attributes    */
-	"LightDMUser",         /* Class name    */
-	NULL,                  /* Parent class  */
-	lightdm_user_values,   /* Static values */
-};
+static const JSStaticFunction greeter_bridge_functions[] = {
+	{"auth_latency", bridge_auth_latency_cb_metered, kJSPropertyAttributeReadOnly},
+	{"frame_stats",  bridge_frame_stats_cb_metered,  kJSPropertyAttributeReadOnly},
+	{"heartbeat",    bridge_heartbeat_cb_metered,    kJSPropertyAttributeReadOnly},
+	{"report_error", bridge_report_error_cb_metered, kJSPropertyAttributeReadOnly},
+	{"theme_ready",  bridge_theme_ready_cb_metered,  kJSPropertyAttributeReadOnly},
+	{NULL,           NULL,                           0}};
+
 
-static const JSClassDefinition lightdm_language_definition = {
-	0,                       /* Version       */
-	kJSClassAttributeNone,   /* Attributes    */
-	"LightDMLanguage",       /* Class name    */
-	NULL,                    /* Parent class  */
-	lightdm_language_values, /* Static values */
+static const JSClassDefinition lightdm_user_definition = {
+	0,                      /* Version          */
+	kJSClassAttributeNone,  /* Attributes       */
+	"LightDMUser",          /* Class name       */
+	NULL,                   /* Parent class     */
+	lightdm_user_values,    /* Static values    */
+	lightdm_user_functions, /* Static functions */
 };
 
 static const JSClassDefinition lightdm_layout_definition = {
@@ -1565,14 +3457,6 @@ static const JSClassDefinition lightdm_layout_definition = {
 	lightdm_layout_values, /* Static values */
 };
 
-static const JSClassDefinition lightdm_session_definition = {
-	0,                      /* Version       */
-	kJSClassAttributeNone,  /* Attributes    */
-	"LightDMSession",       /* Class name    */
-	NULL,                   /* Parent class  */
-	lightdm_session_values, /* Static values */
-};
-
 static const JSClassDefinition lightdm_greeter_definition = {
 	0,                         /* Version          */
 	kJSClassAttributeNone,     /* Attributes       */
@@ -1609,34 +3493,41 @@ static const JSClassDefinition theme_utils_definition = {
 	theme_utils_functions, /* Static functions */
 };
 
+static const JSClassDefinition greeter_bridge_definition = {
+	0,                        /* Version          */
+	kJSClassAttributeNone,    /* Attributes       */
+	"__GreeterBridge",        /* Class name       */
+	NULL,                     /* Parent class     */
+	NULL,                     /* Static values    */
+	greeter_bridge_functions, /* Static functions */
+};
 
-static void
-window_object_cleared_callback(WebKitScriptWorld *world,
-							   WebKitWebPage *web_page,
-							   WebKitFrame *frame,
-							   LightDMGreeter *greeter) {
-
-	JSGlobalContextRef jsContext;
-	WebKitDOMDOMWindow *dom_window;
-	WebKitDOMDocument *dom_document;
 
+/*
+ * Creates the bridge classes (once, they aren't tied to a context) and publishes their
+ * instances on the global object of `jsContext`. benchmarks/bridge/bridge-bench.c uses
+ * this to set up a bare context the same way a page is set up.
+ */
+static void
+publish_bridge_objects(JSGlobalContextRef jsContext, LightDMGreeter *greeter) {
 	JSObjectRef gettext_object,
 				lightdm_greeter_object,
 				greeter_config_object,
 				theme_utils_object,
+				greeter_bridge_object,
 				globalObject;
 
-	jsContext = webkit_frame_get_javascript_context_for_script_world(frame, world);
 	globalObject = JSContextGetGlobalObject(jsContext);
 
-	gettext_class = JSClassCreate(&gettext_definition);
-	lightdm_greeter_class = JSClassCreate(&lightdm_greeter_definition);
-	lightdm_user_class = JSClassCreate(&lightdm_user_definition);
-	lightdm_language_class = JSClassCreate(&lightdm_language_definition);
-	lightdm_layout_class = JSClassCreate(&lightdm_layout_definition);
-	lightdm_session_class = JSClassCreate(&lightdm_session_definition);
-	greeter_config_class = JSClassCreate(&greeter_config_definition);
-	theme_utils_class = JSClassCreate(&theme_utils_definition);
+	if (NULL == lightdm_greeter_class) {
+		gettext_class = JSClassCreate(&gettext_definition);
+		lightdm_greeter_class = JSClassCreate(&lightdm_greeter_definition);
+		lightdm_user_class = JSClassCreate(&lightdm_user_definition);
+		lightdm_layout_class = JSClassCreate(&lightdm_layout_definition);
+		greeter_config_class = JSClassCreate(&greeter_config_definition);
+		theme_utils_class = JSClassCreate(&theme_utils_definition);
+		greeter_bridge_class = JSClassCreate(&greeter_bridge_definition);
+	}
 
 	gettext_object = JSObjectMake(jsContext, gettext_class, NULL);
 	JSObjectSetProperty(jsContext,
@@ -1646,6 +3537,14 @@ window_object_cleared_callback(WebKitScriptWorld *world,
 						kJSPropertyAttributeNone,
 						NULL);
 
+	/* The bundle replaces window.gettext with a wrapper that translates from an exported catalog */
+	JSObjectSetProperty(jsContext,
+						globalObject,
+						JSStringCreateWithUTF8CString("__Gettext"),
+						gettext_object,
+						kJSPropertyAttributeDontEnum | kJSPropertyAttributeReadOnly,
+						NULL);
+
 	lightdm_greeter_object = JSObjectMake(jsContext, lightdm_greeter_class, greeter);
 	JSObjectSetProperty(jsContext,
 						globalObject,
@@ -1670,16 +3569,55 @@ window_object_cleared_callback(WebKitScriptWorld *world,
 						kJSPropertyAttributeDontEnum | kJSPropertyAttributeReadOnly,
 						NULL);
 
-	dom_document = webkit_web_page_get_dom_document(web_page);
-	dom_window = webkit_dom_document_get_default_view(dom_document);
+	greeter_bridge_object = JSObjectMake(jsContext, greeter_bridge_class, NULL);
+	JSObjectSetProperty(jsContext,
+						globalObject,
+						JSStringCreateWithUTF8CString("__GreeterBridge"),
+						greeter_bridge_object,
+						kJSPropertyAttributeDontEnum | kJSPropertyAttributeReadOnly,
+						NULL);
+}
 
-	if (dom_window) {
-		/* If the greeter was started as a lock-screen, notify our UI process. */
-		if (lightdm_greeter_get_lock_hint(greeter)) {
-			webkit_dom_dom_window_webkit_message_handlers_post_message(
-				dom_window, "GreeterBridge", "LockHint"
-			);
-		}
+
+static void
+window_object_cleared_callback(WebKitScriptWorld *world,
+							   WebKitWebPage *web_page,
+							   WebKitFrame *frame,
+							   LightDMGreeter *greeter) {
+
+	JSGlobalContextRef jsContext;
+	JSStringRef ready_event;
+	JSObjectRef globalObject;
+
+	jsContext = webkit_frame_get_javascript_context_for_script_world(frame, world);
+	globalObject = JSContextGetGlobalObject(jsContext);
+
+	publish_bridge_objects(jsContext, greeter);
+
+	/* Everything is published, resolve the bundle's __greeter_ready (see GreeterReady.js).
+	 * The flag covers the usual case where this runs before the bundle is injected.
+	 */
+	JSObjectSetProperty(jsContext,
+						globalObject,
+						JSStringCreateWithUTF8CString("__GreeterReady"),
+						JSValueMakeBoolean(jsContext, TRUE),
+						kJSPropertyAttributeDontEnum | kJSPropertyAttributeReadOnly,
+						NULL);
+
+	ready_event = JSStringCreateWithUTF8CString("window.dispatchEvent(new Event('GreeterReady'))");
+	JSEvaluateScript(jsContext, ready_event, NULL, NULL, 0, NULL);
+	JSStringRelease(ready_event);
+
+	/* A new page, the first tick goes to the listeners it adds while loading */
+	schedule_clock_tick();
+
+	/* Don't keep the previous page alive until the new one reads these */
+	prebuilt_array_clear(&prebuilt_languages);
+	prebuilt_array_clear(&prebuilt_sessions);
+
+	/* If the greeter was started as a lock-screen, notify our UI process. */
+	if (lightdm_greeter_get_lock_hint(greeter)) {
+		send_message_to_ui_process(GREETER_MESSAGE_LOCK_HINT, g_variant_new("()"));
 	}
 }
 
@@ -1690,38 +3628,16 @@ show_prompt_cb(LightDMGreeter *greeter,
 			   LightDMPromptType type,
 			   WebKitWebExtension *extension) {
 
-	WebKitWebPage *web_page;
-	WebKitFrame *web_frame;
-	JSGlobalContextRef jsContext;
-	JSStringRef command;
-	gchar *string;
-	gchar *etext;
-	const gchar *ct = "";
-
-	web_page = webkit_web_extension_get_page(extension, page_id);
-
-	if (web_page != NULL) {
-		web_frame = webkit_web_page_get_main_frame(web_page);
-		jsContext = webkit_frame_get_javascript_global_context(web_frame);
+	GREETER_TRACE1(lightdm_signal_entry, "show-prompt");
 
-		switch (type) {
-			case LIGHTDM_PROMPT_TYPE_QUESTION:
-				ct = "text";
-				break;
-			case LIGHTDM_PROMPT_TYPE_SECRET:
-				ct = "password";
-				break;
-		}
+	auth_conversation_progressed();
 
-		etext = escape(text);
-		string = g_strdup_printf("show_prompt('%s', '%s')", etext, ct);
-		command = JSStringCreateWithUTF8CString(string);
-
-		JSEvaluateScript(jsContext, command, NULL, NULL, 0, NULL);
-
-		g_free(string);
-		g_free(etext);
+	if (! hold_back_auth_event(AUTH_EVENT_PROMPT, type, text)) {
+		deliver_speculative_events();
+		deliver_prompt(text, type);
 	}
+
+	GREETER_TRACE1(lightdm_signal_return, "show-prompt");
 }
 
 
@@ -1731,58 +3647,62 @@ show_message_cb(LightDMGreeter *greeter,
 				LightDMMessageType type,
 				WebKitWebExtension *extension) {
 
-	WebKitWebPage *web_page;
-	WebKitFrame *web_frame;
-	JSGlobalContextRef jsContext;
-	JSStringRef command;
-	gchar *etext;
-	gchar *string;
-	const gchar *mt = "";
+	GREETER_TRACE1(lightdm_signal_entry, "show-message");
 
-	web_page = webkit_web_extension_get_page(extension, page_id);
+	auth_conversation_progressed();
 
-	if (web_page != NULL) {
-		web_frame = webkit_web_page_get_main_frame(web_page);
-		jsContext = webkit_frame_get_javascript_global_context(web_frame);
+	if (! hold_back_auth_event(AUTH_EVENT_MESSAGE, type, text)) {
+		deliver_speculative_events();
+		deliver_message(text, type);
+	}
 
-		switch (type) {
-			case LIGHTDM_MESSAGE_TYPE_ERROR:
-				mt = "error";
-				break;
-			case LIGHTDM_MESSAGE_TYPE_INFO:
-				mt = "info";
-				break;
-		}
+	GREETER_TRACE1(lightdm_signal_return, "show-message");
+}
 
-		etext = escape(text);
-		string = g_strdup_printf("show_prompt('%s', '%s')", etext, mt);
-		command = JSStringCreateWithUTF8CString(string);
 
-		JSEvaluateScript(jsContext, command, NULL, NULL, 0, NULL);
+static void
+authentication_complete_cb(LightDMGreeter *greeter, WebKitWebExtension *extension) {
+	gchar *user;
+
+	GREETER_TRACE1(lightdm_signal_entry, "authentication-complete");
+
+	auth_conversation_progressed();
 
-		g_free(string);
-		g_free(etext);
+	if (greeter_backend_get_is_authenticated(greeter)) {
+		auth_completed = g_get_monotonic_time();
 	}
-}
 
+	log_auth_latency();
 
-static void
-authentication_complete_cb(LightDMGreeter *greeter, WebKitWebExtension *extension) {
+	if (speculating && greeter_backend_get_is_authenticated(greeter)) {
+		/* No prompt needed, deliver the success when the theme claims it */
+		g_debug("Speculative authentication for %s succeeded before it was claimed", speculative_user);
+		hold_back_auth_event(AUTH_EVENT_COMPLETE, 0, NULL);
+		GREETER_TRACE1(lightdm_signal_return, "authentication-complete");
+		return;
+	}
 
-	WebKitWebPage *web_page;
-	WebKitFrame *web_frame;
-	JSGlobalContextRef jsContext;
-	JSStringRef command;
+	if (speculating) {
+		/* Failed before the theme claimed it (eg. unknown user). Let the theme start over. */
+		g_debug("Speculative authentication for %s ended early", speculative_user);
+		clear_speculation();
+		GREETER_TRACE1(lightdm_signal_return, "authentication-complete");
+		return;
+	}
 
-	web_page = webkit_web_extension_get_page(extension, page_id);
+	user = g_strdup(greeter_backend_get_authentication_user(greeter));
 
-	if (web_page != NULL) {
-		web_frame = webkit_web_page_get_main_frame(web_page);
-		jsContext = webkit_frame_get_javascript_global_context(web_frame);
-		command = JSStringCreateWithUTF8CString("authentication_complete()");
+	deliver_speculative_events();
+	evaluate_script_in_page("authentication_complete()");
 
-		JSEvaluateScript(jsContext, command, NULL, NULL, 0, NULL);
+	/* Re-arm PAM right away so the next attempt doesn't wait for it */
+	if (! greeter_backend_get_is_authenticated(greeter)) {
+		start_speculative_authentication(greeter, user);
 	}
+
+	g_free(user);
+
+	GREETER_TRACE1(lightdm_signal_return, "authentication-complete");
 }
 
 
@@ -1794,6 +3714,8 @@ autologin_timer_expired_cb(LightDMGreeter *greeter, WebKitWebExtension *extensio
 	JSGlobalContextRef jsContext;
 	JSStringRef command;
 
+	GREETER_TRACE1(lightdm_signal_entry, "autologin-timer-expired");
+
 	web_page = webkit_web_extension_get_page(extension, page_id);
 
 	if (web_page != NULL) {
@@ -1803,6 +3725,8 @@ autologin_timer_expired_cb(LightDMGreeter *greeter, WebKitWebExtension *extensio
 
 		JSEvaluateScript(jsContext, command, NULL, NULL, 0, NULL);
 	}
+
+	GREETER_TRACE1(lightdm_signal_return, "autologin-timer-expired");
 }
 
 
@@ -1827,10 +3751,10 @@ get_config_option_as_string(const gchar *section, const gchar *key) {
 	value = g_key_file_get_string(keyfile, section, key, &err);
 
 	if (NULL != err) {
-		g_error("%s", err->message);
+		g_warning("%s", err->message);
 		g_error_free(err);
 		g_free(value);
-		return "";
+		return NULL;
 	}
 
 	return value;
@@ -1882,6 +3806,9 @@ web_page_send_request_cb(WebKitWebPage     *web_page,
 	gboolean decision;
 
 	const char *request_uri = webkit_uri_request_get_uri(request);
+
+	GREETER_TRACE1(request_filter_entry, request_uri);
+
 	request_scheme = g_uri_parse_scheme(request_uri);
 
 	/* NOTE: Returning TRUE blocks the request, while Returning FALSE allows it.
@@ -1913,42 +3840,520 @@ web_page_send_request_cb(WebKitWebPage     *web_page,
 
 	g_free(request_scheme);
 
+	if (decision) {
+		requests_blocked++;
+	} else {
+		requests_allowed++;
+	}
+
+	GREETER_TRACE2(request_filter_return, request_uri, decision);
+
 	return decision;
 }
 
 
-void
-web_page_console_message_sent_cb(WebKitWebPage        *web_page,
-								 WebKitConsoleMessage *console_message,
-								 gpointer              user_data) {
-	WebKitDOMDOMWindow *dom_window;
-	WebKitDOMDocument *dom_document;
-	const gchar *msg_text;
-	gboolean is_error;
-
-	msg_text = webkit_console_message_get_text(console_message);
-	is_error =
-		NULL != strstr(msg_text, "Uncaught") ||
-		NULL != strstr(msg_text, "Error") ||
-		NULL != strstr(msg_text, "error") ||
-		NULL != strstr(msg_text, "Exception") ||
-		NULL != strstr(msg_text, "exception") ||
-		NULL != strstr(msg_text, "ERROR");
-
-	if (! is_error) {
+/*
+ * Reads the clock settings from the config file. time_format and time_language
+ * mirror greeter_config.greeter, clock_tick_interval is the greeter-clock-tick
+ * granularity in seconds.
+ */
+static void
+load_clock_config(void) {
+	GError *err = NULL;
+
+	g_free(clock_time_format);
+	g_free(clock_time_language);
+
+	clock_time_format = g_key_file_get_string(keyfile, "greeter", "time_format", NULL);
+	clock_time_language = g_key_file_get_string(keyfile, "greeter", "time_language", NULL);
+
+	if (NULL == clock_time_format || '\0' == *clock_time_format || 0 == g_strcmp0(clock_time_format, "auto")) {
+		g_free(clock_time_format);
+		clock_time_format = g_strdup("LT");
+	}
+
+	if (NULL == clock_time_language || '\0' == *clock_time_language) {
+		g_free(clock_time_language);
+		clock_time_language = g_strdup("auto");
+	}
+
+	clock_tick_interval = g_key_file_get_integer(keyfile, "greeter", "clock_tick_interval", &err);
+
+	if (NULL != err || clock_tick_interval <= 0) {
+		clock_tick_interval = DEFAULT_CLOCK_TICK_INTERVAL;
+		g_clear_error(&err);
+	}
+
+	clock_tick_interval = MIN(clock_tick_interval, 3600);
+}
+
+
+/*
+ * Dispatches greeter-clock-tick with the current time formatted like
+ * theme_utils.get_current_localized_time(). `detail.time` is null when the format
+ * can't be handled natively, the bundle fills it in using moment.js.
+ */
+static void
+dispatch_clock_tick(void) {
+	gchar *local_time, *escaped, *script;
+
+	local_time = format_localized_time(clock_time_format, clock_time_language);
+	escaped = text_escape(local_time, TEXT_ESCAPE_JS_STRING);
+
+	script = g_strdup_printf(
+		"window.dispatchEvent(new CustomEvent('greeter-clock-tick', "
+		"{detail: {time: %s%s%s, timestamp: %" G_GINT64_FORMAT "}}))",
+		(NULL != escaped) ? "'" : "",
+		(NULL != escaped) ? escaped : "null",
+		(NULL != escaped) ? "'" : "",
+		g_get_real_time() / 1000
+	);
+
+	evaluate_script_in_page(script);
+
+	g_free(script);
+	g_free(escaped);
+	g_free(local_time);
+}
+
+
+static gboolean
+clock_tick_cb(gpointer user_data) {
+	clock_tick_id = 0;
+
+	dispatch_clock_tick();
+	schedule_clock_tick();
+
+	return G_SOURCE_REMOVE;
+}
+
+
+/*
+ * Arms a one-shot timer for the next multiple of clock_tick_interval seconds of local
+ * wall clock time, so the clock wakes the web process exactly when the displayed time
+ * changes instead of whenever the theme's setInterval() fires. Local time matters for
+ * hourly ticks in timezones offset by :30 or :45 from UTC.
+ */
+static void
+schedule_clock_tick(void) {
+	GDateTime *now = g_date_time_new_now_local();
+	gint64 interval = (gint64) clock_tick_interval * G_USEC_PER_SEC;
+	gint64 local_time = g_get_real_time() + g_date_time_get_utc_offset(now);
+	gint64 until_next_tick = interval - (local_time % interval);
+
+	g_date_time_unref(now);
+
+	if (0 != clock_tick_id) {
+		g_source_remove(clock_tick_id);
+		clock_tick_id = 0;
+	}
+
+	if (display_blanked || SESSION_STARTING) {
 		return;
 	}
 
-	/* This is an Uncaught JS Exception. Notify the UI process so it can show recovery dialog */
-	dom_document = webkit_web_page_get_dom_document(web_page);
-	dom_window = webkit_dom_document_get_default_view(dom_document);
+	/* Round up so we never fire just before the boundary */
+	clock_tick_id = g_timeout_add((guint) ((until_next_tick + 999) / 1000), clock_tick_cb, NULL);
+}
 
-	if (dom_window) {
-		webkit_dom_dom_window_webkit_message_handlers_post_message(
-			dom_window, "GreeterBridge", "JavaScriptException"
+
+/*
+ * Adds a path from the config file to the request filter's allow list. Missing and empty
+ * ones are left out, an empty prefix would allow every file.
+ */
+static void
+allow_config_path(gchar *path) {
+	if (NULL != path && '\0' != *path) {
+		paths = g_slist_prepend(paths, path);
+	}
+}
+
+
+/*
+ * Reads everything the extension takes from the config file, at startup and again when it
+ * is reloaded. Only mock_backend (see greeter_backend_init()) keeps its startup value, the
+ * backend can't be swapped under a running theme.
+ */
+static void
+load_config(void) {
+	GError *err = NULL;
+
+	secure_mode = get_config_option_as_bool("greeter", "secure_mode", &err);
+	if (NULL != err) {
+		// Use default value
+		secure_mode = TRUE;
+		g_clear_error(&err);
+	}
+
+	debug_mode = get_config_option_as_bool("greeter", "debug_mode", &err);
+	if (NULL != err) {
+		debug_mode = FALSE;
+		g_clear_error(&err);
+	}
+
+	speculative_authentication = get_config_option_as_bool("greeter", "speculative_authentication", &err);
+	if (NULL != err) {
+		speculative_authentication = FALSE;
+		g_clear_error(&err);
+	}
+
+	metrics_socket = get_config_option_as_bool("greeter", "metrics_socket", &err);
+	if (NULL != err) {
+		metrics_socket = FALSE;
+		g_clear_error(&err);
+	}
+
+	/* Replace the branding paths in the request filter's allow list */
+	paths = g_slist_remove(paths, background_images_dir);
+	paths = g_slist_remove(paths, user_image);
+	paths = g_slist_remove(paths, logo);
+
+	g_free(background_images_dir);
+	g_free(user_image);
+	g_free(logo);
+
+	background_images_dir = get_config_option_as_string("branding", "background_images");
+	user_image = get_config_option_as_string("branding", "user_image");
+	logo = get_config_option_as_string("branding", "logo");
+
+	allow_config_path(background_images_dir);
+	allow_config_path(user_image);
+	allow_config_path(logo);
+
+	load_clock_config();
+}
+
+
+static void
+config_reload_handler(GVariant *parameters, gpointer user_data) {
+	GKeyFile *new_keyfile = g_key_file_new();
+	GError *err = NULL;
+
+	g_key_file_load_from_file(
+		new_keyfile,
+		greeter_paths_get_config_file(),
+		G_KEY_FILE_NONE,
+		&err
+	);
+
+	if (NULL != err) {
+		g_warning("Unable to reload config file: %s", err->message);
+		g_error_free(err);
+		g_key_file_free(new_keyfile);
+		return;
+	}
+
+	g_key_file_free(keyfile);
+	keyfile = new_keyfile;
+
+	load_config();
+	schedule_clock_tick();
+
+	if (! speculative_authentication) {
+		cancel_speculative_authentication(GREETER);
+	}
+
+	evaluate_script_in_page("window.dispatchEvent(new Event('greeter-config-reload'))");
+}
+
+
+static void
+monitor_geometry_handler(GVariant *parameters, gpointer user_data) {
+	gint x, y, width, height;
+	gchar *script;
+
+	g_variant_get(parameters, "(iiii)", &x, &y, &width, &height);
+
+	script = g_strdup_printf(
+		"window.dispatchEvent(new CustomEvent('greeter-monitor-geometry', "
+		"{detail: {x: %d, y: %d, width: %d, height: %d}}))",
+		x, y, width, height
+	);
+
+	evaluate_script_in_page(script);
+	g_free(script);
+}
+
+
+static void
+frame_stats_handler(GVariant *parameters, gpointer user_data) {
+	g_clear_pointer(&frame_stats, g_variant_unref);
+	frame_stats = g_variant_ref(parameters);
+}
+
+
+/*
+ * Stops the clock while the screen is blanked and tells the theme (greeter-display-blanked)
+ * so it can pause its own timers. When the screen comes back the theme gets a tick right
+ * away since its clock is probably stale.
+ */
+static void
+display_blanked_handler(GVariant *parameters, gpointer user_data) {
+	gboolean blanked;
+	gchar *script;
+
+	g_variant_get(parameters, "(b)", &blanked);
+
+	if (blanked == display_blanked) {
+		return;
+	}
+
+	if (debug_mode) {
+		g_message(
+			"Web process: %.1f wakeups/minute while %s",
+			wakeup_counter_per_minute(&wakeup_counter),
+			display_blanked ? "blanked" : "unblanked"
+		);
+	}
+
+	wakeup_counter_start(&wakeup_counter);
+	display_blanked = blanked;
+
+	script = g_strdup_printf(
+		"window.dispatchEvent(new CustomEvent('greeter-display-blanked', {detail: {blanked: %s}}))",
+		blanked ? "true" : "false"
+	);
+
+	evaluate_script_in_page(script);
+	g_free(script);
+
+	if (! display_blanked) {
+		dispatch_clock_tick();
+	}
+
+	schedule_clock_tick();
+}
+
+
+/*
+ * Tells the theme (greeter-user-image-ready) that a user image it was given at full size
+ * now has a thumbnail, so it can swap the <img> source.
+ */
+static void
+avatar_ready_cb(const gchar *image, gint size, const gchar *thumbnail, gpointer user_data) {
+	gchar *escaped_image, *escaped_thumbnail, *script;
+
+	escaped_image = text_escape(image, TEXT_ESCAPE_JS_STRING);
+	escaped_thumbnail = text_escape(thumbnail, TEXT_ESCAPE_JS_STRING);
+
+	script = g_strdup_printf(
+		"window.dispatchEvent(new CustomEvent('greeter-user-image-ready', "
+		"{detail: {image: '%s', size: %d, thumbnail: '%s'}}))",
+		escaped_image, size, escaped_thumbnail
+	);
+
+	evaluate_script_in_page(script);
+
+	g_free(script);
+	g_free(escaped_thumbnail);
+	g_free(escaped_image);
+}
+
+
+/*
+ * Starts making default size thumbnails before the theme asks for the user list.
+ */
+static gboolean
+prewarm_avatars_cb(gpointer user_data) {
+	const GList *link;
+
+	for (link = greeter_backend_get_users(); link; link = link->next) {
+		g_free(avatar_cache_lookup(greeter_backend_user_get_image(link->data), AVATAR_DEFAULT_SIZE));
+	}
+
+	return G_SOURCE_REMOVE;
+}
+
+
+/*
+ * Appends the web process's share of the metrics socket (see metrics-server.c) to `text`.
+ */
+static void
+append_web_metrics(GString *text) {
+	static const gchar *auth_phase_labels[AUTH_PHASE_COUNT] = {
+		"phase=\"first_prompt\"",
+		"phase=\"response\"",
+		"phase=\"session_start\"",
+	};
+	BridgeCallMetric *metric;
+	GSList *item;
+	gchar *labels;
+	guint i;
+
+	metrics_text_append_family(text, "greeter_web_process_resident_bytes", "gauge", "Resident set size of the web process.");
+	metrics_text_append_value(text, "greeter_web_process_resident_bytes", NULL, process_stats_get_resident_bytes());
+
+	metrics_text_append_family(text, "greeter_requests_total", "counter", "Requests made by the theme, by outcome.");
+	metrics_text_append_value(text, "greeter_requests_total", "decision=\"allowed\"", requests_allowed);
+	metrics_text_append_value(text, "greeter_requests_total", "decision=\"blocked\"", requests_blocked);
+
+	metrics_text_append_family(text, "greeter_pam_latency_seconds", "histogram", "PAM conversation latency by phase.");
+
+	for (i = 0; i < AUTH_PHASE_COUNT; i++) {
+		metrics_text_append_histogram(text, "greeter_pam_latency_seconds", auth_phase_labels[i], &auth_latency[i]);
+	}
+
+	metrics_text_append_family(text, "greeter_bridge_calls_total", "counter", "Calls from the theme into the greeter.");
+
+	for (item = bridge_call_metrics; NULL != item; item = item->next) {
+		metric = item->data;
+		labels = g_strdup_printf("function=\"%s\"", metric->name);
+		metrics_text_append_value(text, "greeter_bridge_calls_total", labels, metric->calls);
+		g_free(labels);
+	}
+
+	metrics_text_append_family(
+		text,
+		"greeter_bridge_call_duration_seconds",
+		"summary",
+		"Time spent in calls from the theme into the greeter (sampled)."
+	);
+
+	for (item = bridge_call_metrics; NULL != item; item = item->next) {
+		metric = item->data;
+		labels = g_strdup_printf("function=\"%s\"", metric->name);
+		metrics_text_append_value(text, "greeter_bridge_call_duration_seconds_sum", labels, (gdouble) metric->timed_total / G_USEC_PER_SEC);
+		metrics_text_append_value(text, "greeter_bridge_call_duration_seconds_count", labels, metric->timed);
+		g_free(labels);
+	}
+}
+
+
+/*
+ * Someone is reading the metrics socket. `user_data` is the WebKitUserMessage to reply to.
+ */
+static void
+metrics_request_handler(GVariant *parameters, gpointer user_data) {
+	#ifdef HAS_WEBKITGTK_2_28
+	GString *text = g_string_sized_new(8192);
+
+	append_web_metrics(text);
+
+	webkit_user_message_send_reply(
+		WEBKIT_USER_MESSAGE(user_data),
+		webkit_user_message_new(GREETER_MESSAGE_METRICS, g_variant_new("(s)", text->str))
+	);
+
+	g_string_free(text, TRUE);
+	#endif
+}
+
+
+/*
+ * Returns the size of the JavaScript heap in bytes or -1 if unknown.
+ *
+ * JSGetMemoryUsageStatistics() is exported by JavaScriptCore but only declared in its
+ * private headers, so it is looked up at runtime.
+ */
+static gint64
+get_js_heap_size(JSContextRef context) {
+	static JSObjectRef (*get_memory_usage_statistics) (JSContextRef context);
+	static gboolean looked_up = FALSE;
+	GModule *self;
+	JSObjectRef statistics;
+	JSStringRef name;
+	JSValueRef value;
+
+	if (! looked_up) {
+		looked_up = TRUE;
+		self = g_module_open(NULL, 0);
+
+		/* Never closed, the symbol has to stay valid */
+		if (NULL == self || ! g_module_symbol(self, "JSGetMemoryUsageStatistics", (gpointer *) &get_memory_usage_statistics)) {
+			get_memory_usage_statistics = NULL;
+		}
+	}
+
+	if (NULL == get_memory_usage_statistics) {
+		return -1;
+	}
+
+	statistics = get_memory_usage_statistics(context);
+	name = JSStringCreateWithUTF8CString("heapSize");
+	value = JSObjectGetProperty(context, statistics, name, NULL);
+	JSStringRelease(name);
+
+	return JSValueIsNumber(context, value) ? (gint64) JSValueToNumber(context, value, NULL) : -1;
+}
+
+
+/*
+ * `lightdm-webkit2-greeter --benchmark-theme` is done. `user_data` is the WebKitUserMessage
+ * to reply to.
+ */
+static void
+benchmark_request_handler(GVariant *parameters, gpointer user_data) {
+	#ifdef HAS_WEBKITGTK_2_28
+	WebKitWebPage *web_page;
+	JSGlobalContextRef context = NULL;
+	JSStringRef script;
+	JSValueRef result;
+	gint64 js_heap = -1;
+	guint64 dom_nodes = 0;
+
+	web_page = webkit_web_extension_get_page(WEB_EXTENSION, page_id);
+
+	if (NULL != web_page) {
+		context = webkit_frame_get_javascript_global_context(webkit_web_page_get_main_frame(web_page));
+	}
+
+	if (NULL != context) {
+		script = JSStringCreateWithUTF8CString(
+			"(() => {"
+			"  let walker = document.createTreeWalker(document, NodeFilter.SHOW_ALL), count = 1;"
+			"  while (walker.nextNode()) { count++; }"
+			"  return count;"
+			"})()"
 		);
+		result = JSEvaluateScript(context, script, NULL, NULL, 0, NULL);
+		JSStringRelease(script);
+
+		if (NULL != result && JSValueIsNumber(context, result)) {
+			dom_nodes = (guint64) JSValueToNumber(context, result, NULL);
+		}
+
+		js_heap = get_js_heap_size(context);
 	}
+
+	webkit_user_message_send_reply(
+		WEBKIT_USER_MESSAGE(user_data),
+		webkit_user_message_new(GREETER_MESSAGE_BENCHMARK, g_variant_new(
+			"(xtttt)",
+			js_heap,
+			dom_nodes,
+			requests_allowed + requests_blocked,
+			process_stats_get_bytes_read(),
+			process_stats_get_resident_bytes()
+		))
+	);
+	#endif
+}
+
+
+static const GreeterMessageHandler web_message_handlers[] = {
+	{GREETER_MESSAGE_BENCHMARK_REQUEST, GREETER_MESSAGE_BENCHMARK_REQUEST_TYPE, benchmark_request_handler},
+	{GREETER_MESSAGE_CONFIG_RELOAD,     GREETER_MESSAGE_CONFIG_RELOAD_TYPE,     config_reload_handler},
+	{GREETER_MESSAGE_DISPLAY_BLANKED,   GREETER_MESSAGE_DISPLAY_BLANKED_TYPE,   display_blanked_handler},
+	{GREETER_MESSAGE_FRAME_STATS,       GREETER_MESSAGE_FRAME_STATS_TYPE,       frame_stats_handler},
+	{GREETER_MESSAGE_METRICS_REQUEST,   GREETER_MESSAGE_METRICS_REQUEST_TYPE,   metrics_request_handler},
+	{GREETER_MESSAGE_MONITOR_GEOMETRY,  GREETER_MESSAGE_MONITOR_GEOMETRY_TYPE,  monitor_geometry_handler},
+	{NULL,                              NULL,                                   NULL}};
+
+
+#ifdef HAS_WEBKITGTK_2_28
+static gboolean
+web_page_user_message_received_cb(WebKitWebPage     *web_page,
+								  WebKitUserMessage *message,
+								  gpointer           user_data) {
+
+	return greeter_message_dispatch(
+		web_message_handlers_table,
+		webkit_user_message_get_name(message),
+		webkit_user_message_get_parameters(message),
+		message
+	);
 }
+#endif
 
 
 void
@@ -1961,54 +4366,57 @@ page_created_cb(WebKitWebExtension *extension,
 
 	g_signal_connect(web_page, "send-request", G_CALLBACK(web_page_send_request_cb), NULL);
 
-	if (TRUE == detect_theme_errors) {
-		g_signal_connect(web_page, "console-message-sent", G_CALLBACK(web_page_console_message_sent_cb), NULL);
-	}
+	#ifdef HAS_WEBKITGTK_2_28
+	g_signal_connect(web_page, "user-message-received", G_CALLBACK(web_page_user_message_received_cb), NULL);
+	#endif
 }
 
 
 G_MODULE_EXPORT void
 webkit_web_extension_initialize(WebKitWebExtension *extension) {
 	LightDMGreeter *greeter = lightdm_greeter_new();
+	gchar *avatars_dir, *canonical_avatars_dir;
 	GError *err = NULL;
 
 	WEB_EXTENSION = extension;
 	SESSION_STARTING = FALSE;
+	web_message_handlers_table = greeter_message_table_new(web_message_handlers);
 
 	/* load greeter settings from config file */
 	keyfile = g_key_file_new();
 
 	g_key_file_load_from_file(
 		keyfile,
-		CONFIG_DIR "/lightdm-webkit2-greeter.conf",
+		greeter_paths_get_config_file(),
 		G_KEY_FILE_NONE,
 		NULL
 	);
 
-	secure_mode = get_config_option_as_bool("greeter", "secure_mode", &err);
-	if (NULL != err) {
-		// Use default value
-		secure_mode = TRUE;
-		g_clear_error(&err);
-	}
+	wakeup_counter_start(&wakeup_counter);
 
-	detect_theme_errors = get_config_option_as_bool("greeter", "detect_theme_errors", &err);
-	if (NULL != err) {
-		// Use default value
-		detect_theme_errors = TRUE;
-		g_error_free(err);
+	paths = g_slist_prepend(paths, THEME_DIR);
+
+	load_config();
+
+	avatars_dir = g_build_filename(g_get_user_cache_dir(), "lightdm-webkit2-greeter", "avatars", NULL);
+	avatar_cache_init(avatars_dir, avatar_ready_cb, NULL);
+
+	if (NULL != (canonical_avatars_dir = canonicalize_file_name(avatars_dir))) {
+		paths = g_slist_prepend(paths, canonical_avatars_dir);
 	}
 
-	paths = g_slist_prepend(paths, THEME_DIR);
+	g_free(avatars_dir);
 
-	background_images_dir = get_config_option_as_string("branding", "background_images");
-	paths = g_slist_prepend(paths, background_images_dir);
+	greeter_backend_init(keyfile, greeter);
 
-	user_image = get_config_option_as_string("branding", "user_image");
-	paths = g_slist_prepend(paths, user_image);
+	if (! greeter_backend_is_mock()) {
+		gchar *languages_file = g_build_filename(g_get_user_cache_dir(), "lightdm-webkit2-greeter", "languages", NULL);
 
-	logo = get_config_option_as_string("branding", "logo");
-	paths = g_slist_prepend(paths, logo);
+		language_cache_init(languages_file);
+		g_free(languages_file);
+
+		session_catalog_init(NULL);
+	}
 
 	g_signal_connect(
 		G_OBJECT(greeter),
@@ -2052,11 +4460,20 @@ webkit_web_extension_initialize(WebKitWebExtension *extension) {
 		extension
 	);
 
-	/* TODO: This function was deprecated in lightdm 1.11.x.
-	 * New function is lightdm_greeter_connect_to_daemon_sync
-	 * Wait until it makes it into Debian Stable before making the change.
-	 */
-	lightdm_greeter_connect_sync(greeter, NULL);
+	greeter_backend_connect(greeter, NULL);
+
+	g_idle_add(prewarm_avatars_cb, NULL);
+
+	if (speculative_authentication && 0 == lightdm_greeter_get_autologin_timeout_hint(greeter)) {
+		gchar *user = g_strdup(lightdm_greeter_get_select_user_hint(greeter));
+
+		if (NULL == user) {
+			user = get_last_user();
+		}
+
+		start_speculative_authentication(greeter, user);
+		g_free(user);
+	}
 }
 
 /* vim: set ts=4 sw=4 tw=0 noet : */
@@ -657,6 +657,12 @@ class LightDMGreeter {
 	 */
 	cancel_autologin() {}
 
+	/**
+	 * Hint that the user is likely about to log in as `username`.
+	 * @arg {String} username
+	 */
+	focus_user( username ) {}
+
 	/**
 	 * Get the value of a hint.
 	 * @arg {String} name The name of the hint to get.
@@ -902,6 +908,10 @@ new LightDMGreeter();
  lightdm._username = null;
  };
 
+ lightdm.focus_user = function (username) {
+ _lightdm_mock_check_argument_length(arguments, 1);
+ };
+
  lightdm.suspend = function () {
  alert("System Suspended. Bye Bye");
  document.location.reload(true);
@@ -259,6 +259,7 @@ class AntergosBackgroundManager {
 		_bg_self = this;
 
 		this.current_background = _util.cache_get( 'background_manager', 'current_background' );
+		this.slideshow = null;
 
 		if ( ! _util.background_images_dir || ! _util.background_images || ! _util.background_images.length ) {
 			_util.log( 'AntergosBackgroundManager: [ERROR] No background images detected.' );
@@ -267,6 +268,9 @@ class AntergosBackgroundManager {
 				$( '.header' ).css( "background-image", 'url(img/fallback_bg.jpg)' );
 			} ).fadeTo( 300, 1 );
 
+		} else {
+			// Decodes the next image ahead of time and cross-fades to it
+			this.slideshow = theme_utils.slideshow( '.header', _util.background_images, { shuffle: true } );
 		}
 
 		return _bg_self;
@@ -312,13 +316,25 @@ class AntergosBackgroundManager {
 
 
 	/**
-	 * Set the background image to the value of `this.current_background`
+	 * Set the background image to the value of `this.current_background`. When it was
+	 * picked at random, keep picking new ones every `background_interval` seconds.
 	 */
 	do_background( deferred = null ) {
 		let bg = _bg_self.current_background,
 			tpl = (bg.indexOf('url(') > -1) ? bg : `url(${_bg_self.current_background})`;
 
-		$( '.header' ).css( "background-image", tpl );
+		if ( null !== _bg_self.slideshow ) {
+			_bg_self.slideshow.show( bg );
+
+			if ( 'true' === _util.cache_get( 'background_manager', 'random_background' ) ) {
+				_bg_self.slideshow.start();
+			} else {
+				_bg_self.slideshow.stop();
+			}
+
+		} else {
+			$( '.header' ).css( "background-image", tpl );
+		}
 
 		if (null !== deferred) {
 			deferred.resolve();
@@ -519,7 +535,12 @@ class AntergosTheme {
 				</a>`;
 
 			// Register event handler here so we don't have to iterate over the users again later.
-			$( template ).appendTo( this.$user_list ).click( this.start_authentication ).on( 'error.antergos', this.user_image_error_handler );
+			$( template )
+				.appendTo( this.$user_list )
+				.click( this.start_authentication )
+				// Not on hover: every call starts (and cancels) a PAM conversation
+				.on( 'focus', () => lightdm.focus_user( user.name ) )
+				.on( 'error.antergos', this.user_image_error_handler );
 
 		} // END for ( var user of lightdm.users )
 
@@ -590,9 +611,9 @@ class AntergosTheme {
 	initialize_clock() {
 		this.$clock.html( theme_utils.get_current_localized_time() );
 
-		setInterval( () => {
-			_self.$clock.html( theme_utils.get_current_localized_time() );
-		}, 60000 );
+		window.addEventListener( 'greeter-clock-tick', event => {
+			_self.$clock.html( event.detail.time );
+		} );
 	}
 
 